@@ -0,0 +1,348 @@
+/**
+ * @file codec.c
+ * @brief Temp Monitor - Compressed blocks of recorded samples
+ *
+ * Block layout: a byte-aligned table of scale indices, one nibble per
+ * column (high nibble first), then a big-endian bit stream:
+ *
+ *   frame 0:  tick (64 bits), timestamp (64 bits), zigzag(value) per column
+ *   frame n:  zigzag(tick delta-of-delta), zigzag(timestamp delta-of-delta),
+ *             zigzag((value - previous) / scale) per column
+ *
+ * Every zigzag number is written with the prefix code below, so a zero
+ * (an unchanged reading, or a tick exactly one interval after the last)
+ * is a single 0 bit.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "codec.h"
+
+/* Prefix code: level i is i one-bits, a zero-bit (except the last
+ * level) and then code_width[i] bits of payload */
+#define CODE_LEVELS 8
+static const int code_width[CODE_LEVELS] = {0, 4, 8, 12, 16, 24, 32, 64};
+
+/* Steps a column's deltas may be divided by; the index is one nibble */
+#define SCALE_COUNT 11
+static const uint32_t scale_table[SCALE_COUNT] = {1, 2, 5, 10, 25, 50, 100, 125, 250, 500, 1000};
+
+/* Bytes of the scale table in front of the bit stream */
+#define SCALE_BYTES(columns) (((size_t) (columns) + 1) / 2)
+
+/**
+ * @brief Scale of a column, read from a block's scale table
+ */
+static int32_t scale_at(const unsigned char *table, int column)
+{
+  return (int32_t) scale_table[(table[column >> 1] >> (column & 1 ? 0 : 4)) & 0x0f];
+}
+
+/**
+ * @brief MSB-first bit writer
+ */
+typedef struct
+{
+  unsigned char *out;  /* Output buffer, at least codec_bound() bytes */
+  size_t         pos;  /* Bytes written */
+  uint64_t       acc;  /* Pending bits in the low end */
+  int            bits; /* Number of pending bits, always < 8 between calls */
+} BitWriter;
+
+/**
+ * @brief MSB-first bit reader
+ */
+typedef struct
+{
+  const unsigned char *in;    /* Encoded block */
+  size_t               size;  /* Bytes in the block */
+  size_t               pos;   /* Bytes consumed */
+  uint64_t             acc;   /* Buffered bits in the low end */
+  int                  bits;  /* Number of buffered bits */
+  int                  error; /* Set when reading past the end */
+} BitReader;
+
+/**
+ * @brief Appends the low n bits of value (n <= 64)
+ */
+static void put_bits(BitWriter *w, uint64_t value, int n)
+{
+  if (n > 32)
+  {
+    put_bits(w, value >> 32, n - 32);
+    n = 32;
+  }
+  if (n == 0)
+    return;
+
+  w->acc = (w->acc << n) | (value & ((UINT64_C(1) << n) - 1));
+  w->bits += n;
+
+  while (w->bits >= 8)
+  {
+    w->bits -= 8;
+    w->out[w->pos++] = (unsigned char) (w->acc >> w->bits);
+  }
+}
+
+/**
+ * @brief Reads n bits (n <= 64); sets error past the end
+ */
+static uint64_t get_bits(BitReader *r, int n)
+{
+  uint64_t value = 0;
+
+  if (n > 32)
+  {
+    value = get_bits(r, n - 32) << 32;
+    n     = 32;
+  }
+  if (n == 0)
+    return value;
+
+  while (r->bits < n)
+  {
+    if (r->pos >= r->size)
+    {
+      r->error = 1;
+      return 0;
+    }
+    r->acc = (r->acc << 8) | r->in[r->pos++];
+    r->bits += 8;
+  }
+
+  r->bits -= n;
+  return value | ((r->acc >> r->bits) & ((UINT64_C(1) << n) - 1));
+}
+
+/**
+ * @brief Writes one number with the prefix code
+ */
+static void put_code(BitWriter *w, uint64_t u)
+{
+  int level = 0;
+
+  if (u != 0)
+  {
+    level = 1;
+    while (level < CODE_LEVELS - 1 && u >> code_width[level] != 0)
+      level++;
+  }
+
+  if (level < CODE_LEVELS - 1)
+    put_bits(w, ((UINT64_C(1) << level) - 1) << 1, level + 1);
+  else
+    put_bits(w, (UINT64_C(1) << level) - 1, level);
+
+  put_bits(w, u, code_width[level]);
+}
+
+/**
+ * @brief Reads one number written by put_code()
+ */
+static uint64_t get_code(BitReader *r)
+{
+  int level = 0;
+
+  while (level < CODE_LEVELS - 1 && get_bits(r, 1))
+    level++;
+
+  return get_bits(r, code_width[level]);
+}
+
+/**
+ * @brief Maps signed to unsigned so small magnitudes stay small
+ */
+static uint32_t zigzag32(int32_t v)
+{
+  uint32_t u = (uint32_t) v;
+  return (u << 1) ^ (0u - (u >> 31));
+}
+
+/**
+ * @brief Inverse of zigzag32()
+ */
+static int32_t unzigzag32(uint32_t u)
+{
+  return (int32_t) ((u >> 1) ^ (0u - (u & 1)));
+}
+
+/**
+ * @brief 64-bit zigzag32()
+ */
+static uint64_t zigzag64(int64_t v)
+{
+  uint64_t u = (uint64_t) v;
+  return (u << 1) ^ (0 - (u >> 63));
+}
+
+/**
+ * @brief Inverse of zigzag64()
+ */
+static int64_t unzigzag64(uint64_t u)
+{
+  return (int64_t) ((u >> 1) ^ (0 - (u & 1)));
+}
+
+/**
+ * @brief Difference of two readings with int32 wrap-around
+ */
+static int32_t delta32(int32_t value, int32_t previous)
+{
+  return (int32_t) ((uint32_t) value - (uint32_t) previous);
+}
+
+/**
+ * @brief Largest table step that divides every delta of a column
+ */
+static int pick_scale(const int32_t *values, int frames, int columns, int column)
+{
+  uint32_t g = 0;
+
+  for (int f = 1; f < frames && g != 1; f++)
+  {
+    int32_t  d = delta32(values[(size_t) f * columns + column],
+                         values[(size_t) (f - 1) * columns + column]);
+    uint32_t a = d < 0 ? 0u - (uint32_t) d : (uint32_t) d;
+
+    while (a != 0)
+    {
+      uint32_t t = g % a;
+      g          = a;
+      a          = t;
+    }
+  }
+
+  if (g == 0)
+    return 0;
+
+  for (int s = SCALE_COUNT - 1; s > 0; s--)
+  {
+    if (g % scale_table[s] == 0)
+      return s;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Worst-case encoded size of a block
+ *
+ * @param frames Frames in the block
+ * @param columns Values per frame
+ * @return Bytes the output buffer of codec_encode() must hold
+ */
+size_t codec_bound(int frames, int columns)
+{
+  size_t bits = (size_t) frames * (2 * (CODE_LEVELS - 1 + 64) + (size_t) columns * (7 + 32));
+
+  return SCALE_BYTES(columns) + (bits + 7) / 8 + 8;
+}
+
+/**
+ * @brief Encodes a block of frames
+ *
+ * @param ticks Tick of each frame
+ * @param timestamps Timestamp of each frame
+ * @param values frames * columns values, frame by frame
+ * @param frames Number of frames, at least 1
+ * @param columns Values per frame
+ * @param out Output buffer of codec_bound(frames, columns) bytes
+ * @return Bytes written
+ */
+size_t codec_encode(const uint64_t *ticks, const int64_t *timestamps, const int32_t *values,
+                    int frames, int columns, unsigned char *out)
+{
+  size_t    table      = SCALE_BYTES(columns);
+  BitWriter w          = {out + table, 0, 0, 0};
+  int64_t   tick_delta = 0, time_delta = 0;
+
+  for (size_t b = 0; b < table; b++)
+    out[b] = 0;
+  for (int c = 0; c < columns; c++)
+    out[c >> 1] |= (unsigned char) (pick_scale(values, frames, columns, c) << (c & 1 ? 0 : 4));
+
+  put_bits(&w, ticks[0], 64);
+  put_bits(&w, (uint64_t) timestamps[0], 64);
+  for (int c = 0; c < columns; c++)
+    put_code(&w, zigzag32(values[c]));
+
+  for (int f = 1; f < frames; f++)
+  {
+    const int32_t *row  = values + (size_t) f * columns;
+    const int32_t *prev = row - columns;
+    int64_t        d;
+
+    d = (int64_t) (ticks[f] - ticks[f - 1]);
+    put_code(&w, zigzag64(d - tick_delta));
+    tick_delta = d;
+
+    d = timestamps[f] - timestamps[f - 1];
+    put_code(&w, zigzag64(d - time_delta));
+    time_delta = d;
+
+    for (int c = 0; c < columns; c++)
+    {
+      int32_t d32 = delta32(row[c], prev[c]);
+      put_code(&w, zigzag32(d32 == 0 ? 0 : d32 / scale_at(out, c)));
+    }
+  }
+
+  if (w.bits > 0)
+    w.out[w.pos++] = (unsigned char) (w.acc << (8 - w.bits));
+
+  return table + w.pos;
+}
+
+/**
+ * @brief Decodes a block written by codec_encode()
+ *
+ * @param in Encoded block
+ * @param size Bytes in the block
+ * @param frames Number of frames in the block
+ * @param columns Values per frame
+ * @param ticks Output tick of each frame
+ * @param timestamps Output timestamp of each frame
+ * @param values Output frames * columns values, frame by frame
+ * @return 1 on success, 0 if the block is truncated
+ */
+int codec_decode(const unsigned char *in, size_t size, int frames, int columns,
+                 uint64_t *ticks, int64_t *timestamps, int32_t *values)
+{
+  size_t    table      = SCALE_BYTES(columns);
+  BitReader r          = {in + table, 0, 0, 0, 0, 0};
+  int64_t   tick_delta = 0, time_delta = 0;
+
+  if (frames <= 0 || size < table)
+    return 0;
+  r.size = size - table;
+
+  ticks[0]      = get_bits(&r, 64);
+  timestamps[0] = (int64_t) get_bits(&r, 64);
+  for (int c = 0; c < columns; c++)
+    values[c] = unzigzag32((uint32_t) get_code(&r));
+
+  for (int f = 1; f < frames && !r.error; f++)
+  {
+    int32_t *      row  = values + (size_t) f * columns;
+    const int32_t *prev = row - columns;
+
+    tick_delta += unzigzag64(get_code(&r));
+    ticks[f] = ticks[f - 1] + (uint64_t) tick_delta;
+
+    time_delta += unzigzag64(get_code(&r));
+    timestamps[f] = timestamps[f - 1] + time_delta;
+
+    for (int c = 0; c < columns; c++)
+    {
+      uint32_t q = (uint32_t) unzigzag32((uint32_t) get_code(&r));
+      row[c]     = (int32_t) ((uint32_t) prev[c] + q * (uint32_t) scale_at(in, c));
+    }
+  }
+
+  return !r.error;
+}
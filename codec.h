@@ -0,0 +1,31 @@
+/**
+ * @file codec.h
+ * @brief Temp Monitor - Compressed blocks of recorded samples
+ *
+ * Gorilla-style encoding for --record-compress: ticks and timestamps
+ * as delta-of-delta, each sensor column as a delta from its previous
+ * value divided by the column's step (e.g. 1000 for whole-degree
+ * sensors), all zigzag-coded with a short prefix code. Unchanged
+ * values cost one bit. Every block starts from absolute values, so
+ * blocks decode independently.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+size_t codec_bound(int frames, int columns);
+size_t codec_encode(const uint64_t *ticks, const int64_t *timestamps, const int32_t *values,
+                    int frames, int columns, unsigned char *out);
+int    codec_decode(const unsigned char *in, size_t size, int frames, int columns,
+                    uint64_t *ticks, int64_t *timestamps, int32_t *values);
+
+#endif
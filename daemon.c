@@ -0,0 +1,798 @@
+/**
+ * @file daemon.c
+ * @brief Temp Monitor - Sampling daemon and its Unix socket protocol implementation
+ *
+ * Server: one thread runs an epoll loop over the listening socket, an
+ * eventfd used to stop it, an eventfd the sampler signals on every
+ * publish, and the subscribers. Each new sample is turned into one
+ * frame, once, and sent to every subscriber with a non-blocking send()
+ * straight from that buffer; only the unsent rest of a short send is
+ * copied, into the subscriber's own buffer, and finished on EPOLLOUT.
+ *
+ * Client: the sampler thread of a --connect process calls
+ * daemon_receive() in place of sampling sysfs, so the frames feed the
+ * same snapshot, statistics and outputs as local samples would.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#define _GNU_SOURCE
+
+#include "daemon.h"
+
+#include "record.h"
+#include "registry.h"
+#include "sampler.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* Longest wait for the daemon's header after connecting */
+#define DAEMON_CONNECT_MS 5000
+
+/**
+ * @brief State of one client of the daemon
+ */
+typedef struct Subscriber
+{
+  struct Subscriber *next;         /* Next client */
+  int                fd;           /* Client socket */
+  int                command;      /* DAEMON_*, 0 until the request is complete */
+  long long          connected_ms; /* Time of accept */
+  size_t             received;     /* Bytes of request received */
+  DaemonRequest      request;
+  size_t             pending_size; /* Bytes in pending */
+  size_t             pending_sent; /* Bytes of pending already sent */
+  unsigned char      pending[];    /* Unsent header and/or frame */
+} Subscriber;
+
+/* Server state, owned by the event-loop thread while it runs */
+static struct
+{
+  pthread_t             thread;
+  int                   running;
+  int                   listen_fd;
+  int                   epoll_fd;
+  int                   wake_fd;
+  int                   tick_fd; /* Signalled by the sampler on every publish */
+  char                  path[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+  const SensorRegistry *registry;
+
+  SensorSnapshot snapshot;
+  unsigned char *hello; /* Header and sensor table sent to every client */
+  size_t         hello_size;
+  unsigned char *frame; /* Frame of the latest sample */
+  size_t         frame_size;
+  unsigned long  tick; /* Tick in frame, 0 before the first sample */
+
+  Subscriber *subscribers;
+  int         subscriber_count;
+} server = {.listen_fd = -1, .epoll_fd = -1, .wake_fd = -1, .tick_fd = -1};
+
+/* Client state, used by the sampler thread of a --connect process */
+static struct
+{
+  int                   fd;
+  const SensorRegistry *registry;
+  unsigned char *       frame; /* Frame being received */
+  size_t                frame_size;
+  size_t                received; /* Bytes of frame received */
+} connection = {.fd = -1};
+
+/**
+ * @brief Builds the default socket path
+ *
+ * $XDG_RUNTIME_DIR/temp-monitor.sock when the variable is set, which
+ * keeps the socket private to the user. Otherwise, e.g. for a system
+ * service without a login session, the socket goes in
+ * /tmp/temp-monitor-UID/, created mode 0700. A name that other users
+ * can create first in /tmp would let them block the daemon or pose as
+ * it, so an existing directory must be ours and closed to others.
+ *
+ * @return 1 on success, 0 if the fallback directory cannot be trusted
+ *         (errno is set)
+ */
+int daemon_socket_path(char *path, size_t size)
+{
+  const char *runtime = getenv("XDG_RUNTIME_DIR");
+  char        dir[64];
+  struct stat st;
+
+  if (runtime && runtime[0] == '/')
+  {
+    path_join(path, size, runtime, DAEMON_SOCKET_NAME);
+    return 1;
+  }
+
+  snprintf(dir, sizeof(dir), "/tmp/temp-monitor-%u", (unsigned) getuid());
+  if (mkdir(dir, 0700) != 0 && errno != EEXIST)
+    return 0;
+  if (lstat(dir, &st) != 0)
+    return 0;
+  if (!S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077) != 0)
+  {
+    errno = EPERM;
+    return 0;
+  }
+
+  path_join(path, size, dir, DAEMON_SOCKET_NAME);
+  return 1;
+}
+
+/**
+ * @brief Fills a Unix socket address
+ *
+ * @return 1 on success, 0 if the path does not fit (errno is set)
+ */
+static int socket_address(struct sockaddr_un *addr, const char *path)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr->sun_path))
+  {
+    errno = ENAMETOOLONG;
+    return 0;
+  }
+  strcpy(addr->sun_path, path);
+  return 1;
+}
+
+/**
+ * @brief Binds and listens on a Unix socket path
+ *
+ * A socket left behind by a daemon that died is replaced; one that
+ * still answers belongs to a running daemon and is left alone, as is
+ * anything at path that is not a socket or belongs to another user.
+ *
+ * @return Listening socket, or -1 with errno set
+ */
+static int open_listener(const char *path)
+{
+  struct sockaddr_un addr;
+  struct stat        st;
+  int                fd;
+
+  if (!socket_address(&addr, path))
+    return -1;
+
+  if (lstat(path, &st) == 0)
+  {
+    if (!S_ISSOCK(st.st_mode))
+    {
+      errno = EEXIST;
+      return -1;
+    }
+    if (st.st_uid != geteuid())
+    {
+      errno = EPERM;
+      return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0)
+    {
+      close(fd);
+      errno = EADDRINUSE;
+      return -1;
+    }
+    if (fd >= 0)
+      close(fd);
+    unlink(path);
+  }
+
+  fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -1;
+
+  if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(fd, 64) != 0)
+  {
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+  }
+
+  return fd;
+}
+
+/**
+ * @brief Disconnects a subscriber
+ *
+ * Only closes the socket: events later in the same epoll_wait() batch
+ * may still point to the subscriber, so reap_subscribers() frees it
+ * once the batch is done. A closed subscriber has fd -1.
+ */
+static void close_subscriber(Subscriber *sub)
+{
+  if (sub->fd < 0)
+    return;
+
+  close(sub->fd);
+  sub->fd = -1;
+  server.subscriber_count--;
+}
+
+/**
+ * @brief Frees the subscribers closed since the last call
+ */
+static void reap_subscribers(void)
+{
+  Subscriber **link = &server.subscribers;
+
+  while (*link)
+  {
+    Subscriber *sub = *link;
+
+    if (sub->fd >= 0)
+    {
+      link = &sub->next;
+      continue;
+    }
+    *link = sub->next;
+    free(sub);
+  }
+}
+
+/**
+ * @brief Switches the events a subscriber is polled for
+ */
+static void watch_subscriber(Subscriber *sub, uint32_t events)
+{
+  struct epoll_event ev = {.events = events, .data.ptr = sub};
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_MOD, sub->fd, &ev);
+}
+
+/**
+ * @brief Sends as much of a subscriber's pending bytes as the socket takes
+ *
+ * A snapshot client is closed once its frame is out.
+ *
+ * @return 1 if the subscriber stays connected, 0 if it was closed
+ */
+static int flush_subscriber(Subscriber *sub)
+{
+  while (sub->pending_sent < sub->pending_size)
+  {
+    ssize_t n = send(sub->fd, sub->pending + sub->pending_sent,
+                     sub->pending_size - sub->pending_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      watch_subscriber(sub, EPOLLOUT);
+      return 1;
+    }
+    if (n <= 0)
+    {
+      close_subscriber(sub);
+      return 0;
+    }
+    sub->pending_sent += (size_t) n;
+  }
+
+  sub->pending_size = 0;
+  sub->pending_sent = 0;
+  if (sub->command == DAEMON_SNAPSHOT && server.tick > 0)
+  {
+    close_subscriber(sub);
+    return 0;
+  }
+
+  watch_subscriber(sub, EPOLLIN);
+  return 1;
+}
+
+/**
+ * @brief Sends the latest frame to a subscriber
+ *
+ * Straight from the shared frame; a subscriber still busy with an
+ * earlier frame skips this one.
+ */
+static void send_frame(Subscriber *sub)
+{
+  ssize_t n;
+
+  if (sub->pending_size > 0)
+    return;
+
+  do
+    n = send(sub->fd, server.frame, server.frame_size, MSG_DONTWAIT | MSG_NOSIGNAL);
+  while (n < 0 && errno == EINTR);
+
+  if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+  {
+    close_subscriber(sub);
+    return;
+  }
+  if (n < 0)
+    n = 0;
+
+  memcpy(sub->pending, server.frame + n, server.frame_size - (size_t) n);
+  sub->pending_size = server.frame_size - (size_t) n;
+  flush_subscriber(sub);
+}
+
+/**
+ * @brief Turns the sampler's latest snapshot into a frame for everyone
+ */
+static void publish_frame(void)
+{
+  uint64_t    count;
+  Subscriber *sub = server.subscribers;
+
+  if (read(server.tick_fd, &count, sizeof(count)) < 0 || !sampler_read(&server.snapshot) ||
+      server.snapshot.tick == server.tick)
+    return;
+
+  record_frame(&server.snapshot, server.registry->count, server.frame);
+  server.tick = server.snapshot.tick;
+
+  while (sub)
+  {
+    Subscriber *next = sub->next;
+    if (sub->fd >= 0 && sub->command != 0)
+      send_frame(sub);
+    sub = next;
+  }
+}
+
+/**
+ * @brief Reads a subscriber's request, or notices that it hung up
+ */
+static void handle_readable(Subscriber *sub)
+{
+  unsigned char *request = (unsigned char *) &sub->request;
+  ssize_t        n;
+
+  if (sub->command != 0)
+  {
+    /* Nothing more is expected; only a hang-up matters */
+    unsigned char discard[256];
+
+    while ((n = recv(sub->fd, discard, sizeof(discard), MSG_DONTWAIT)) > 0)
+    {
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+      close_subscriber(sub);
+    return;
+  }
+
+  n = recv(sub->fd, request + sub->received, sizeof(sub->request) - sub->received, MSG_DONTWAIT);
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    return;
+  if (n <= 0)
+  {
+    close_subscriber(sub);
+    return;
+  }
+
+  sub->received += (size_t) n;
+  if (sub->received < sizeof(sub->request))
+    return;
+
+  if (sub->request.magic != DAEMON_MAGIC ||
+      (sub->request.command != DAEMON_SNAPSHOT && sub->request.command != DAEMON_SUBSCRIBE))
+  {
+    close_subscriber(sub);
+    return;
+  }
+
+  /* The header, then the latest frame if there is one yet */
+  sub->command = (int) sub->request.command;
+  memcpy(sub->pending, server.hello, server.hello_size);
+  sub->pending_size = server.hello_size;
+  if (server.tick > 0)
+  {
+    memcpy(sub->pending + sub->pending_size, server.frame, server.frame_size);
+    sub->pending_size += server.frame_size;
+  }
+  flush_subscriber(sub);
+}
+
+/**
+ * @brief Accepts every pending client
+ */
+static void accept_subscribers(void)
+{
+  for (;;)
+  {
+    int                fd = accept4(server.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    Subscriber *       sub;
+    struct epoll_event ev = {.events = EPOLLIN};
+
+    if (fd < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+
+    if (server.subscriber_count >= DAEMON_MAX_CLIENTS ||
+        !(sub = calloc(1, sizeof(*sub) + server.hello_size + server.frame_size)))
+    {
+      close(fd);
+      continue;
+    }
+
+    sub->fd           = fd;
+    sub->connected_ms = get_time_ms();
+    ev.data.ptr       = sub;
+    if (epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+      close(fd);
+      free(sub);
+      continue;
+    }
+
+    sub->next          = server.subscribers;
+    server.subscribers = sub;
+    server.subscriber_count++;
+  }
+}
+
+/**
+ * @brief Closes clients that sent no request within DAEMON_REQUEST_MS
+ */
+static void expire_subscribers(void)
+{
+  long long   now = get_time_ms();
+  Subscriber *sub = server.subscribers;
+
+  while (sub)
+  {
+    Subscriber *next = sub->next;
+    if (sub->fd >= 0 && sub->command == 0 && now - sub->connected_ms > DAEMON_REQUEST_MS)
+      close_subscriber(sub);
+    sub = next;
+  }
+}
+
+/**
+ * @brief Event-loop thread body
+ */
+static void *daemon_main(void *arg)
+{
+  struct epoll_event events[64];
+  long long          expired = get_time_ms();
+
+  (void) arg;
+
+  for (;;)
+  {
+    int n = epoll_wait(server.epoll_fd, events, 64, 1000);
+
+    for (int i = 0; i < n; i++)
+    {
+      void *ptr = events[i].data.ptr;
+
+      if (ptr == &server.wake_fd)
+        return NULL;
+      if (ptr == &server.listen_fd)
+      {
+        accept_subscribers();
+        continue;
+      }
+      if (ptr == &server.tick_fd)
+      {
+        publish_frame();
+        continue;
+      }
+
+      /* It may have been closed by an earlier event of this batch */
+      Subscriber *sub = ptr;
+      if (sub->fd < 0)
+        continue;
+      if (events[i].events & (EPOLLERR | EPOLLHUP))
+        close_subscriber(sub);
+      else if (events[i].events & EPOLLOUT)
+        flush_subscriber(sub);
+      else
+        handle_readable(sub);
+    }
+
+    if (get_time_ms() - expired >= 1000)
+    {
+      expire_subscribers();
+      expired = get_time_ms();
+    }
+
+    reap_subscribers();
+  }
+}
+
+/**
+ * @brief Frees everything daemon_start() set up
+ */
+static void release_server(void)
+{
+  sampler_notify(-1);
+
+  for (Subscriber *sub = server.subscribers; sub; sub = sub->next)
+    close_subscriber(sub);
+  reap_subscribers();
+
+  if (server.listen_fd >= 0)
+  {
+    close(server.listen_fd);
+    unlink(server.path);
+  }
+  if (server.epoll_fd >= 0)
+    close(server.epoll_fd);
+  if (server.wake_fd >= 0)
+    close(server.wake_fd);
+  if (server.tick_fd >= 0)
+    close(server.tick_fd);
+  server.listen_fd = server.epoll_fd = server.wake_fd = server.tick_fd = -1;
+
+  free(server.hello);
+  server.hello = server.frame = NULL;
+  server.tick                 = 0;
+  snapshot_free(&server.snapshot);
+}
+
+/**
+ * @brief Starts serving samples on a Unix socket
+ *
+ * Must be called after sampler_start(); the daemon reads the
+ * sampler's snapshots and the registry's metadata only.
+ *
+ * @param path Socket path, see daemon_socket_path()
+ * @param registry Sensor table being sampled
+ * @param interval_ms Sampling interval, announced to clients
+ * @return 1 on success, 0 on failure (errno set)
+ */
+int daemon_start(const char *path, const SensorRegistry *registry, int interval_ms)
+{
+  struct epoll_event ev = {.events = EPOLLIN};
+  int                saved;
+
+  if (server.running)
+    return 1;
+
+  server.registry   = registry;
+  server.hello_size = record_describe(registry, interval_ms, RECORD_ENCODING_RAW, NULL);
+  server.frame_size = record_frame_size(registry->count);
+  server.hello      = malloc(server.hello_size + server.frame_size);
+  if (!server.hello || !snapshot_init(&server.snapshot, registry->count))
+  {
+    release_server();
+    errno = ENOMEM;
+    return 0;
+  }
+  server.frame = server.hello + server.hello_size;
+  record_describe(registry, interval_ms, RECORD_ENCODING_RAW, server.hello);
+
+  snprintf(server.path, sizeof(server.path), "%s", path);
+  server.listen_fd = open_listener(path);
+  server.epoll_fd  = epoll_create1(EPOLL_CLOEXEC);
+  server.wake_fd   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  server.tick_fd   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (server.listen_fd < 0 || server.epoll_fd < 0 || server.wake_fd < 0 || server.tick_fd < 0)
+  {
+    saved = errno;
+    release_server();
+    errno = saved;
+    return 0;
+  }
+
+  ev.data.ptr = &server.listen_fd;
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &ev);
+  ev.data.ptr = &server.wake_fd;
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.wake_fd, &ev);
+  ev.data.ptr = &server.tick_fd;
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.tick_fd, &ev);
+  sampler_notify(server.tick_fd);
+
+  if (pthread_create(&server.thread, NULL, daemon_main, NULL) != 0)
+  {
+    release_server();
+    errno = EAGAIN;
+    return 0;
+  }
+
+  server.running = 1;
+  return 1;
+}
+
+/**
+ * @brief Stops the daemon, disconnects every client and removes the socket
+ */
+void daemon_stop(void)
+{
+  uint64_t one = 1;
+
+  if (!server.running)
+    return;
+
+  if (write(server.wake_fd, &one, sizeof(one)) < 0)
+    pthread_cancel(server.thread);
+  pthread_join(server.thread, NULL);
+
+  release_server();
+  server.running = 0;
+}
+
+/**
+ * @brief Reads exactly size bytes, waiting at most timeout_ms in total
+ *
+ * @return 1 on success, 0 on error, end of stream or timeout (errno set)
+ */
+static int read_exact(int fd, void *data, size_t size, int timeout_ms)
+{
+  long long      deadline = get_time_ms() + timeout_ms;
+  unsigned char *out      = data;
+
+  while (size > 0)
+  {
+    struct pollfd pfd  = {.fd = fd, .events = POLLIN};
+    long long     left = deadline - get_time_ms();
+    ssize_t       n;
+
+    if (left <= 0 || poll(&pfd, 1, (int) left) == 0)
+    {
+      errno = ETIMEDOUT;
+      return 0;
+    }
+
+    n = recv(fd, out, size, 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+    {
+      if (n == 0)
+        errno = ECONNRESET;
+      return 0;
+    }
+    out += n;
+    size -= (size_t) n;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Tells whether the process at the other end can be trusted
+ *
+ * Only a daemon run by the same user or by root is; anyone else could
+ * have bound the path to serve made-up readings.
+ *
+ * @return 1 if trusted, 0 otherwise (errno is set)
+ */
+static int peer_trusted(int fd)
+{
+  struct ucred cred;
+  socklen_t    len = sizeof(cred);
+
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+    return 0;
+  if (cred.uid != geteuid() && cred.uid != 0)
+  {
+    errno = EPERM;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Connects to a daemon and rebuilds its sensor table
+ *
+ * On success registry holds the daemon's sensors, in its order, and
+ * daemon_receive() hands out its samples.
+ *
+ * @param path Socket path, see daemon_socket_path()
+ * @param command DAEMON_SNAPSHOT or DAEMON_SUBSCRIBE
+ * @param registry Empty registry to fill
+ * @param interval_ms Receives the daemon's sampling interval
+ * @return 1 on success, 0 on failure (errno is set, or 0 if the daemon
+ *         speaks a different version)
+ */
+int daemon_connect(const char *path, int command, SensorRegistry *registry, int *interval_ms)
+{
+  struct sockaddr_un addr;
+  DaemonRequest      request = {.magic = DAEMON_MAGIC, .command = (uint32_t) command};
+  RecordFileHeader   header;
+  unsigned char *    table;
+  int                ok;
+
+  if (!socket_address(&addr, path))
+    return 0;
+
+  connection.fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (connection.fd < 0 || connect(connection.fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+      !peer_trusted(connection.fd) ||
+      send(connection.fd, &request, sizeof(request), MSG_NOSIGNAL) != sizeof(request) ||
+      !read_exact(connection.fd, &header, sizeof(header), DAEMON_CONNECT_MS))
+    return 0;
+
+  errno = 0;
+  if (!record_header_valid(&header) || header.encoding != RECORD_ENCODING_RAW)
+    return 0;
+
+  table = malloc(header.table_size ? header.table_size : 1);
+  if (!table)
+    return 0;
+
+  ok    = read_exact(connection.fd, table, header.table_size, DAEMON_CONNECT_MS);
+  errno = ok ? 0 : errno;
+  ok    = ok && record_load_table(&header, table, registry);
+  free(table);
+  if (!ok)
+    return 0;
+
+  connection.registry   = registry;
+  connection.frame_size = header.frame_size;
+  connection.frame      = malloc(connection.frame_size);
+  connection.received   = 0;
+  if (!connection.frame)
+    return 0;
+
+  *interval_ms = header.interval_ms > 0 ? (int) header.interval_ms : 1000;
+  return 1;
+}
+
+/**
+ * @brief Receives the next sample from the daemon (a SamplerSource)
+ *
+ * @param snapshot Snapshot to apply the sample to
+ * @return 1 if a sample was applied, 0 if none is complete yet, -1 if
+ *         the daemon closed the connection
+ */
+int daemon_receive(SensorSnapshot *snapshot)
+{
+  struct pollfd     pfd = {.fd = connection.fd, .events = POLLIN};
+  RecordFrameHeader head;
+  const int32_t *   temps;
+  int               count = connection.registry->count;
+  ssize_t           n;
+
+  if (poll(&pfd, 1, 200) <= 0)
+    return 0;
+
+  n = recv(connection.fd, connection.frame + connection.received,
+           connection.frame_size - connection.received, 0);
+  if (n < 0 && (errno == EINTR || errno == EAGAIN))
+    return 0;
+  if (n <= 0)
+    return -1;
+
+  connection.received += (size_t) n;
+  if (connection.received < connection.frame_size)
+    return 0;
+  connection.received = 0;
+
+  if (!record_frame_valid(connection.frame, connection.frame_size))
+    return 0;
+
+  memcpy(&head, connection.frame, sizeof(head));
+  temps = (const int32_t *) (connection.frame + sizeof(head));
+  replay_sensors(connection.registry->sensors, count, temps, temps + count,
+                 (unsigned long) head.tick, head.timestamp_ms, snapshot);
+  return 1;
+}
+
+/**
+ * @brief Closes the connection to the daemon
+ */
+void daemon_disconnect(void)
+{
+  if (connection.fd >= 0)
+    close(connection.fd);
+  free(connection.frame);
+  memset(&connection, 0, sizeof(connection));
+  connection.fd = -1;
+}
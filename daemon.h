@@ -0,0 +1,71 @@
+/**
+ * @file daemon.h
+ * @brief Temp Monitor - Sampling daemon and its Unix socket protocol
+ *
+ * --daemon samples once for every consumer on the machine and serves
+ * the samples on a Unix domain socket; --connect turns any other mode
+ * (dashboard, --format, --listen, --textfile, --statsd...) into a
+ * client that reads the daemon instead of sysfs, so sysfs load stays
+ * that of one monitor however many clients there are.
+ *
+ * Protocol: the client sends one DaemonRequest. The daemon answers
+ * with the bytes of a raw recording (see record.h): a RecordFileHeader
+ * and sensor table, then one RecordFrameHeader frame per sample,
+ * starting with the latest one. DAEMON_SNAPSHOT ends the stream after
+ * that frame; DAEMON_SUBSCRIBE goes on with every new sample until the
+ * client hangs up. A subscriber too slow to take a frame skips it and
+ * gets the next one, so the stream may have gaps in tick numbers but
+ * never holds back the daemon. Everything is in host byte order; both
+ * ends run on the same machine. Clients only accept a daemon run by
+ * their own user or root (SO_PEERCRED).
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "sensor.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* First word of every request */
+#define DAEMON_MAGIC 0x51444d54u /* "TMDQ" */
+
+/* Request commands */
+#define DAEMON_SNAPSHOT 1  /* Latest sample, then the daemon closes */
+#define DAEMON_SUBSCRIBE 2 /* Latest sample, then every new one */
+
+/* Socket name in $XDG_RUNTIME_DIR, elsewhere in a private /tmp/temp-monitor-UID/ */
+#define DAEMON_SOCKET_NAME "temp-monitor.sock"
+
+/* Clients served at once; later ones are closed on accept */
+#define DAEMON_MAX_CLIENTS 256
+
+/* Clients that send no request within this time are closed */
+#define DAEMON_REQUEST_MS 5000
+
+/**
+ * @brief Request sent by a client right after connecting
+ */
+typedef struct
+{
+  uint32_t magic;   /* DAEMON_MAGIC */
+  uint32_t command; /* DAEMON_SNAPSHOT or DAEMON_SUBSCRIBE */
+} DaemonRequest;
+
+int daemon_socket_path(char *path, size_t size);
+
+int  daemon_start(const char *path, const SensorRegistry *registry, int interval_ms);
+void daemon_stop(void);
+
+int  daemon_connect(const char *path, int command, SensorRegistry *registry, int *interval_ms);
+int  daemon_receive(SensorSnapshot *snapshot);
+void daemon_disconnect(void);
+
+#endif
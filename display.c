@@ -25,6 +25,8 @@
 
 #include "display.h"
 
+#include "registry.h"
+#include "stats.h"
 #include "utils.h"
 
 #include <stdio.h>
@@ -130,39 +132,46 @@ void show_cursor(void)
 /**
  * @brief Converts Celsius to Fahrenheit
  *
- * @param celsius Temperature in Celsius
- * @return Temperature in Fahrenheit
+ * @param celsius Temperature in millidegrees Celsius
+ * @return Temperature in millidegrees Fahrenheit
  */
-double celsius_to_fahrenheit(double celsius)
+int32_t celsius_to_fahrenheit(int32_t celsius)
 {
-  return (celsius * 9.0 / 5.0) + 32.0;
+  return (int32_t) ((int64_t) celsius * 9 / 5 + 32000);
 }
 
 /**
  * @brief Prints a formatted temperature value
  *
- * Displays temperature with appropriate unit (C or F).
- * Shows "N/A" for invalid readings (< -500).
+ * Displays temperature with appropriate unit (C or F), right-aligned
+ * to six columns with one decimal. Formatting is integer-only via
+ * format_millidegrees(). Shows "N/A" for invalid readings.
  *
- * @param temp Temperature value in Celsius
+ * @param temp Temperature in millidegrees Celsius, or TEMP_INVALID
  * @param use_celsius 1 for Celsius, 0 for Fahrenheit
  */
-void print_temperature(double temp, int use_celsius)
+void print_temperature(int32_t temp, int use_celsius)
 {
-  if (temp < -500)
+  char   digits[MILLI_STR_MAX];
+  char   text[MILLI_STR_MAX + 8];
+  size_t len, pad;
+
+  if (temp == TEMP_INVALID)
   {
-    printf("  N/A   ");
+    fputs("  N/A   ", stdout);
     return;
   }
 
-  if (use_celsius)
-  {
-    printf("%6.1fC", temp);
-  }
-  else
-  {
-    printf("%6.1fF", celsius_to_fahrenheit(temp));
-  }
+  if (!use_celsius)
+    temp = celsius_to_fahrenheit(temp);
+
+  len = format_millidegrees(digits, temp, 1);
+  pad = len < 6 ? 6 - len : 0;
+
+  memset(text, ' ', pad);
+  memcpy(text + pad, digits, len);
+  text[pad + len] = use_celsius ? 'C' : 'F';
+  fwrite(text, 1, pad + len + 1, stdout);
 }
 
 /**
@@ -180,6 +189,20 @@ void get_current_time(char *buffer, size_t size)
   strftime(buffer, size, "%Y-%m-%d %H:%M:%S", tm_info);
 }
 
+/**
+ * @brief Formats a wall-clock time in milliseconds like get_current_time()
+ *
+ * @param timestamp_ms Milliseconds since the epoch
+ * @param buffer Output buffer for the time string
+ * @param size Size of the output buffer
+ */
+void format_time_ms(long long timestamp_ms, char *buffer, size_t size)
+{
+  time_t     when    = (time_t) (timestamp_ms / 1000);
+  struct tm *tm_info = localtime(&when);
+  strftime(buffer, size, "%Y-%m-%d %H:%M:%S", tm_info);
+}
+
 /**
  * @brief Prints a horizontal separator line
  *
@@ -214,12 +237,14 @@ void print_separator(int width, int style)
 /**
  * @brief Prints the application header
  *
- * Displays the title bar with version number and current time.
- * Adapts width based on terminal size.
+ * Displays the title bar with version number and current time, or
+ * the recorded time during --replay. Adapts width based on terminal
+ * size.
  *
  * @param version Version string to display
+ * @param config Display configuration
  */
-void print_header(const char *version)
+void print_header(const char *version, const DisplayConfig *config)
 {
   int rows, cols;
   get_terminal_size(&rows, &cols);
@@ -247,14 +272,16 @@ void print_header(const char *version)
     printf(" ");
   printf(COLOR_BRIGHT_CYAN "|\n" COLOR_RESET);
 
-  char time_str[64];
-  get_current_time(time_str, sizeof(time_str));
+  char        time_str[64];
+  const char *mode = config->replay_ms ? "[>] Replay" : "[*] Real-time Monitoring";
+  if (config->replay_ms)
+    format_time_ms(config->replay_ms, time_str, sizeof(time_str));
+  else
+    get_current_time(time_str, sizeof(time_str));
 
   printf(COLOR_BRIGHT_CYAN "|" COLOR_RESET);
-  printf("  " COLOR_CYAN "%s" COLOR_RESET "  |  " COLOR_GREEN
-         "[*] Real-time Monitoring" COLOR_RESET,
-         time_str);
-  int pad = width - 55;
+  printf("  " COLOR_CYAN "%s" COLOR_RESET "  |  " COLOR_GREEN "%s" COLOR_RESET, time_str, mode);
+  int pad = width - 31 - (int) strlen(mode);
   for (int i = 0; i < pad; i++)
     printf(" ");
   printf(COLOR_BRIGHT_CYAN "|\n" COLOR_RESET);
@@ -301,7 +328,14 @@ void print_footer(DisplayConfig *config)
   {
     printf(COLOR_MAGENTA "Fan monitoring enabled" COLOR_RESET " | ");
   }
-  printf("Refresh: " COLOR_CYAN "%ds\n" COLOR_RESET, config->refresh_rate);
+  if (config->replay_ms && config->replay_speed > 0)
+    printf("Replay: " COLOR_CYAN "x%g\n" COLOR_RESET, config->replay_speed);
+  else if (config->replay_ms)
+    printf("Replay: " COLOR_CYAN "max\n" COLOR_RESET);
+  else if (config->interval_ms % 1000 != 0)
+    printf("Refresh: " COLOR_CYAN "%dms\n" COLOR_RESET, config->interval_ms);
+  else
+    printf("Refresh: " COLOR_CYAN "%ds\n" COLOR_RESET, config->interval_ms / 1000);
 }
 
 /**
@@ -314,15 +348,15 @@ void print_footer(DisplayConfig *config)
  * - Yellow: 60-80C (Warm)
  * - Red: > 80C (Hot/Critical)
  *
- * @param temp Current temperature in Celsius
+ * @param temp Current temperature in millidegrees Celsius
  * @param width Width of the bar in characters
  * @param use_gradient Whether to use gradient colors (unused)
  */
-void print_temp_bar(double temp, int width, int use_gradient)
+void print_temp_bar(int32_t temp, int width, int use_gradient)
 {
   (void) use_gradient;
 
-  if (temp < -500)
+  if (temp == TEMP_INVALID)
   {
     printf(COLOR_BRIGHT_BLACK "[");
     for (int i = 0; i < width; i++)
@@ -331,38 +365,38 @@ void print_temp_bar(double temp, int width, int use_gradient)
     return;
   }
 
-  int filled =
-      (temp >= 0 && temp <= 100) ? (int) ((temp / 100.0) * width) : (temp > 100 ? width : 0);
+  int filled = (temp >= 0 && temp <= 100000) ? (int) ((int64_t) temp * width / 100000)
+                                             : (temp > 100000 ? width : 0);
 
   const char *color;
   const char *bar_char;
 
-  if (temp < 40)
+  if (temp < 40000)
   {
     color    = COLOR_CYAN;
     bar_char = "#";
   }
-  else if (temp < 50)
+  else if (temp < 50000)
   {
     color    = COLOR_GREEN;
     bar_char = "#";
   }
-  else if (temp < 60)
+  else if (temp < 60000)
   {
     color    = COLOR_BRIGHT_GREEN;
     bar_char = "#";
   }
-  else if (temp < 70)
+  else if (temp < 70000)
   {
     color    = COLOR_YELLOW;
     bar_char = "=";
   }
-  else if (temp < 80)
+  else if (temp < 80000)
   {
     color    = COLOR_BRIGHT_YELLOW;
     bar_char = "=";
   }
-  else if (temp < 90)
+  else if (temp < 90000)
   {
     color    = COLOR_BRIGHT_RED;
     bar_char = "*";
@@ -388,6 +422,140 @@ void print_temp_bar(double temp, int width, int use_gradient)
   printf("]" COLOR_RESET);
 }
 
+/**
+ * @brief Prints a sensor's sparkline
+ *
+ * The cells are kept rendered by history_record(), so this is a copy
+ * of SPARK_WIDTH glyphs, oldest first.
+ *
+ * @param history Recorded history
+ * @param sensor Sensor index
+ */
+void print_sparkline(const TempHistory *history, int sensor)
+{
+  const char *cells  = history->spark + (size_t) sensor * SPARK_WIDTH * SPARK_CELL;
+  int         oldest = (history->spark_head + 1) % SPARK_WIDTH;
+
+  printf(COLOR_CYAN);
+  fwrite(cells + oldest * SPARK_CELL, SPARK_CELL, (size_t) (SPARK_WIDTH - oldest), stdout);
+  fwrite(cells, SPARK_CELL, (size_t) oldest, stdout);
+  printf(COLOR_RESET);
+}
+
+/**
+ * @brief Draws a multi-line graph of a sensor's history
+ *
+ * Without a graph span, plots the newest width samples (oldest on the
+ * left). With one, each column covers an equal slice of the span,
+ * read from the finest rollup tier that reaches that far back: '#'
+ * fills up to the slice's mean and ':' up to its max. The plot is
+ * scaled to its own range, at least 2C tall, and gaps are left empty.
+ * A summary line gives min/mean/max over the whole span.
+ *
+ * @param history Recorded history
+ * @param sensor Sensor index
+ * @param label Sensor label for the title
+ * @param width Number of columns, at most GRAPH_MAX_WIDTH
+ * @param height Number of rows
+ * @param config Display configuration
+ */
+void display_temp_graph(const TempHistory *history, int sensor, const char *label, int width,
+                        int height, DisplayConfig *config)
+{
+  HistoryRange series[GRAPH_MAX_WIDTH], total;
+  int32_t      lo = INT32_MAX, hi = INT32_MIN, span;
+  long         ticks, resolution;
+  char         window[16], step[16];
+
+  if (width > GRAPH_MAX_WIDTH)
+    width = GRAPH_MAX_WIDTH;
+
+  if (config->graph_span > 0)
+  {
+    ticks = config->graph_span * 1000L / (config->interval_ms > 0 ? config->interval_ms : 1000);
+    if (ticks < width)
+      ticks = width;
+  }
+  else
+  {
+    if (width > history->length)
+      width = history->length;
+    ticks = width;
+  }
+  if (width <= 0 || height <= 0)
+    return;
+
+  if (!history_series(history, sensor, ticks, width, series))
+    return;
+
+  for (int col = 0; col < width; col++)
+  {
+    if (series[col].min == TEMP_INVALID)
+      continue;
+    if (series[col].min < lo)
+      lo = series[col].min;
+    if (series[col].max > hi)
+      hi = series[col].max;
+  }
+
+  span = hi - lo < SPARK_MIN_SPAN * 10 ? SPARK_MIN_SPAN * 10 : hi - lo;
+  lo -= (span - (hi - lo)) / 2;
+
+  printf("\n");
+  printf(COLOR_BOLD COLOR_BRIGHT_CYAN "+-- [GRAPH] %s ", label);
+  if (config->graph_span > 0)
+  {
+    /* Same rounding as history_series(): whole buckets per column */
+    resolution = history_resolution(history, ticks) * width;
+    resolution = (ticks + resolution - 1) / resolution * resolution / width;
+    format_duration(ticks * config->interval_ms / 1000, window, sizeof(window));
+    format_duration(resolution * config->interval_ms / 1000, step, sizeof(step));
+    printf(COLOR_BRIGHT_BLACK "(last %s, %s per column) ", window, step);
+  }
+  else
+  {
+    printf(COLOR_BRIGHT_BLACK "(last %d samples) ", width);
+  }
+  print_separator(40, 2);
+  printf(COLOR_RESET "\n");
+
+  for (int row = height - 1; row >= 0; row--)
+  {
+    int32_t threshold = lo + (int32_t) (((int64_t) row * 2 + 1) * span / (2 * height));
+
+    printf(COLOR_BRIGHT_WHITE "| " COLOR_RESET);
+    if (row == height - 1)
+      print_temperature(lo + span, config->use_celsius);
+    else if (row == 0)
+      print_temperature(lo, config->use_celsius);
+    else
+      printf("       ");
+    printf(COLOR_BRIGHT_BLACK " |" COLOR_CYAN);
+
+    for (int col = 0; col < width; col++)
+    {
+      const HistoryRange *r = &series[col];
+
+      if (r->min == TEMP_INVALID || r->max < threshold)
+        putchar(' ');
+      else
+        putchar(r->mean >= threshold ? '#' : ':');
+    }
+    printf(COLOR_RESET "\n");
+  }
+
+  if (history_query(history, sensor, ticks, &total))
+  {
+    printf(COLOR_BRIGHT_WHITE "| " COLOR_BRIGHT_BLACK "min " COLOR_RESET);
+    print_temperature(total.min, config->use_celsius);
+    printf(COLOR_BRIGHT_BLACK " mean " COLOR_RESET);
+    print_temperature(total.mean, config->use_celsius);
+    printf(COLOR_BRIGHT_BLACK " max " COLOR_RESET);
+    print_temperature(total.max, config->use_celsius);
+    printf("\n");
+  }
+}
+
 /**
  * @brief Prints fan speed information
  *
@@ -426,16 +594,71 @@ void print_fan_speed(int rpm, int percent)
   printf("%s%5d RPM (%3d%%)" COLOR_RESET, color, rpm, percent);
 }
 
-void display_sensor_group(TempSensor *sensors, int count, SensorType type, DisplayConfig *config)
+/**
+ * @brief Prints a sensor's mean, deviation and percentiles
+ *
+ * Format: "avg X sd Y p50 X p95 X p99 X". Percentiles are omitted
+ * when the snapshot comes from a sampler without histograms.
+ *
+ * @param snapshot Readings for this frame
+ * @param i Sensor index
+ * @param config Display configuration
+ */
+static void print_sensor_distribution(const SensorSnapshot *snapshot, int i,
+                                      DisplayConfig *config)
+{
+  char    sd_text[MILLI_STR_MAX];
+  int32_t mean = (int32_t) (snapshot->temp_mean[i] + (snapshot->temp_mean[i] < 0 ? -0.5 : 0.5));
+  int32_t sd   = welford_stddev(snapshot->temp_m2[i], snapshot->read_count[i]);
+
+  if (snapshot->read_count[i] == 0)
+    return;
+
+  /* A spread converts with the scale factor only, not the offset */
+  if (!config->use_celsius)
+    sd = (int32_t) ((int64_t) sd * 9 / 5);
+  format_millidegrees(sd_text, sd, 1);
+
+  printf(COLOR_BRIGHT_BLACK " avg ");
+  print_temperature(mean, config->use_celsius);
+  printf(" sd %4s", sd_text);
+
+  if (snapshot->temp_p50[i] != TEMP_INVALID)
+  {
+    printf(" p50 ");
+    print_temperature(snapshot->temp_p50[i], config->use_celsius);
+    printf(" p95 ");
+    print_temperature(snapshot->temp_p95[i], config->use_celsius);
+    printf(" p99 ");
+    print_temperature(snapshot->temp_p99[i], config->use_celsius);
+  }
+  printf(COLOR_RESET);
+}
+
+/**
+ * @brief Renders one sensor type group from a snapshot
+ *
+ * Only reads values from the snapshot; the registry supplies labels,
+ * metadata and the index list of this type. No sysfs access happens
+ * here.
+ *
+ * @param registry Sensor registry (metadata and type index)
+ * @param snapshot Readings for this frame
+ * @param history Recorded history for sparklines, NULL if not kept
+ * @param type Sensor type to render
+ * @param config Display configuration
+ */
+void display_sensor_group(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                          const TempHistory *history, SensorType type, DisplayConfig *config)
 {
-  int found = 0;
+  const int *first = registry->by_type + registry->type_start[type];
+  const int *last  = registry->by_type + registry->type_start[type + 1];
+  int        found = 0;
 
-  for (int i = 0; i < count; i++)
+  for (const int *k = first; k < last; k++)
   {
-    if (sensors[i].type == type && sensors[i].active)
-    {
-      found++;
-    }
+    if (*k < snapshot->count)
+      found += snapshot->active[*k];
   }
 
   if (found == 0)
@@ -450,44 +673,53 @@ void display_sensor_group(TempSensor *sensors, int count, SensorType type, Displ
   print_separator(40, 2);
   printf(COLOR_RESET "\n");
 
-  for (int i = 0; i < count; i++)
+  for (const int *k = first; k < last; k++)
   {
-    if (sensors[i].type != type || !sensors[i].active)
-      continue;
+    int               i = *k;
+    const TempSensor *s = &registry->sensors[i];
 
-    update_sensor_data(&sensors[i]);
+    if (i >= snapshot->count || !snapshot->active[i])
+      continue;
 
-    const char *status_color = get_status_color(sensors[i].status);
+    SensorStatus status       = (SensorStatus) snapshot->status[i];
+    const char * status_color = get_status_color(status);
 
     printf(COLOR_BRIGHT_WHITE "| " COLOR_RESET);
-    printf("%-28s ", sensors[i].label);
+    printf("%-28s ", s->label);
 
     printf("%s", status_color);
-    print_temperature(sensors[i].temp_current, config->use_celsius);
+    print_temperature(snapshot->temp_current[i], config->use_celsius);
     printf(COLOR_RESET " ");
 
-    print_temp_bar(sensors[i].temp_current, 20, 1);
+    print_temp_bar(snapshot->temp_current[i], 20, 1);
+
+    if (config->show_graphs && history && i < history->count)
+    {
+      printf(" ");
+      print_sparkline(history, i);
+    }
 
     if (config->show_stats)
     {
       printf(" " COLOR_BRIGHT_BLACK "[");
-      print_temperature(sensors[i].temp_min, config->use_celsius);
+      print_temperature(snapshot->temp_min[i], config->use_celsius);
       printf("->");
-      print_temperature(sensors[i].temp_max, config->use_celsius);
+      print_temperature(snapshot->temp_max[i], config->use_celsius);
       printf("]" COLOR_RESET);
+      print_sensor_distribution(snapshot, i, config);
     }
 
-    if (sensors[i].has_fan && config->show_fans)
+    if (s->has_fan && config->show_fans)
     {
       printf(" ");
-      print_fan_speed(sensors[i].fan_speed_rpm, sensors[i].fan_speed_percent);
+      print_fan_speed(snapshot->fan_rpm[i], snapshot->fan_percent[i]);
     }
 
-    if (sensors[i].status == STATUS_CRITICAL)
+    if (status == STATUS_CRITICAL)
     {
       printf(" " COLOR_RED "[!] CRITICAL!" COLOR_RESET);
     }
-    else if (sensors[i].status == STATUS_WARN)
+    else if (status == STATUS_WARN)
     {
       printf(" " COLOR_YELLOW "[!] High" COLOR_RESET);
     }
@@ -496,13 +728,26 @@ void display_sensor_group(TempSensor *sensors, int count, SensorType type, Displ
   }
 }
 
-void display_fan_sensors(TempSensor *sensors, int count, DisplayConfig *config)
+/**
+ * @brief Renders the fans paired with temperature sensors
+ *
+ * Walks the fan registry, which lists paired fans in table order,
+ * instead of scanning every sensor for has_fan.
+ *
+ * @param registry Sensor registry (fan registry and labels)
+ * @param snapshot Readings for this frame
+ * @param config Display configuration
+ */
+void display_fan_sensors(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                         DisplayConfig *config)
 {
   int found = 0;
 
-  for (int i = 0; i < count; i++)
+  for (int f = 0; f < registry->fan_count; f++)
   {
-    if (sensors[i].has_fan && sensors[i].fan_speed_rpm > 0)
+    int i = registry->fans[f].sensor;
+
+    if (i >= 0 && i < snapshot->count && snapshot->fan_rpm[i] > 0)
     {
       found++;
     }
@@ -517,18 +762,20 @@ void display_fan_sensors(TempSensor *sensors, int count, DisplayConfig *config)
   print_separator(40, 2);
   printf(COLOR_RESET "\n");
 
-  for (int i = 0; i < count; i++)
+  for (int f = 0; f < registry->fan_count; f++)
   {
-    if (!sensors[i].has_fan || sensors[i].fan_speed_rpm <= 0)
+    int i = registry->fans[f].sensor;
+
+    if (i < 0 || i >= snapshot->count || snapshot->fan_rpm[i] <= 0)
       continue;
 
     printf(COLOR_BRIGHT_WHITE "| " COLOR_RESET);
-    printf("%-28s ", sensors[i].label);
-    print_fan_speed(sensors[i].fan_speed_rpm, sensors[i].fan_speed_percent);
+    printf("%-28s ", registry->sensors[i].label);
+    print_fan_speed(snapshot->fan_rpm[i], snapshot->fan_percent[i]);
 
     printf(" [");
     int bar_width = 15;
-    int filled    = (sensors[i].fan_speed_percent * bar_width) / 100;
+    int filled    = (snapshot->fan_percent[i] * bar_width) / 100;
     for (int j = 0; j < bar_width; j++)
     {
       if (j < filled)
@@ -548,19 +795,32 @@ void display_fan_sensors(TempSensor *sensors, int count, DisplayConfig *config)
   (void) config;
 }
 
-void display_all_sensors(TempSensor *sensors, int count, DisplayConfig *config)
+void display_all_sensors(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                         const TempHistory *history, DisplayConfig *config)
 {
-  SensorType types[] = {SENSOR_CPU,    SENSOR_GPU, SENSOR_NVME, SENSOR_CHIPSET,
-                        SENSOR_MEMORY, SENSOR_VRM, SENSOR_DISK, SENSOR_OTHER};
-
-  for (int i = 0; i < 8; i++)
+  for (int t = 0; t < SENSOR_TYPE_COUNT; t++)
   {
-    display_sensor_group(sensors, count, types[i], config);
+    display_sensor_group(registry, snapshot, history, (SensorType) t, config);
   }
 
   if (config->show_fans)
   {
-    display_fan_sensors(sensors, count, config);
+    display_fan_sensors(registry, snapshot, config);
+  }
+
+  if (config->show_graphs && history && history->length > 1)
+  {
+    int hottest = -1;
+
+    for (int i = 0; i < snapshot->count && i < history->count; i++)
+    {
+      if (snapshot->active[i] &&
+          (hottest < 0 || snapshot->temp_current[i] > snapshot->temp_current[hottest]))
+        hottest = i;
+    }
+
+    if (hottest >= 0)
+      display_temp_graph(history, hottest, registry->sensors[hottest].label, 60, 8, config);
   }
 }
 
@@ -625,12 +885,23 @@ void display_statistics(SystemStats *stats, DisplayConfig *config)
 
   printf("\n");
 
+  if (stats->tail_p99 != TEMP_INVALID)
+  {
+    printf(COLOR_BRIGHT_WHITE "| " COLOR_RESET);
+    printf(COLOR_YELLOW "Tail (worst):" COLOR_RESET);
+    printf("    p95: ");
+    print_temperature(stats->tail_p95, config->use_celsius);
+    printf("  |  p99: ");
+    print_temperature(stats->tail_p99, config->use_celsius);
+    printf("\n");
+  }
+
   printf(COLOR_BRIGHT_CYAN "+");
   print_separator(84, 2);
   printf(COLOR_RESET "\n");
 }
 
-void display_sensor_list(TempSensor *sensors, int count)
+void display_sensor_list(const TempSensor *sensors, int count)
 {
   printf("\n");
   printf(COLOR_BRIGHT_CYAN
@@ -670,3 +941,48 @@ void display_sensor_list(TempSensor *sensors, int count)
                            "======+\n" COLOR_RESET);
   printf("\n");
 }
+
+/**
+ * @brief Displays the fan registry (for --list mode)
+ *
+ * Shows every detected fan with its scan-time speed and the
+ * temperature sensor it is paired with, if any.
+ *
+ * @param sensors Sensor table the fans are paired against
+ * @param fans Fan registry
+ * @param count Number of fans
+ */
+void display_fan_list(const TempSensor *sensors, const FanSensor *fans, int count)
+{
+  if (count == 0)
+    return;
+
+  printf(COLOR_BRIGHT_CYAN
+         "+============================================================================+\n");
+  printf("|" COLOR_RESET " " COLOR_BOLD "DETECTED FANS" COLOR_RESET);
+  printf(" " COLOR_BRIGHT_BLACK "(%3d total)" COLOR_RESET, count);
+  printf("                                                  " COLOR_BRIGHT_CYAN "|\n");
+  printf("+============================================================================+"
+         "\n" COLOR_RESET);
+
+  for (int i = 0; i < count; i++)
+  {
+    const FanSensor *fan = &fans[i];
+    char             paired[MAX_NAME_LEN];
+
+    if (fan->sensor >= 0)
+      snprintf(paired, sizeof(paired), "%s", sensors[fan->sensor].label);
+    else
+      snprintf(paired, sizeof(paired), "(unpaired)");
+
+    printf(COLOR_BRIGHT_CYAN "|" COLOR_RESET);
+    printf(" " COLOR_YELLOW "[%3d]" COLOR_RESET, i + 1);
+    printf(" %-14.14s | %-16.16s | %5d RPM | %-20.20s ", fan->label, fan->name, fan->speed_rpm,
+           paired);
+    printf(COLOR_BRIGHT_CYAN "|\n" COLOR_RESET);
+  }
+
+  printf(COLOR_BRIGHT_CYAN "+======================================================================"
+                           "======+\n" COLOR_RESET);
+  printf("\n");
+}
@@ -15,10 +15,14 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include "history.h"
 #include "sensor.h"
 
 #include <stddef.h>
 
+/* Widest graph display_temp_graph() draws, in columns */
+#define GRAPH_MAX_WIDTH 120
+
 typedef struct
 {
   int use_celsius;
@@ -28,14 +32,12 @@ typedef struct
   int compact_mode;
   int color_mode;
   int refresh_rate;
-} DisplayConfig;
+  int interval_ms; /* Sampling interval; refresh_rate seconds unless --interval */
+  int graph_span;  /* Seconds covered by the graph, 0 for one sample per column */
 
-typedef struct
-{
-  double temps[100];
-  int    index;
-  int    size;
-} TempHistory;
+  long long replay_ms;    /* Recorded time of the frame on screen, 0 when live */
+  double    replay_speed; /* --speed factor during --replay, 0 for --max */
+} DisplayConfig;
 
 void clear_screen(void);
 void get_terminal_size(int *rows, int *cols);
@@ -47,33 +49,37 @@ void exit_alternate_screen(void);
 void set_color(const char *color);
 void reset_color(void);
 
-void   print_temperature(double temp, int use_celsius);
-double celsius_to_fahrenheit(double celsius);
+void    print_temperature(int32_t temp, int use_celsius);
+int32_t celsius_to_fahrenheit(int32_t celsius);
 
-void print_header(const char *version);
+void print_header(const char *version, const DisplayConfig *config);
 void print_footer(DisplayConfig *config);
 void print_separator(int width, int style);
 void print_box_top(int width);
 void print_box_bottom(int width);
 void print_box_line(const char *text, int width);
 
-void print_temp_bar(double temp, int width, int use_gradient);
-void print_sparkline(TempHistory *history, int width);
+void print_temp_bar(int32_t temp, int width, int use_gradient);
+void print_sparkline(const TempHistory *history, int sensor);
 void print_gauge(double value, double max, int width);
 void print_fan_speed(int rpm, int percent);
 
-void display_sensor_group(TempSensor *sensors, int count, SensorType type, DisplayConfig *config);
-void display_all_sensors(TempSensor *sensors, int count, DisplayConfig *config);
-void display_fan_sensors(TempSensor *sensors, int count, DisplayConfig *config);
+void display_sensor_group(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                          const TempHistory *history, SensorType type, DisplayConfig *config);
+void display_all_sensors(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                         const TempHistory *history, DisplayConfig *config);
+void display_fan_sensors(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                         DisplayConfig *config);
 void display_statistics(SystemStats *stats, DisplayConfig *config);
 void display_system_info(void);
-void display_sensor_list(TempSensor *sensors, int count);
+void display_sensor_list(const TempSensor *sensors, int count);
+void display_fan_list(const TempSensor *sensors, const FanSensor *fans, int count);
 
-void init_temp_history(TempHistory *history, int size);
-void add_temp_history(TempHistory *history, double temp);
-void display_temp_graph(TempHistory *history, const char *label, int width, int height);
+void display_temp_graph(const TempHistory *history, int sensor, const char *label, int width,
+                        int height, DisplayConfig *config);
 
 void        get_current_time(char *buffer, size_t size);
+void        format_time_ms(long long timestamp_ms, char *buffer, size_t size);
 void        format_uptime(char *buffer, size_t size);
 const char *get_bar_char(double temp);
 
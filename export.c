@@ -0,0 +1,870 @@
+/**
+ * @file export.c
+ * @brief Temp Monitor - Machine-readable output of sensor snapshots
+ *
+ * JSON Lines and CSV writers for --format, the Prometheus text
+ * exposition served by --listen and the StatsD and InfluxDB lines
+ * pushed by --statsd and --influx. Temperatures and critical thresholds
+ * are degrees Celsius with up to three decimals, trailing zeros
+ * dropped; failed reads are null (JSON), empty (CSV) or NaN
+ * (Prometheus) or left out (StatsD, InfluxDB). Fan speeds are RPM and
+ * only present for sensors with a paired fan.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "export.h"
+
+#include "registry.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Upper bound of the per-tick bytes of one sensor beyond its constant fields */
+#define EXPORT_SENSOR_MAX 128
+
+/* Upper bound of the per-tick bytes outside the sensors */
+#define EXPORT_TICK_MAX 96
+
+/* Upper bound of the metric family headers and aggregates of a Prometheus body */
+#define EXPORT_METRICS_MAX 4096
+
+/* Cached Prometheus series: temperature, status and fan of every sensor, ... */
+#define EXPORT_SENSOR_SERIES 3
+
+/* ... then the SystemStats gauges */
+#define EXPORT_AGGREGATE_SERIES 12
+
+/* Bytes of a cached line beyond its label set: metric name, value, separators */
+#define EXPORT_LINE_MAX 64
+
+static const char *const status_names[] = {"ok", "warn", "critical", "error"};
+
+/**
+ * @brief Parses a --format name
+ *
+ * @return The format, or EXPORT_NONE if the name is unknown
+ */
+ExportFormat export_parse_format(const char *name)
+{
+  if (strcmp(name, "jsonl") == 0 || strcmp(name, "json") == 0)
+    return EXPORT_JSONL;
+  if (strcmp(name, "csv") == 0)
+    return EXPORT_CSV;
+  return EXPORT_NONE;
+}
+
+/**
+ * @brief Appends an unsigned decimal number
+ *
+ * @return End of the written digits
+ */
+static char *put_uint(char *out, unsigned long long value)
+{
+  char digits[20];
+  int  n = 0;
+
+  do
+  {
+    digits[n++] = (char) ('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+
+  while (n > 0)
+    *out++ = digits[--n];
+  return out;
+}
+
+/**
+ * @brief Appends a signed decimal number
+ */
+static char *put_int(char *out, long long value)
+{
+  if (value < 0)
+  {
+    *out++ = '-';
+    return put_uint(out, 0ull - (unsigned long long) value);
+  }
+  return put_uint(out, (unsigned long long) value);
+}
+
+/**
+ * @brief Appends millidegrees as degrees without trailing zeros ("45.5")
+ */
+static char *put_temp(char *out, int32_t milli)
+{
+  char *end = out + format_millidegrees(out, milli, 3);
+
+  while (end[-1] == '0')
+    end--;
+  if (end[-1] == '.')
+    end--;
+  return end;
+}
+
+static char *put_text(char *out, const char *text)
+{
+  size_t len = strlen(text);
+  memcpy(out, text, len);
+  return out + len;
+}
+
+/**
+ * @brief Appends a quoted JSON string; needs up to 6 bytes per input byte + 2
+ */
+static char *put_json_string(char *out, const char *text)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  *out++ = '"';
+  for (const unsigned char *p = (const unsigned char *) text; *p; p++)
+  {
+    if (*p == '"' || *p == '\\')
+    {
+      *out++ = '\\';
+      *out++ = (char) *p;
+    }
+    else if (*p < 0x20)
+    {
+      out = put_text(out, "\\u00");
+      *out++ = hex[*p >> 4];
+      *out++ = hex[*p & 15];
+    }
+    else
+      *out++ = (char) *p;
+  }
+  *out++ = '"';
+  return out;
+}
+
+/**
+ * @brief Appends a Prometheus label value; up to 2 bytes per input byte + 2
+ */
+static char *put_label_value(char *out, const char *text)
+{
+  *out++ = '"';
+  for (const char *p = text; *p; p++)
+  {
+    if (*p == '"' || *p == '\\')
+      *out++ = '\\';
+    if (*p == '\n')
+    {
+      *out++ = '\\';
+      *out++ = 'n';
+    }
+    else
+      *out++ = *p;
+  }
+  *out++ = '"';
+  return out;
+}
+
+/**
+ * @brief Appends a StatsD name component: [A-Za-z0-9_-] kept, the rest '_'
+ */
+static char *put_statsd_name(char *out, const char *text)
+{
+  if (*text == '\0')
+    *out++ = '_';
+  for (const char *p = text; *p; p++)
+  {
+    char c = *p;
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-')
+      *out++ = c;
+    else
+      *out++ = '_';
+  }
+  return out;
+}
+
+/**
+ * @brief Appends an InfluxDB tag value; up to 2 bytes per input byte
+ *
+ * Commas, equal signs and spaces are escaped; tag values cannot hold
+ * control characters or be empty, so those become '_'.
+ */
+static char *put_influx_tag(char *out, const char *text)
+{
+  if (*text == '\0')
+    *out++ = '_';
+  for (const unsigned char *p = (const unsigned char *) text; *p; p++)
+  {
+    if (*p == ',' || *p == '=' || *p == ' ' || *p == '\\')
+      *out++ = '\\';
+    *out++ = *p < 0x20 ? '_' : (char) *p;
+  }
+  return out;
+}
+
+/**
+ * @brief Appends a CSV field, quoted only if needed; up to 2 bytes per input byte + 2
+ */
+static char *put_csv_field(char *out, const char *text)
+{
+  if (!strpbrk(text, ",\"\r\n"))
+    return put_text(out, text);
+
+  *out++ = '"';
+  for (const char *p = text; *p; p++)
+  {
+    if (*p == '"')
+      *out++ = '"';
+    *out++ = *p;
+  }
+  *out++ = '"';
+  return out;
+}
+
+/**
+ * @brief Formats the constant fields of every sensor
+ *
+ * JSON Lines: "name":..,"label":..,"type":..,"crit":..
+ * CSV with --per-sensor: name,label,type,crit
+ * Prometheus: {name="..",label="..",type=".."}
+ * StatsD: temp.NAME.LABEL.
+ * InfluxDB: temp,name=..,label=..,type=.. crit=..
+ */
+static int build_fields(Exporter *ex)
+{
+  const SensorRegistry *registry = ex->registry;
+  size_t                size     = 1;
+  char *                out;
+
+  for (int i = 0; i < registry->count; i++)
+    size += 6 * (strlen(registry->sensors[i].name) + strlen(registry->sensors[i].label)) + 64;
+
+  ex->fields    = malloc(size);
+  ex->field_end = malloc((registry->count > 0 ? (size_t) registry->count : 1) * sizeof(size_t));
+  if (!ex->fields || !ex->field_end)
+    return 0;
+
+  out = ex->fields;
+  for (int i = 0; i < registry->count; i++)
+  {
+    const TempSensor *s = &registry->sensors[i];
+
+    if (ex->format == EXPORT_JSONL)
+    {
+      out = put_text(out, "\"name\":");
+      out = put_json_string(out, s->name);
+      out = put_text(out, ",\"label\":");
+      out = put_json_string(out, s->label);
+      out = put_text(out, ",\"type\":\"");
+      out = put_text(out, get_type_name(s->type));
+      out = put_text(out, "\",\"crit\":");
+      out = put_temp(out, s->temp_critical);
+    }
+    else if (ex->per_sensor)
+    {
+      out    = put_csv_field(out, s->name);
+      *out++ = ',';
+      out    = put_csv_field(out, s->label);
+      *out++ = ',';
+      out    = put_text(out, get_type_name(s->type));
+      *out++ = ',';
+      out    = put_temp(out, s->temp_critical);
+    }
+    else if (ex->format == EXPORT_PROMETHEUS)
+    {
+      out = put_text(out, "{name=");
+      out = put_label_value(out, s->name);
+      out = put_text(out, ",label=");
+      out = put_label_value(out, s->label);
+      out = put_text(out, ",type=\"");
+      out = put_text(out, get_type_name(s->type));
+      out = put_text(out, "\"}");
+    }
+    else if (ex->format == EXPORT_STATSD)
+    {
+      out    = put_text(out, "temp.");
+      out    = put_statsd_name(out, s->name);
+      *out++ = '.';
+      out    = put_statsd_name(out, s->label);
+      *out++ = '.';
+    }
+    else if (ex->format == EXPORT_INFLUX)
+    {
+      out = put_text(out, "temp,name=");
+      out = put_influx_tag(out, s->name);
+      out = put_text(out, ",label=");
+      out = put_influx_tag(out, s->label);
+      out = put_text(out, ",type=");
+      out = put_text(out, get_type_name(s->type));
+      out = put_text(out, " crit=");
+      out = put_temp(out, s->temp_critical);
+    }
+    ex->field_end[i] = (size_t) (out - ex->fields);
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Appends the HELP and TYPE lines of a metric family
+ */
+static char *put_family(char *out, const char *name, const char *type, const char *help)
+{
+  out = put_text(out, "# HELP ");
+  out = put_text(out, name);
+  *out++ = ' ';
+  out = put_text(out, help);
+  out = put_text(out, "\n# TYPE ");
+  out = put_text(out, name);
+  *out++ = ' ';
+  out = put_text(out, type);
+  *out++ = '\n';
+  return out;
+}
+
+/**
+ * @brief Appends one sample line: name, a sensor's label set and a value
+ */
+static char *put_sample(const Exporter *ex, int i, const char *name, char *out)
+{
+  size_t start = i > 0 ? ex->field_end[i - 1] : 0;
+
+  out = put_text(out, name);
+  memcpy(out, ex->fields + start, ex->field_end[i] - start);
+  out += ex->field_end[i] - start;
+  *out++ = ' ';
+  return out;
+}
+
+/**
+ * @brief Appends a temperature sample value, NaN if invalid
+ */
+static char *put_metric_temp(char *out, int32_t milli)
+{
+  out    = milli != TEMP_INVALID ? put_temp(out, milli) : put_text(out, "NaN");
+  *out++ = '\n';
+  return out;
+}
+
+/**
+ * @brief Allocates the Prometheus series line cache
+ *
+ * Every series gets a slot wide enough for the longest label set, so
+ * a line is found by index and rewritten in place.
+ */
+static int build_series(Exporter *ex)
+{
+  const SensorRegistry *registry = ex->registry;
+  size_t                series   = (size_t) registry->count * EXPORT_SENSOR_SERIES +
+                                   EXPORT_AGGREGATE_SERIES;
+  size_t                widest   = 0;
+
+  for (int i = 0; i < registry->count; i++)
+  {
+    size_t size = ex->field_end[i] - (i > 0 ? ex->field_end[i - 1] : 0);
+    if (size > widest)
+      widest = size;
+  }
+
+  ex->line_stride = widest + EXPORT_LINE_MAX;
+  ex->lines       = malloc(series * ex->line_stride);
+  ex->line_size   = calloc(series, sizeof(uint32_t));
+  ex->line_value  = malloc(series * sizeof(int32_t));
+  return ex->lines && ex->line_size && ex->line_value;
+}
+
+/**
+ * @brief Formats the start of every Prometheus body
+ *
+ * Critical thresholds never change, so that whole family is
+ * formatted once and copied in front of the per-tick families.
+ */
+static int build_metrics_header(Exporter *ex)
+{
+  const SensorRegistry *registry = ex->registry;
+  size_t                size     = 256;
+  char *                out;
+
+  for (int i = 0; i < registry->count; i++)
+    size += ex->field_end[i] - (i > 0 ? ex->field_end[i - 1] : 0) + 64;
+
+  ex->header = malloc(size);
+  if (!ex->header)
+    return 0;
+
+  out = put_family(ex->header, "temp_sensor_critical_celsius", "gauge",
+                   "Critical temperature threshold of the sensor.");
+  for (int i = 0; i < registry->count; i++)
+  {
+    out = put_sample(ex, i, "temp_sensor_critical_celsius", out);
+    out = put_metric_temp(out, registry->sensors[i].temp_critical);
+  }
+
+  ex->header_size = (size_t) (out - ex->header);
+  return build_series(ex);
+}
+
+/**
+ * @brief Formats the CSV header row
+ *
+ * --per-sensor has fixed columns; otherwise there is one temperature
+ * column per sensor, then one RPM column per sensor with a fan.
+ */
+static int build_header(Exporter *ex)
+{
+  const SensorRegistry *registry = ex->registry;
+  size_t                size     = 128;
+  char *                out;
+
+  for (int i = 0; i < registry->count; i++)
+    size += 4 * (strlen(registry->sensors[i].name) + strlen(registry->sensors[i].label)) + 32;
+
+  ex->header = malloc(size);
+  if (!ex->header)
+    return 0;
+
+  out = ex->header;
+  if (ex->per_sensor)
+    out = put_text(out, "timestamp_ms,tick,name,label,type,crit,temp,status,fan_rpm");
+  else
+  {
+    out = put_text(out, "timestamp_ms,tick");
+    for (int pass = 0; pass < 2; pass++)
+    {
+      for (int i = 0; i < registry->count; i++)
+      {
+        const TempSensor *s = &registry->sensors[i];
+        char              column[2 * MAX_NAME_LEN + 8];
+
+        if (pass == 1 && !s->has_fan)
+          continue;
+        snprintf(column, sizeof(column), "%s/%s%s", s->name, s->label, pass ? " rpm" : "");
+        *out++ = ',';
+        out    = put_csv_field(out, column);
+      }
+    }
+  }
+  *out++ = '\n';
+
+  ex->header_size = (size_t) (out - ex->header);
+  return 1;
+}
+
+/**
+ * @brief Prepares an exporter for a sensor table
+ *
+ * @param exporter Exporter to initialize
+ * @param registry Sensor table; must stay valid until export_free()
+ * @param format Output format
+ * @param per_sensor 1 for one record per sensor per tick (JSON Lines and CSV)
+ * @return 1 on success, 0 if out of memory
+ */
+int export_init(Exporter *exporter, const SensorRegistry *registry, ExportFormat format,
+                int per_sensor)
+{
+  memset(exporter, 0, sizeof(*exporter));
+  exporter->format     = format;
+  exporter->per_sensor = per_sensor;
+  exporter->registry   = registry;
+
+  if (!build_fields(exporter) || (format == EXPORT_CSV && !build_header(exporter)) ||
+      (format == EXPORT_PROMETHEUS && !build_metrics_header(exporter)))
+    return 0;
+
+  /* Sized once: the header, then the worst case of every sensor */
+  exporter->capacity = exporter->header_size + EXPORT_TICK_MAX +
+                       (size_t) registry->count * EXPORT_SENSOR_MAX +
+                       (registry->count > 0 ? exporter->field_end[registry->count - 1] : 0);
+
+  /* Prometheus repeats the label set on three sample lines per sensor,
+     StatsD the name prefix on up to four */
+  if (format == EXPORT_PROMETHEUS)
+    exporter->capacity = 3 * exporter->capacity + EXPORT_METRICS_MAX;
+  else if (format == EXPORT_STATSD)
+    exporter->capacity = 4 * exporter->capacity;
+  exporter->buffer = malloc(exporter->capacity);
+  return exporter->buffer != NULL;
+}
+
+/**
+ * @brief Appends the per-tick fields of sensor i
+ */
+static char *put_reading(const Exporter *ex, const SensorSnapshot *snapshot, int i, char *out)
+{
+  const TempSensor *s    = &ex->registry->sensors[i];
+  int32_t           temp = snapshot->temp_current[i];
+  int               json = ex->format == EXPORT_JSONL;
+
+  out = put_text(out, json ? ",\"temp\":" : ",");
+  if (temp != TEMP_INVALID)
+    out = put_temp(out, temp);
+  else if (json)
+    out = put_text(out, "null");
+
+  out = put_text(out, json ? ",\"status\":\"" : ",");
+  out = put_text(out, status_names[snapshot->status[i] & 3]);
+  if (json)
+    *out++ = '"';
+
+  if (json && !s->has_fan)
+    return out;
+
+  out = put_text(out, json ? ",\"fan_rpm\":" : ",");
+  if (s->has_fan && snapshot->fan_rpm[i] >= 0)
+    out = put_int(out, snapshot->fan_rpm[i]);
+  else if (json)
+    out = put_text(out, "null");
+  return out;
+}
+
+/**
+ * @brief Appends the timestamp and tick that start every record
+ */
+static char *put_stamp(const Exporter *ex, const SensorSnapshot *snapshot, char *out)
+{
+  if (ex->format == EXPORT_JSONL)
+  {
+    out = put_text(out, "{\"ts\":");
+    out = put_int(out, snapshot->timestamp_ms);
+    out = put_text(out, ",\"tick\":");
+    out = put_uint(out, snapshot->tick);
+    *out++ = ',';
+  }
+  else
+  {
+    out    = put_int(out, snapshot->timestamp_ms);
+    *out++ = ',';
+    out    = put_uint(out, snapshot->tick);
+  }
+  return out;
+}
+
+/**
+ * @brief Formats one tick and writes it with a single write()
+ *
+ * The first call also writes the CSV header row.
+ *
+ * @param exporter Initialized exporter
+ * @param snapshot Readings to write
+ * @param fd Destination, e.g. STDOUT_FILENO
+ * @return 1 on success, 0 on a write error (errno set)
+ */
+int export_write(Exporter *exporter, const SensorSnapshot *snapshot, int fd)
+{
+  const Exporter *ex    = exporter;
+  int             count = snapshot->count < ex->registry->count ? snapshot->count
+                                                                 : ex->registry->count;
+  char *          out   = ex->buffer;
+  size_t          start = 0;
+
+  if (ex->header && !ex->header_sent)
+  {
+    memcpy(out, ex->header, ex->header_size);
+    out += ex->header_size;
+  }
+
+  if (ex->format == EXPORT_CSV && !ex->per_sensor)
+  {
+    /* Wide row: every temperature, then every fan */
+    out = put_stamp(ex, snapshot, out);
+    for (int i = 0; i < count; i++)
+    {
+      *out++ = ',';
+      if (snapshot->temp_current[i] != TEMP_INVALID)
+        out = put_temp(out, snapshot->temp_current[i]);
+    }
+    for (int i = 0; i < count; i++)
+    {
+      if (!ex->registry->sensors[i].has_fan)
+        continue;
+      *out++ = ',';
+      if (snapshot->fan_rpm[i] >= 0)
+        out = put_int(out, snapshot->fan_rpm[i]);
+    }
+    *out++ = '\n';
+  }
+  else if (ex->per_sensor)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      out = put_stamp(ex, snapshot, out);
+      if (ex->format == EXPORT_CSV)
+        *out++ = ',';
+      start = i > 0 ? ex->field_end[i - 1] : 0;
+      memcpy(out, ex->fields + start, ex->field_end[i] - start);
+      out += ex->field_end[i] - start;
+      out = put_reading(ex, snapshot, i, out);
+      out = put_text(out, ex->format == EXPORT_JSONL ? "}\n" : "\n");
+    }
+  }
+  else
+  {
+    out = put_stamp(ex, snapshot, out);
+    out = put_text(out, "\"sensors\":[");
+    for (int i = 0; i < count; i++)
+    {
+      out    = put_text(out, i > 0 ? ",{" : "{");
+      start  = i > 0 ? ex->field_end[i - 1] : 0;
+      memcpy(out, ex->fields + start, ex->field_end[i] - start);
+      out += ex->field_end[i] - start;
+      out    = put_reading(ex, snapshot, i, out);
+      *out++ = '}';
+    }
+    out = put_text(out, "]}\n");
+  }
+
+  if (!write_fd(fd, ex->buffer, (size_t) (out - ex->buffer)))
+    return 0;
+
+  exporter->header_sent = 1;
+  return 1;
+}
+
+/**
+ * @brief Appends the sample line of a cached series
+ *
+ * The line is formatted again only if its value changed since the
+ * last body; otherwise the cached bytes are copied as they are.
+ *
+ * @param series Index of the series in the line cache
+ * @param name Metric name, with its label set for the aggregates
+ * @param i Sensor whose label set follows the name, or -1
+ * @param value Millidegrees if temp, else an integer; TEMP_INVALID or a
+ *              negative integer is NaN
+ * @param temp 1 to format value as a temperature
+ * @return End of the copied line
+ */
+static char *put_series(Exporter *ex, int series, const char *name, int i, int32_t value,
+                        int temp, char *out)
+{
+  char *   line = ex->lines + (size_t) series * ex->line_stride;
+  uint32_t size = ex->line_size[series];
+
+  if (size == 0 || ex->line_value[series] != value)
+  {
+    char *end;
+
+    if (i >= 0)
+      end = put_sample(ex, i, name, line);
+    else
+    {
+      end    = put_text(line, name);
+      *end++ = ' ';
+    }
+    if (temp)
+      end = put_metric_temp(end, value);
+    else
+    {
+      end    = value >= 0 ? put_int(end, value) : put_text(end, "NaN");
+      *end++ = '\n';
+    }
+    size                   = (uint32_t) (end - line);
+    ex->line_size[series]  = size;
+    ex->line_value[series] = value;
+  }
+
+  memcpy(out, line, size);
+  return out + size;
+}
+
+/**
+ * @brief Appends an aggregate temperature sample, NaN without sensors
+ */
+static char *put_aggregate(Exporter *ex, int k, const char *sample, int32_t milli, int count,
+                           char *out)
+{
+  int series = ex->registry->count * EXPORT_SENSOR_SERIES + k;
+  return put_series(ex, series, sample, -1, count > 0 ? milli : TEMP_INVALID, 1, out);
+}
+
+/**
+ * @brief Appends a cached sample with a count as its value
+ */
+static char *put_count(Exporter *ex, int k, const char *sample, int value, char *out)
+{
+  int series = ex->registry->count * EXPORT_SENSOR_SERIES + k;
+  return put_series(ex, series, sample, -1, value, 0, out);
+}
+
+/**
+ * @brief Formats a Prometheus text exposition (version 0.0.4) body
+ *
+ * Per-sensor gauges are labelled by name, label and type; the
+ * SystemStats aggregates follow. Only values that changed since the
+ * previous body are formatted; the rest are copied from the line
+ * cache, so a steady sensor costs one memcpy per series.
+ *
+ * @param exporter Exporter initialized with EXPORT_PROMETHEUS
+ * @param snapshot Readings to expose
+ * @param stats Aggregates of the same snapshot
+ * @param out Destination, at least exporter->capacity bytes
+ * @return Bytes written to out
+ */
+size_t export_metrics(Exporter *exporter, const SensorSnapshot *snapshot,
+                      const SystemStats *stats, char *out)
+{
+  Exporter *  ex    = exporter;
+  const char *start = out;
+  int         count = snapshot->count < ex->registry->count ? snapshot->count
+                                                           : ex->registry->count;
+
+  memcpy(out, ex->header, ex->header_size);
+  out += ex->header_size;
+
+  out = put_family(out, "temp_sensor_celsius", "gauge", "Temperature of the sensor.");
+  for (int i = 0; i < count; i++)
+    out = put_series(ex, i * EXPORT_SENSOR_SERIES, "temp_sensor_celsius", i,
+                     snapshot->temp_current[i], 1, out);
+
+  out = put_family(out, "temp_sensor_status", "gauge",
+                   "Sensor status: 0 ok, 1 warning, 2 critical, 3 read error.");
+  for (int i = 0; i < count; i++)
+    out = put_series(ex, i * EXPORT_SENSOR_SERIES + 1, "temp_sensor_status", i,
+                     snapshot->status[i] & 3, 0, out);
+
+  out = put_family(out, "temp_fan_rpm", "gauge", "Speed of the fan paired with the sensor.");
+  for (int i = 0; i < count; i++)
+  {
+    if (!ex->registry->sensors[i].has_fan)
+      continue;
+    out = put_series(ex, i * EXPORT_SENSOR_SERIES + 2, "temp_fan_rpm", i,
+                     snapshot->fan_rpm[i] >= 0 ? snapshot->fan_rpm[i] : -1, 0, out);
+  }
+
+  out = put_family(out, "temp_cpu_celsius", "gauge", "Average, lowest and highest CPU sensor.");
+  out = put_aggregate(ex, 0, "temp_cpu_celsius{stat=\"avg\"}", stats->avg_cpu_temp,
+                      stats->cpu_count, out);
+  out = put_aggregate(ex, 1, "temp_cpu_celsius{stat=\"min\"}", stats->min_cpu_temp,
+                      stats->cpu_count, out);
+  out = put_aggregate(ex, 2, "temp_cpu_celsius{stat=\"max\"}", stats->max_cpu_temp,
+                      stats->cpu_count, out);
+  out = put_family(out, "temp_gpu_celsius", "gauge", "Average and highest GPU sensor.");
+  out = put_aggregate(ex, 3, "temp_gpu_celsius{stat=\"avg\"}", stats->avg_gpu_temp,
+                      stats->gpu_count, out);
+  out = put_aggregate(ex, 4, "temp_gpu_celsius{stat=\"max\"}", stats->max_gpu_temp,
+                      stats->gpu_count, out);
+  out = put_family(out, "temp_nvme_celsius", "gauge", "Average NVMe sensor.");
+  out = put_aggregate(ex, 5, "temp_nvme_celsius{stat=\"avg\"}", stats->avg_nvme_temp,
+                      stats->nvme_count, out);
+  out = put_family(out, "temp_tail_celsius", "gauge",
+                   "Highest per-sensor 95th and 99th percentile since start or SIGUSR1.");
+  out = put_aggregate(ex, 6, "temp_tail_celsius{percentile=\"95\"}", stats->tail_p95,
+                      stats->tail_sensor >= 0, out);
+  out = put_aggregate(ex, 7, "temp_tail_celsius{percentile=\"99\"}", stats->tail_p99,
+                      stats->tail_sensor >= 0, out);
+
+  out = put_family(out, "temp_sensors_active", "gauge", "Sensors with a valid reading.");
+  out = put_count(ex, 8, "temp_sensors_active", stats->total_active_sensors, out);
+  out = put_family(out, "temp_sensors_warning", "gauge", "Sensors in warning state.");
+  out = put_count(ex, 9, "temp_sensors_warning", stats->warnings, out);
+  out = put_family(out, "temp_sensors_critical", "gauge", "Sensors in critical state.");
+  out = put_count(ex, 10, "temp_sensors_critical", stats->criticals, out);
+  out = put_family(out, "temp_fans_spinning", "gauge", "Paired fans reporting a speed.");
+  out = put_count(ex, 11, "temp_fans_spinning", stats->total_fans, out);
+
+  /* Change every tick, so never worth caching */
+  out    = put_family(out, "temp_samples_total", "counter", "Sample passes since start.");
+  out    = put_text(out, "temp_samples_total ");
+  out    = put_uint(out, snapshot->tick);
+  *out++ = '\n';
+
+  out = put_family(out, "temp_last_sample_timestamp_seconds", "gauge",
+                   "Wall-clock time of the exposed sample.");
+  out    = put_text(out, "temp_last_sample_timestamp_seconds ");
+  out    = put_int(out, snapshot->timestamp_ms / 1000);
+  *out++ = '.';
+  *out++ = (char) ('0' + snapshot->timestamp_ms / 100 % 10);
+  *out++ = (char) ('0' + snapshot->timestamp_ms / 10 % 10);
+  *out++ = (char) ('0' + snapshot->timestamp_ms % 10);
+  *out++ = '\n';
+
+  return (size_t) (out - start);
+}
+
+/**
+ * @brief Appends one StatsD gauge line: prefix, metric, value
+ */
+static char *put_gauge(const char *prefix, size_t prefix_size, const char *metric,
+                       long long value, int temp, char *out)
+{
+  memcpy(out, prefix, prefix_size);
+  out = put_text(out + prefix_size, metric);
+  out = temp ? put_temp(out, (int32_t) value) : put_int(out, value);
+  return put_text(out, "|g\n");
+}
+
+/**
+ * @brief Formats the StatsD or InfluxDB lines of one sensor
+ *
+ * StatsD gets one gauge per value (temp.NAME.LABEL.celsius, .status and
+ * .fan_rpm); a leading '-' would make a gauge relative, so a negative
+ * temperature is preceded by a reset to 0. InfluxDB gets one line with
+ * the critical threshold, the readings as fields and the sample time in
+ * nanoseconds. Each call appends at most EXPORT_SENSOR_MAX bytes plus
+ * four times the sensor's constant fields.
+ *
+ * @param exporter Exporter initialized with EXPORT_STATSD or EXPORT_INFLUX
+ * @param snapshot Readings to format
+ * @param i Sensor index, below both snapshot->count and the registry count
+ * @param out Destination
+ * @return Bytes written to out, each line ending in '\n'
+ */
+size_t export_lines(const Exporter *exporter, const SensorSnapshot *snapshot, int i, char *out)
+{
+  const Exporter *ex     = exporter;
+  const char *    start  = out;
+  const char *    prefix = ex->fields + (i > 0 ? ex->field_end[i - 1] : 0);
+  size_t          size   = ex->field_end[i] - (i > 0 ? ex->field_end[i - 1] : 0);
+  int32_t         temp   = snapshot->temp_current[i];
+  int             fan    = ex->registry->sensors[i].has_fan && snapshot->fan_rpm[i] >= 0;
+
+  if (ex->format == EXPORT_STATSD)
+  {
+    if (temp != TEMP_INVALID && temp < 0)
+      out = put_gauge(prefix, size, "celsius:", 0, 0, out);
+    if (temp != TEMP_INVALID)
+      out = put_gauge(prefix, size, "celsius:", temp, 1, out);
+    out = put_gauge(prefix, size, "status:", snapshot->status[i] & 3, 0, out);
+    if (fan)
+      out = put_gauge(prefix, size, "fan_rpm:", snapshot->fan_rpm[i], 0, out);
+  }
+  else
+  {
+    memcpy(out, prefix, size);
+    out += size;
+    if (temp != TEMP_INVALID)
+    {
+      out = put_text(out, ",celsius=");
+      out = put_temp(out, temp);
+    }
+    out    = put_text(out, ",status=");
+    *out++ = (char) ('0' + (snapshot->status[i] & 3));
+    *out++ = 'i';
+    if (fan)
+    {
+      out    = put_text(out, ",fan_rpm=");
+      out    = put_int(out, snapshot->fan_rpm[i]);
+      *out++ = 'i';
+    }
+    *out++ = ' ';
+    out    = put_int(out, snapshot->timestamp_ms);
+    out    = put_text(out, "000000\n");
+  }
+
+  return (size_t) (out - start);
+}
+
+/**
+ * @brief Releases an exporter's buffers
+ */
+void export_free(Exporter *exporter)
+{
+  free(exporter->fields);
+  free(exporter->field_end);
+  free(exporter->header);
+  free(exporter->buffer);
+  free(exporter->lines);
+  free(exporter->line_size);
+  free(exporter->line_value);
+  memset(exporter, 0, sizeof(*exporter));
+}
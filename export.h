@@ -0,0 +1,77 @@
+/**
+ * @file export.h
+ * @brief Temp Monitor - Machine-readable output of sensor snapshots
+ *
+ * --format jsonl|csv replaces the dashboard with one record per tick,
+ * or one per sensor per tick with --per-sensor, on stdout and without
+ * terminal control codes. Everything about a sensor that never changes
+ * (escaped name, label, type, critical threshold) is formatted once at
+ * start-up; a tick only formats numbers into a buffer sized up front
+ * and goes out with a single write(). The Prometheus exposition for
+ * --listen and --textfile is built the same way into a caller's
+ * buffer, and keeps the last line of every series so that a series
+ * whose value did not change is copied instead of formatted again.
+ * StatsD and InfluxDB lines for --statsd/--influx are formatted one
+ * sensor at a time, so the caller can cut datagrams between sensors.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "sensor.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Output format selected with --format
+ */
+typedef enum
+{
+  EXPORT_NONE = 0,   /* Interactive dashboard */
+  EXPORT_JSONL,      /* One JSON object per line */
+  EXPORT_CSV,        /* Comma-separated values with a header row */
+  EXPORT_PROMETHEUS, /* Prometheus text exposition, for --listen */
+  EXPORT_STATSD,     /* StatsD gauges, for --statsd */
+  EXPORT_INFLUX      /* InfluxDB line protocol, for --influx */
+} ExportFormat;
+
+/**
+ * @brief Formatter state for one sensor table
+ */
+typedef struct
+{
+  ExportFormat          format;     /* Any format but EXPORT_NONE */
+  int                   per_sensor; /* 1 for one record per sensor per tick */
+  const SensorRegistry *registry;   /* Sensor table, must outlive the exporter */
+  char *                fields;     /* Constant fields of every sensor, preformatted */
+  size_t *              field_end;  /* End of sensor i's fields, count entries */
+  char *                header;     /* CSV header row, or the constant start of a
+                                       Prometheus body; NULL for JSON Lines */
+  size_t                header_size;
+  int                   header_sent; /* 1 once the header row went out */
+  char *                buffer;      /* One tick of output */
+  size_t                capacity;    /* Bytes in buffer, enough for any tick */
+  char *                lines;       /* Prometheus: last sample line of every series */
+  size_t                line_stride; /* Bytes reserved per cached line */
+  uint32_t *            line_size;   /* Bytes of each cached line, 0 until formatted */
+  int32_t *             line_value;  /* Value each cached line was formatted from */
+} Exporter;
+
+ExportFormat export_parse_format(const char *name);
+int          export_init(Exporter *exporter, const SensorRegistry *registry, ExportFormat format,
+                         int per_sensor);
+int          export_write(Exporter *exporter, const SensorSnapshot *snapshot, int fd);
+size_t       export_metrics(Exporter *exporter, const SensorSnapshot *snapshot,
+                            const SystemStats *stats, char *out);
+size_t       export_lines(const Exporter *exporter, const SensorSnapshot *snapshot, int i,
+                          char *out);
+void         export_free(Exporter *exporter);
+
+#endif
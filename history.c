@@ -0,0 +1,622 @@
+/**
+ * @file history.c
+ * @brief Temp Monitor - Per-sensor temperature history
+ *
+ * Records one int16 centidegree sample per sensor per snapshot tick
+ * into fixed-capacity rings, and keeps each sensor's sparkline
+ * pre-rendered so drawing a frame is a copy of bytes. Every sample
+ * also feeds a cascade of rollup tiers, so long windows can be
+ * queried long after the raw samples have been overwritten.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "history.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Sparkline glyphs U+2581..U+2588, lowest to highest */
+static const char spark_glyphs[8][SPARK_CELL] = {
+    {'\xe2', '\x96', '\x81'}, {'\xe2', '\x96', '\x82'}, {'\xe2', '\x96', '\x83'},
+    {'\xe2', '\x96', '\x84'}, {'\xe2', '\x96', '\x85'}, {'\xe2', '\x96', '\x86'},
+    {'\xe2', '\x96', '\x87'}, {'\xe2', '\x96', '\x88'}};
+
+/* Blank cell (U+2800) for missing samples; same width as the glyphs */
+static const char spark_blank[SPARK_CELL] = {'\xe2', '\xa0', '\x80'};
+
+/* Rollup tiers as {raw ticks per bucket, buckets kept}. At 1 s per tick:
+ * 10 s for 1 hour, 1 min for 1 day and 10 min for 1 week. Each tier's
+ * bucket length is a multiple of the one below it. */
+static const int tier_layout[HISTORY_TIERS][2] = {{10, 360}, {60, 1440}, {600, 1008}};
+
+/**
+ * @brief Rounds millidegrees to int16 centidegrees
+ */
+static int16_t quantize(int32_t milli)
+{
+  int32_t centi = (milli >= 0 ? milli + 5 : milli - 5) / 10;
+
+  if (centi > INT16_MAX)
+    return INT16_MAX;
+  if (centi <= HISTORY_INVALID)
+    return HISTORY_INVALID + 1;
+  return (int16_t) centi;
+}
+
+/**
+ * @brief Bytes needed for a history of count sensors
+ *
+ * @param count Number of sensors
+ * @param capacity Samples per sensor
+ * @return Size of the arena in bytes
+ */
+size_t history_bytes(int count, int capacity)
+{
+  size_t n       = count > 0 ? (size_t) count : 0;
+  size_t buckets = 0;
+
+  for (int t = 0; t < HISTORY_TIERS; t++)
+    buckets += (size_t) tier_layout[t][1];
+
+  return n * buckets * sizeof(HistoryBucket) + n * HISTORY_TIERS * sizeof(HistoryAccumulator) +
+         n * (size_t) capacity * sizeof(int16_t) + n * 2 * sizeof(int16_t) +
+         n * SPARK_WIDTH * SPARK_CELL;
+}
+
+/**
+ * @brief Raw ticks covered by the coarsest rollup tier
+ */
+long history_max_span(void)
+{
+  return (long) tier_layout[HISTORY_TIERS - 1][0] * tier_layout[HISTORY_TIERS - 1][1];
+}
+
+/**
+ * @brief Allocates the history arena
+ *
+ * One allocation holds the rollup tiers, every raw ring, the
+ * sparkline scales and the pre-rendered sparkline cells. Capacity is
+ * raised to at least one sample more than a sparkline so the sample
+ * leaving the sparkline window is still available.
+ *
+ * @param history History to initialize
+ * @param count Number of sensors
+ * @param capacity Samples per sensor
+ * @return 1 on success, 0 if out of memory
+ */
+int history_init(TempHistory *history, int count, int capacity)
+{
+  size_t n;
+  char * block;
+
+  memset(history, 0, sizeof(*history));
+
+  if (count <= 0)
+    return 1;
+
+  if (capacity <= SPARK_WIDTH)
+    capacity = SPARK_WIDTH + 1;
+
+  n     = (size_t) count;
+  block = calloc(1, history_bytes(count, capacity));
+  if (!block)
+    return 0;
+
+  /* Widest members first keeps every array aligned */
+  for (int t = 0; t < HISTORY_TIERS; t++)
+  {
+    HistoryTier *tier = &history->tiers[t];
+
+    tier->ticks    = tier_layout[t][0];
+    tier->capacity = tier_layout[t][1];
+    tier->buckets  = (HistoryBucket *) block;
+    block += n * (size_t) tier->capacity * sizeof(HistoryBucket);
+  }
+  for (int t = 0; t < HISTORY_TIERS; t++)
+  {
+    history->tiers[t].open = (HistoryAccumulator *) block;
+    block += n * sizeof(HistoryAccumulator);
+  }
+
+  history->samples    = (int16_t *) block;
+  history->spark_lo   = history->samples + n * (size_t) capacity;
+  history->spark_hi   = history->spark_lo + n;
+  history->spark      = (char *) (history->spark_hi + n);
+  history->count      = count;
+  history->capacity   = capacity;
+  history->spark_head = SPARK_WIDTH - 1;
+
+  for (size_t s = 0; s < n; s++)
+  {
+    history->spark_lo[s] = INT16_MAX;
+    history->spark_hi[s] = INT16_MIN;
+  }
+
+  for (size_t c = 0; c < n * SPARK_WIDTH; c++)
+    memcpy(history->spark + c * SPARK_CELL, spark_blank, SPARK_CELL);
+
+  return 1;
+}
+
+/**
+ * @brief Reads a raw sample relative to a given newest slot
+ */
+static int16_t ring_at(const TempHistory *history, int sensor, int newest, int age, int length)
+{
+  if (age >= length)
+    return HISTORY_INVALID;
+
+  return history->samples[(size_t) sensor * history->capacity +
+                          (newest - age + history->capacity) % history->capacity];
+}
+
+/**
+ * @brief Writes the glyph for one sample into a sparkline cell
+ */
+static void render_cell(char *cell, int16_t value, int16_t lo, int16_t hi)
+{
+  int span, base, level;
+
+  if (value == HISTORY_INVALID)
+  {
+    memcpy(cell, spark_blank, SPARK_CELL);
+    return;
+  }
+
+  /* Narrow windows are centred in a minimum span instead of stretched */
+  span  = hi - lo < SPARK_MIN_SPAN ? SPARK_MIN_SPAN : hi - lo;
+  base  = lo - (span - (hi - lo)) / 2;
+  level = (value - base) * 7 / span;
+
+  if (level < 0)
+    level = 0;
+  if (level > 7)
+    level = 7;
+
+  memcpy(cell, spark_glyphs[level], SPARK_CELL);
+}
+
+/**
+ * @brief Updates one sensor's sparkline after a sample was written
+ *
+ * If the new sample leaves the window's range unchanged and the
+ * sample that just left the window was not its min or max, only the
+ * new cell is rendered. Otherwise the range is recomputed and the
+ * whole line re-rendered.
+ */
+static void update_sparkline(TempHistory *history, int sensor, int newest, int length)
+{
+  char *  cells   = history->spark + (size_t) sensor * SPARK_WIDTH * SPARK_CELL;
+  int     cell    = (history->spark_head + 1) % SPARK_WIDTH;
+  int16_t value   = ring_at(history, sensor, newest, 0, length);
+  int16_t evicted = ring_at(history, sensor, newest, SPARK_WIDTH, length);
+  int16_t lo      = history->spark_lo[sensor];
+  int16_t hi      = history->spark_hi[sensor];
+
+  if ((value != HISTORY_INVALID && (value < lo || value > hi)) ||
+      (evicted != HISTORY_INVALID && (evicted == lo || evicted == hi)))
+  {
+    lo = INT16_MAX;
+    hi = INT16_MIN;
+    for (int age = 0; age < SPARK_WIDTH; age++)
+    {
+      int16_t v = ring_at(history, sensor, newest, age, length);
+      if (v == HISTORY_INVALID)
+        continue;
+      if (v < lo)
+        lo = v;
+      if (v > hi)
+        hi = v;
+    }
+
+    history->spark_lo[sensor] = lo;
+    history->spark_hi[sensor] = hi;
+
+    for (int age = 0; age < SPARK_WIDTH; age++)
+    {
+      int c = (cell - age + SPARK_WIDTH) % SPARK_WIDTH;
+      render_cell(cells + c * SPARK_CELL, ring_at(history, sensor, newest, age, length), lo, hi);
+    }
+    return;
+  }
+
+  render_cell(cells + cell * SPARK_CELL, value, lo, hi);
+}
+
+/**
+ * @brief Appends one sample per sensor
+ *
+ * @param history History to append to
+ * @param snapshot Readings to store, or NULL to record a gap
+ */
+static void push_samples(TempHistory *history, const SensorSnapshot *snapshot)
+{
+  int newest = history->head;
+  int length = history->length < history->capacity ? history->length + 1 : history->capacity;
+
+  for (int s = 0; s < history->count; s++)
+  {
+    int16_t value = HISTORY_INVALID;
+
+    if (snapshot && s < snapshot->count && snapshot->active[s])
+      value = quantize(snapshot->temp_current[s]);
+
+    history->samples[(size_t) s * history->capacity + newest] = value;
+    update_sparkline(history, s, newest, length);
+  }
+
+  history->head       = (newest + 1) % history->capacity;
+  history->length     = length;
+  history->spark_head = (history->spark_head + 1) % SPARK_WIDTH;
+}
+
+/**
+ * @brief Merges samples into an accumulator
+ */
+static void accumulate(HistoryAccumulator *acc, int16_t min, int16_t max, int32_t sum,
+                       unsigned count)
+{
+  if (count == 0)
+    return;
+
+  if (acc->count == 0 || min < acc->min)
+    acc->min = min;
+  if (acc->count == 0 || max > acc->max)
+    acc->max = max;
+  acc->sum += sum;
+  acc->count += (uint16_t) count;
+}
+
+/**
+ * @brief Closes the open bucket of every sensor in one tier
+ *
+ * The closed bucket is appended to the tier's ring and its exact sum
+ * is carried into the next tier's open bucket.
+ */
+static void close_buckets(TempHistory *history, int t)
+{
+  HistoryTier *tier = &history->tiers[t];
+  HistoryTier *next = t + 1 < HISTORY_TIERS ? &history->tiers[t + 1] : NULL;
+
+  for (int s = 0; s < history->count; s++)
+  {
+    HistoryAccumulator *acc    = &tier->open[s];
+    HistoryBucket *     bucket = &tier->buckets[(size_t) s * tier->capacity + tier->head];
+
+    if (acc->count == 0)
+    {
+      bucket->min = bucket->max = bucket->mean = HISTORY_INVALID;
+      bucket->count                            = 0;
+    }
+    else
+    {
+      int32_t half = acc->count / 2;
+
+      bucket->min   = acc->min;
+      bucket->max   = acc->max;
+      bucket->mean  = (int16_t) ((acc->sum >= 0 ? acc->sum + half : acc->sum - half) / acc->count);
+      bucket->count = acc->count;
+    }
+
+    if (next)
+      accumulate(&next->open[s], acc->min, acc->max, acc->sum, acc->count);
+    memset(acc, 0, sizeof(*acc));
+  }
+
+  tier->head = (tier->head + 1) % tier->capacity;
+  if (tier->length < tier->capacity)
+    tier->length++;
+}
+
+/**
+ * @brief Feeds one tick into the rollup tiers
+ *
+ * @param history History to update
+ * @param snapshot Readings of the tick, or NULL for a gap
+ */
+static void roll_up(TempHistory *history, const SensorSnapshot *snapshot)
+{
+  if (snapshot)
+  {
+    for (int s = 0; s < history->count && s < snapshot->count; s++)
+    {
+      if (snapshot->active[s])
+      {
+        int16_t v = quantize(snapshot->temp_current[s]);
+        accumulate(&history->tiers[0].open[s], v, v, v, 1);
+      }
+    }
+  }
+
+  history->recorded++;
+
+  for (int t = 0; t < HISTORY_TIERS && history->recorded % history->tiers[t].ticks == 0; t++)
+    close_buckets(history, t);
+}
+
+/**
+ * @brief Records a snapshot into the history
+ *
+ * Each snapshot tick is recorded once; redraws of the same snapshot
+ * are ignored. Ticks the caller never saw (a slow frame) are recorded
+ * as gaps so the time axis stays uniform in the raw ring and in every
+ * tier.
+ *
+ * @param history History to append to
+ * @param snapshot Snapshot to record
+ */
+void history_record(TempHistory *history, const SensorSnapshot *snapshot)
+{
+  const HistoryTier *top    = &history->tiers[HISTORY_TIERS - 1];
+  unsigned long      missed = 0;
+
+  if (history->count == 0 || snapshot->tick == 0 || snapshot->tick <= history->tick)
+    return;
+
+  if (history->tick != 0)
+    missed = snapshot->tick - history->tick - 1;
+  if (missed > (unsigned long) top->ticks * (unsigned long) top->capacity)
+    missed = (unsigned long) top->ticks * (unsigned long) top->capacity;
+
+  for (unsigned long m = 0; m < missed; m++)
+  {
+    if (m < (unsigned long) history->capacity)
+      push_samples(history, NULL);
+    roll_up(history, NULL);
+  }
+
+  push_samples(history, snapshot);
+  roll_up(history, snapshot);
+  history->tick = snapshot->tick;
+}
+
+/**
+ * @brief Reads one stored sample
+ *
+ * @param history History to read
+ * @param sensor Sensor index
+ * @param age 0 for the newest sample, 1 for the one before, ...
+ * @return Temperature in millidegrees (centidegree precision), or
+ *         TEMP_INVALID for gaps and ages beyond the recorded length
+ */
+int32_t history_sample(const TempHistory *history, int sensor, int age)
+{
+  int16_t v;
+
+  if (sensor < 0 || sensor >= history->count || age < 0)
+    return TEMP_INVALID;
+
+  v = ring_at(history, sensor, (history->head - 1 + history->capacity) % history->capacity, age,
+              history->length);
+
+  return v == HISTORY_INVALID ? TEMP_INVALID : (int32_t) v * 10;
+}
+
+/**
+ * @brief Picks the finest level whose ring covers span raw ticks
+ *
+ * @return 0 for the raw ring, t + 1 for tier t
+ */
+static int level_for(const TempHistory *history, long span)
+{
+  if (span <= history->capacity)
+    return 0;
+
+  for (int t = 0; t < HISTORY_TIERS; t++)
+  {
+    if (span <= (long) history->tiers[t].ticks * history->tiers[t].capacity)
+      return t + 1;
+  }
+
+  return HISTORY_TIERS;
+}
+
+/**
+ * @brief Reads one bucket of a level as a bucket
+ *
+ * Raw samples read as one-sample buckets.
+ *
+ * @return 0 if age is beyond the recorded length of that level
+ */
+static int bucket_at(const TempHistory *history, int level, int sensor, int age,
+                     HistoryBucket *out)
+{
+  const HistoryTier *tier;
+
+  if (level == 0)
+  {
+    if (age >= history->length)
+      return 0;
+
+    out->min = out->max = out->mean = ring_at(
+        history, sensor, (history->head - 1 + history->capacity) % history->capacity, age,
+        history->length);
+    out->count = out->min != HISTORY_INVALID;
+    return 1;
+  }
+
+  tier = &history->tiers[level - 1];
+  if (age >= tier->length)
+    return 0;
+
+  *out = tier->buckets[(size_t) sensor * tier->capacity +
+                       (tier->head - 1 - age + 2 * tier->capacity) % tier->capacity];
+  return 1;
+}
+
+/**
+ * @brief Window accumulator wide enough for a week of samples
+ */
+typedef struct
+{
+  int16_t min, max;
+  int64_t sum;
+  long    count;
+} RangeSum;
+
+/**
+ * @brief Merges buckets into a window accumulator
+ */
+static void range_add(RangeSum *sum, int16_t min, int16_t max, int64_t total, long count)
+{
+  if (count == 0)
+    return;
+
+  if (sum->count == 0 || min < sum->min)
+    sum->min = min;
+  if (sum->count == 0 || max > sum->max)
+    sum->max = max;
+  sum->sum += total;
+  sum->count += count;
+}
+
+/**
+ * @brief Converts a window accumulator to millidegrees
+ */
+static void range_finish(const RangeSum *sum, HistoryRange *range)
+{
+  int64_t milli, half;
+
+  if (sum->count == 0)
+  {
+    range->min = range->max = range->mean = TEMP_INVALID;
+    return;
+  }
+
+  milli = sum->sum * 10;
+  half  = sum->count / 2;
+
+  range->min  = (int32_t) sum->min * 10;
+  range->max  = (int32_t) sum->max * 10;
+  range->mean = (int32_t) ((milli >= 0 ? milli + half : milli - half) / sum->count);
+}
+
+/**
+ * @brief Ticks per point at the level history_query() and
+ *        history_series() use for a window
+ *
+ * @param history History to query
+ * @param span Window length in raw ticks
+ * @return 1 for raw samples, otherwise the tier's bucket length
+ */
+long history_resolution(const TempHistory *history, long span)
+{
+  int level = level_for(history, span);
+
+  return level == 0 ? 1 : history->tiers[level - 1].ticks;
+}
+
+/**
+ * @brief Min/max/mean of one sensor over the newest span raw ticks
+ *
+ * Uses the finest level that still covers the window. Ticks not yet
+ * rolled into a closed bucket of that level are taken from the open
+ * buckets below it, so the window always ends at the newest sample.
+ *
+ * @param history History to query
+ * @param sensor Sensor index
+ * @param span Window length in raw ticks
+ * @param range Output; fields are TEMP_INVALID if the window is empty
+ * @return 1 if the window holds at least one valid sample, 0 otherwise
+ */
+int history_query(const TempHistory *history, int sensor, long span, HistoryRange *range)
+{
+  RangeSum      sum = {0, 0, 0, 0};
+  int           level;
+  long          ticks, partial = 0;
+  HistoryBucket b;
+
+  range->min = range->max = range->mean = TEMP_INVALID;
+  if (sensor < 0 || sensor >= history->count || span <= 0)
+    return 0;
+
+  level = level_for(history, span);
+  ticks = level == 0 ? 1 : history->tiers[level - 1].ticks;
+
+  if (level > 0)
+  {
+    partial = (long) (history->recorded % (unsigned long) ticks);
+    for (int t = 0; t < level; t++)
+    {
+      const HistoryAccumulator *acc = &history->tiers[t].open[sensor];
+      range_add(&sum, acc->min, acc->max, acc->sum, acc->count);
+    }
+  }
+
+  for (long age = 0; age * ticks < span - partial; age++)
+  {
+    if (!bucket_at(history, level, sensor, (int) age, &b))
+      break;
+    range_add(&sum, b.min, b.max, (int64_t) b.mean * b.count, b.count);
+  }
+
+  range_finish(&sum, range);
+  return sum.count > 0;
+}
+
+/**
+ * @brief Splits the newest span raw ticks of one sensor into points
+ *
+ * Each point aggregates an equal number of closed buckets from the
+ * finest level that covers the window, so the series may trail the
+ * newest sample by up to one bucket of that level.
+ *
+ * @param history History to query
+ * @param sensor Sensor index
+ * @param span Window length in raw ticks
+ * @param points Number of points; series[0] is the oldest
+ * @param series Output array of points entries; empty points hold
+ *               TEMP_INVALID
+ * @return Number of points that hold at least one valid sample
+ */
+int history_series(const TempHistory *history, int sensor, long span, int points,
+                   HistoryRange *series)
+{
+  int           level, filled = 0;
+  long          ticks, per;
+  HistoryBucket b;
+
+  if (points <= 0)
+    return 0;
+
+  for (int p = 0; p < points; p++)
+    series[p].min = series[p].max = series[p].mean = TEMP_INVALID;
+
+  if (sensor < 0 || sensor >= history->count || span <= 0)
+    return 0;
+
+  level = level_for(history, span);
+  ticks = level == 0 ? 1 : history->tiers[level - 1].ticks;
+  per   = (span + (long) points * ticks - 1) / ((long) points * ticks);
+
+  for (int p = 0; p < points; p++)
+  {
+    RangeSum sum = {0, 0, 0, 0};
+
+    for (long i = 0; i < per; i++)
+    {
+      if (!bucket_at(history, level, sensor, (int) (p * per + i), &b))
+        break;
+      range_add(&sum, b.min, b.max, (int64_t) b.mean * b.count, b.count);
+    }
+
+    range_finish(&sum, &series[points - 1 - p]);
+    filled += sum.count > 0;
+  }
+
+  return filled;
+}
+
+/**
+ * @brief Releases the history arena
+ */
+void history_free(TempHistory *history)
+{
+  free(history->tiers[0].buckets);
+  memset(history, 0, sizeof(*history));
+}
@@ -0,0 +1,127 @@
+/**
+ * @file history.h
+ * @brief Temp Monitor - Per-sensor temperature history
+ *
+ * Fixed-capacity ring per sensor, stored as int16 centidegrees in one
+ * contiguous arena, plus a pre-rendered sparkline per sensor that is
+ * updated one cell per sample. Older data is kept at lower resolution
+ * in rollup tiers (min/max/mean per bucket), so memory stays fixed no
+ * matter how long a session runs.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "sensor.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Default samples kept per sensor (10 minutes at 1 Hz) */
+#define HISTORY_DEFAULT_CAPACITY 600
+
+/* Stored in place of a failed or missed reading */
+#define HISTORY_INVALID INT16_MIN
+
+/* Sparkline length in cells, and bytes per cell (one 3-byte UTF-8 glyph) */
+#define SPARK_WIDTH 20
+#define SPARK_CELL 3
+
+/* Smallest span a sparkline scales to, centidegrees; keeps noise flat */
+#define SPARK_MIN_SPAN 200
+
+/* Number of rollup tiers above the raw ring; see history.c for sizes */
+#define HISTORY_TIERS 3
+
+/**
+ * @brief One rollup bucket of one sensor, centidegrees
+ */
+typedef struct
+{
+  int16_t  min;   /* Lowest sample, HISTORY_INVALID if count is 0 */
+  int16_t  max;   /* Highest sample */
+  int16_t  mean;  /* Mean of the samples */
+  uint16_t count; /* Valid raw samples in the bucket */
+} HistoryBucket;
+
+/**
+ * @brief Bucket being filled; sums stay exact across the cascade
+ */
+typedef struct
+{
+  int32_t  sum;   /* Sum of valid raw samples */
+  int16_t  min;   /* Lowest sample so far */
+  int16_t  max;   /* Highest sample so far */
+  uint16_t count; /* Valid raw samples so far */
+} HistoryAccumulator;
+
+/**
+ * @brief Ring of rollup buckets for every sensor
+ *
+ * Bucket ring s occupies buckets[s * capacity] onwards. When a bucket
+ * closes, its accumulator is also merged into the next tier's.
+ */
+typedef struct
+{
+  int                 ticks;    /* Raw ticks per bucket */
+  int                 capacity; /* Buckets kept per sensor */
+  int                 head;     /* Ring slot of the next bucket */
+  int                 length;   /* Closed buckets per ring, up to capacity */
+  HistoryBucket *     buckets;  /* count * capacity closed buckets */
+  HistoryAccumulator *open;     /* count buckets being filled */
+} HistoryTier;
+
+/**
+ * @brief Min/max/mean over a time window, millidegrees
+ */
+typedef struct
+{
+  int32_t min;  /* TEMP_INVALID if the window holds no valid sample */
+  int32_t max;  /* Highest sample */
+  int32_t mean; /* Mean weighted by sample count */
+} HistoryRange;
+
+/**
+ * @brief Temperature history of every sensor
+ *
+ * All sensors are recorded on the same ticks, so a single head and
+ * length serve every ring and every tier. Ring s occupies
+ * samples[s * capacity] onwards. Sparkline cells form a second,
+ * SPARK_WIDTH-long ring per sensor; a new sample re-renders the whole
+ * line only when the window's min or max changes.
+ */
+typedef struct
+{
+  int16_t *     samples;    /* count * capacity centidegrees */
+  char *        spark;      /* count * SPARK_WIDTH * SPARK_CELL glyph bytes */
+  int16_t *     spark_lo;   /* Lowest valid sample in each sparkline window */
+  int16_t *     spark_hi;   /* Highest valid sample in each sparkline window */
+  int           count;      /* Number of sensors */
+  int           capacity;   /* Samples per ring */
+  int           head;       /* Ring slot of the next sample */
+  int           length;     /* Valid samples per ring, up to capacity */
+  int           spark_head; /* Sparkline cell of the newest sample */
+  unsigned long tick;       /* Snapshot tick of the newest sample, 0 if none */
+  unsigned long recorded;   /* Raw ticks recorded, gaps included */
+
+  HistoryTier tiers[HISTORY_TIERS]; /* Rollups, finest first */
+} TempHistory;
+
+int     history_init(TempHistory *history, int count, int capacity);
+void    history_record(TempHistory *history, const SensorSnapshot *snapshot);
+int32_t history_sample(const TempHistory *history, int sensor, int age);
+int     history_query(const TempHistory *history, int sensor, long span, HistoryRange *range);
+int     history_series(const TempHistory *history, int sensor, long span, int points,
+                       HistoryRange *series);
+long    history_resolution(const TempHistory *history, long span);
+long    history_max_span(void);
+size_t  history_bytes(int count, int capacity);
+void    history_free(TempHistory *history);
+
+#endif
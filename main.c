@@ -23,14 +23,29 @@
  * copies or substantial portions of the Software.
  */
 
+#include "daemon.h"
 #include "display.h"
+#include "export.h"
+#include "history.h"
+#include "metrics.h"
+#include "push.h"
+#include "query.h"
+#include "record.h"
+#include "registry.h"
+#include "sampler.h"
+#include "scancache.h"
 #include "sensor.h"
+#include "shmpub.h"
+#include "textfile.h"
 #include "utils.h"
 
+#include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 /* Application version */
@@ -39,11 +54,59 @@
 /* Global flag for graceful shutdown on SIGINT (Ctrl+C) */
 volatile sig_atomic_t keep_running = 1;
 
-/* Array to store all detected temperature sensors */
-TempSensor sensors[MAX_SENSORS];
+/* All detected temperature sensors and fans, sized at scan time */
+SensorRegistry registry;
 
-/* Number of detected sensors */
-int sensor_count = 0;
+/* Readings of the most recent sample pass */
+SensorSnapshot snapshot;
+
+/* Per-sensor history for --graphs, one sample per refresh */
+TempHistory history;
+int         history_capacity = HISTORY_DEFAULT_CAPACITY;
+
+/* Binary recording for --record, one frame per refresh */
+Recorder    recorder       = {.fd = -1};
+const char *record_path    = NULL;
+int         record_size_mb = RECORD_DEFAULT_SIZE_MB;
+int         record_keep    = RECORD_DEFAULT_KEEP;
+int         record_packed  = 0;
+
+/* Set by --replay: drive the pipeline from a recording instead of sysfs */
+const char *replay_path  = NULL;
+double      replay_speed = 1.0; /* 0 for --max */
+
+/* Set by --format: machine-readable records on stdout instead of the dashboard */
+Exporter     exporter;
+ExportFormat export_format     = EXPORT_NONE;
+int          export_per_sensor = 0;
+
+/* Set by --listen: address of the Prometheus /metrics endpoint */
+const char *listen_address = NULL;
+
+/* Set by --textfile: node_exporter textfile collector output */
+Textfile    textfile       = {.dir_fd = -1};
+const char *textfile_dir   = NULL;
+int         textfile_every = 1;
+int         textfile_sync  = 0;
+
+/* Set by --statsd or --influx: UDP collector every sample is pushed to */
+const char * push_address = NULL;
+ExportFormat push_format  = EXPORT_NONE;
+int          push_mtu     = PUSH_DEFAULT_MTU;
+
+/* Set by --shm: shared memory segment every sample is published in */
+const char *shm_name = NULL;
+
+/* Set by --daemon or --connect: share one sampler over a Unix socket */
+char daemon_path[108] = ""; /* --socket, or daemon_socket_path() */
+int  daemon_mode      = 0;
+int  connect_mode     = 0;
+
+/* Set by --once: exit after the first sample */
+int run_once = 0;
+
+/* Set by --list: print the sensor table and exit instead of monitoring */
+int list_only = 0;
 
 /* Display configuration with default values */
 DisplayConfig config = {.use_celsius  = 1,
@@ -52,7 +115,9 @@ DisplayConfig config = {.use_celsius  = 1,
                         .show_fans    = 1,
                         .compact_mode = 0,
                         .color_mode   = 1,
-                        .refresh_rate = 2};
+                        .refresh_rate = 2,
+                        .interval_ms  = 0,
+                        .graph_span   = 0};
 
 /**
  * @brief Signal handler for SIGINT (Ctrl+C)
@@ -67,6 +132,21 @@ void sigint_handler(int sig)
   keep_running = 0;
 }
 
+/**
+ * @brief Signal handler for SIGUSR1
+ *
+ * Restarts the per-sensor statistics (min/max, mean, deviation and
+ * percentiles) from the next sample, e.g. `pkill -USR1 temp` before
+ * a load test.
+ *
+ * @param sig Signal number (unused)
+ */
+void sigusr1_handler(int sig)
+{
+  (void) sig;
+  sampler_reset_stats();
+}
+
 /**
  * @brief Prints the help message with usage information
  *
@@ -88,7 +168,9 @@ void print_help(const char *prog_name)
          "==========================================================\n" COLOR_RESET);
 
   printf("\n" COLOR_BOLD COLOR_GREEN "USAGE:\n" COLOR_RESET);
-  printf("  %s [OPTIONS] [REFRESH_RATE]\n\n", prog_name);
+  printf("  %s [OPTIONS] [REFRESH_RATE]\n", prog_name);
+  printf("  %s query FILE [--sensor GLOB] [--from T] [--to T] [--agg A] [--step T]\n\n",
+         prog_name);
 
   printf(COLOR_BOLD COLOR_GREEN "OPTIONS:\n" COLOR_RESET);
   printf("  " COLOR_YELLOW "-h, --help" COLOR_RESET "          Show this help message\n");
@@ -102,7 +184,70 @@ void print_help(const char *prog_name)
   printf("  " COLOR_YELLOW "-F, --fans" COLOR_RESET "          Show fan speed monitoring\n");
   printf("  " COLOR_YELLOW "-n, --no-fans" COLOR_RESET "       Disable fan speed monitoring\n");
   printf("  " COLOR_YELLOW "-g, --graphs" COLOR_RESET
-         "        Show temperature graphs (coming soon)\n");
+         "        Show sparklines and a graph of the hottest sensor\n");
+  printf("  " COLOR_YELLOW "    --history N" COLOR_RESET
+         "       Samples kept per sensor for --graphs (default %d)\n",
+         HISTORY_DEFAULT_CAPACITY);
+  printf("  " COLOR_YELLOW "    --graph-span T" COLOR_RESET
+         "    Graph time window, e.g. 10m, 6h or 7d (default: 60 samples)\n");
+  printf("  " COLOR_YELLOW "    --record FILE" COLOR_RESET
+         "   Record every sample to a binary log in FILE\n");
+  printf("  " COLOR_YELLOW "    --record-size MB" COLOR_RESET
+         " Rotate the log at this size (default %d)\n",
+         RECORD_DEFAULT_SIZE_MB);
+  printf("  " COLOR_YELLOW "    --record-keep N" COLOR_RESET
+         "  Rotated logs kept as FILE.1..FILE.N (default %d)\n",
+         RECORD_DEFAULT_KEEP);
+  printf("  " COLOR_YELLOW "    --record-compress" COLOR_RESET
+         " Compress the log in blocks of %d samples\n",
+         RECORD_BLOCK_FRAMES);
+  printf("  " COLOR_YELLOW "    --replay FILE" COLOR_RESET
+         "   Play back a --record log instead of reading sensors\n");
+  printf("  " COLOR_YELLOW "    --speed N" COLOR_RESET
+         "       Replay N times faster than recorded (default 1)\n");
+  printf("  " COLOR_YELLOW "    --max" COLOR_RESET
+         "           Replay without pauses and report per-frame timings\n");
+  printf("  " COLOR_YELLOW "    --format FMT" COLOR_RESET
+         "    Write jsonl or csv records to stdout instead of the dashboard\n");
+  printf("  " COLOR_YELLOW "    --per-sensor" COLOR_RESET
+         "    With --format, one record per sensor per sample\n");
+  printf("  " COLOR_YELLOW "    --interval T" COLOR_RESET
+         "    Sampling interval, e.g. 100ms or 5s (default: REFRESH_RATE)\n");
+  printf("  " COLOR_YELLOW "    --listen ADDR" COLOR_RESET
+         "   Serve Prometheus metrics on HOST:PORT at /metrics\n");
+  printf("  " COLOR_YELLOW "    --textfile DIR" COLOR_RESET
+         "  Write Prometheus metrics to DIR/" TEXTFILE_NAME " for node_exporter\n");
+  printf("  " COLOR_YELLOW "    --textfile-every N" COLOR_RESET
+         " Update the textfile every N samples (default 1)\n");
+  printf("  " COLOR_YELLOW "    --textfile-fsync" COLOR_RESET
+         " Sync each textfile update to disk before replacing the old one\n");
+  printf("  " COLOR_YELLOW "    --statsd ADDR" COLOR_RESET
+         "   Push every sample as StatsD gauges over UDP to HOST:PORT\n");
+  printf("  " COLOR_YELLOW "    --influx ADDR" COLOR_RESET
+         "   Push every sample as InfluxDB line protocol over UDP to HOST:PORT\n");
+  printf("  " COLOR_YELLOW "    --push-mtu BYTES" COLOR_RESET
+         " Largest UDP datagram for --statsd/--influx (default %d)\n",
+         PUSH_DEFAULT_MTU);
+  printf("  " COLOR_YELLOW "    --shm NAME" COLOR_RESET
+         "      Publish every sample in shared memory /dev/shm/NAME\n");
+  printf("  " COLOR_YELLOW "    --daemon" COLOR_RESET
+         "        Sample in the background and serve clients on a Unix socket\n");
+  printf("  " COLOR_YELLOW "    --connect" COLOR_RESET
+         "       Read samples from a running --daemon instead of sensors\n");
+  printf("  " COLOR_YELLOW "    --socket PATH" COLOR_RESET
+         "   Daemon socket (default: $XDG_RUNTIME_DIR/" DAEMON_SOCKET_NAME ")\n");
+  printf("  " COLOR_YELLOW "    --once" COLOR_RESET
+         "          Print the first sample and exit\n");
+  printf("  " COLOR_YELLOW "    --io-uring" COLOR_RESET
+         "      Sample all sensors in one io_uring batch per tick\n");
+  printf("  " COLOR_YELLOW "    --sysfs-root DIR" COLOR_RESET
+         " Read sensors from DIR instead of /sys (env: " SYSFS_ROOT_ENV ")\n");
+  printf("  " COLOR_YELLOW "    --scan-threads N" COLOR_RESET
+         " Threads used to scan hwmon chips (default: auto)\n");
+  printf("  " COLOR_YELLOW "    --no-cache" COLOR_RESET
+         "      Do not read or write the sensor scan cache\n");
+  printf("  " COLOR_YELLOW "    --rescan" COLOR_RESET
+         "        Ignore the scan cache and rebuild it\n");
 
   printf("\n" COLOR_BOLD COLOR_GREEN "ARGUMENTS:\n" COLOR_RESET);
   printf("  " COLOR_CYAN "REFRESH_RATE" COLOR_RESET
@@ -113,13 +258,23 @@ void print_help(const char *prog_name)
   printf("  %s 1                 # Update every 1 second\n", prog_name);
   printf("  %s -s 3              # Show stats, update every 3 seconds\n", prog_name);
   printf("  %s -f -s 5           # Fahrenheit + stats, 5 second refresh\n", prog_name);
-  printf("  %s --list            # List all sensors\n\n", prog_name);
+  printf("  %s --list            # List all sensors\n", prog_name);
+  printf("  %s --record soak.rec 1 # Record an overnight soak at 1 Hz\n", prog_name);
+  printf("  %s --replay soak.rec --speed 60 -g # Replay it, one minute per second\n",
+         prog_name);
+  printf("  %s query soak.rec --sensor 'Core*' --step 1m # Per-minute peaks\n", prog_name);
+  printf("  %s --format jsonl --interval 100ms # Stream 10 records/s to a log shipper\n",
+         prog_name);
+  printf("  %s --listen 127.0.0.1:9101 -c # Dashboard plus a Prometheus endpoint\n", prog_name);
+  printf("  %s --connect --once --format jsonl # One sample from the running daemon\n\n",
+         prog_name);
 
   printf(COLOR_BOLD COLOR_CYAN "KEYBOARD CONTROLS (during monitoring):\n" COLOR_RESET);
   printf("  " COLOR_RED "Ctrl+C" COLOR_RESET "              Exit the program\n");
   printf("  " COLOR_GREEN "F" COLOR_RESET " / " COLOR_GREEN "C" COLOR_RESET
          "               Toggle between Fahrenheit/Celsius\n");
   printf("  " COLOR_YELLOW "S" COLOR_RESET "                   Toggle statistics display\n");
+  printf("  " COLOR_MAGENTA "kill -USR1 <pid>" COLOR_RESET "    Reset min/max/mean/percentiles\n");
 
   printf("\n" COLOR_BOLD COLOR_GREEN "SUPPORTED SENSORS:\n" COLOR_RESET);
   printf("  CPU, GPU, NVMe, Chipset, Memory, VRM, Disk\n");
@@ -144,48 +299,451 @@ void print_version(void)
   printf("\n");
 }
 
+/**
+ * @brief Waits for the next snapshot or the refresh interval
+ *
+ * Waits in short slices so Ctrl+C is honoured promptly. Returns
+ * early when the sampler publishes a tick newer than last_tick; if
+ * a read stalls the sampler, the caller redraws the last snapshot
+ * once the refresh interval has elapsed.
+ *
+ * @param last_tick Tick of the snapshot already displayed
+ */
+static void wait_for_tick(unsigned long last_tick)
+{
+  long long deadline = get_time_ms() + config.interval_ms;
+
+  while (keep_running && get_time_ms() < deadline)
+  {
+    if (sampler_wait(last_tick, 200))
+      return;
+  }
+}
+
 /**
  * @brief Main monitoring loop
  *
  * Enters alternate screen buffer to prevent display artifacts,
- * then continuously updates and displays sensor data until
- * the user presses Ctrl+C. Uses alternate screen buffer technique
- * similar to vim/htop to keep terminal clean.
+ * then continuously displays the latest snapshot published by
+ * the sampler thread until the user presses Ctrl+C. Uses alternate
+ * screen buffer technique similar to vim/htop to keep terminal clean.
+ * With --format, each snapshot is written to stdout as records
+ * instead, until Ctrl+C or the reader closes the pipe. A --daemon
+ * draws nothing and only feeds its clients and the other outputs;
+ * with --connect the samples come from the daemon instead of sysfs.
+ *
+ * @return 1 if monitoring ran until stopped, 0 if it could not start
+ *         or lost the daemon
  */
-void run_monitoring(void)
+int run_monitoring(void)
 {
+  int           record_error = 0, output_error = 0, textfile_error = 0, push_error = 0;
+  int           connection_lost = 0, started = 0;
+  unsigned long textfile_due = 0, push_dropped = 0;
+  int           headless     = export_format != EXPORT_NONE || daemon_mode;
+  FILE *        report       = export_format != EXPORT_NONE ? stderr : stdout;
+
+  if (config.show_graphs && !history_init(&history, registry.count, history_capacity))
+  {
+    fprintf(report, COLOR_RED "Error: Not enough memory for %d history samples per sensor.\n"
+                            COLOR_RESET,
+            history_capacity);
+    goto fail;
+  }
+
+  if (export_format != EXPORT_NONE &&
+      !export_init(&exporter, &registry, export_format, export_per_sensor))
+  {
+    fprintf(report, COLOR_RED "Error: Not enough memory for %d sensors of output.\n" COLOR_RESET,
+            registry.count);
+    goto fail;
+  }
+
+  if (record_path && !record_open(&recorder, record_path, &registry, config.interval_ms,
+                                  (size_t) record_size_mb * 1024 * 1024, record_keep,
+                                  record_packed ? RECORD_ENCODING_PACKED : RECORD_ENCODING_RAW))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot record to %s: %s\n" COLOR_RESET, record_path,
+            strerror(errno));
+    goto fail;
+  }
+
+  if (textfile_dir && !textfile_open(&textfile, textfile_dir, &registry, textfile_sync))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot write metrics to %s: %s\n" COLOR_RESET, textfile_dir,
+            strerror(errno));
+    goto fail;
+  }
+
+  if (push_address && !push_start(push_address, push_format, push_mtu, &registry))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot push to %s: %s\n" COLOR_RESET, push_address,
+            strerror(errno));
+    goto fail;
+  }
+
+  if (shm_name && !shmpub_open(shm_name, &registry, config.interval_ms))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot publish to shared memory %s: %s\n" COLOR_RESET,
+            shm_name, strerror(errno));
+    goto fail;
+  }
+
+  if (!snapshot_init(&snapshot, registry.count) ||
+      !(connect_mode ? sampler_start_source(daemon_receive, registry.count)
+                     : sampler_start(registry.sensors, registry.count, config.interval_ms)))
+  {
+    fprintf(report, COLOR_RED "Error: Failed to start sampler thread.\n" COLOR_RESET);
+    goto fail;
+  }
+
+  if (listen_address && !metrics_start(listen_address, &registry))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot listen on %s: %s\n" COLOR_RESET, listen_address,
+            strerror(errno));
+    goto fail;
+  }
+
+  if (daemon_mode && !daemon_start(daemon_path, &registry, config.interval_ms))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot serve on %s: %s\n" COLOR_RESET, daemon_path,
+            strerror(errno));
+    goto fail;
+  }
+
+  if (daemon_mode)
+  {
+    fprintf(report, "Serving %d sensors every %dms on %s\n", registry.count, config.interval_ms,
+            daemon_path);
+  }
+
+  started = 1;
+
   /* Switch to alternate screen buffer for clean display */
-  enter_alternate_screen();
-  hide_cursor();
+  if (!headless && !run_once)
+  {
+    enter_alternate_screen();
+    hide_cursor();
+  }
 
   while (keep_running)
   {
-    clear_screen();
-    print_header(VERSION);
+    wait_for_tick(snapshot.tick);
+    if (!keep_running)
+      break;
+
+    /* The last sample stays readable after the daemon went away */
+    if (connect_mode && sampler_finished() && sampler_tick() == snapshot.tick)
+    {
+      connection_lost = 1;
+      break;
+    }
+
+    /* Never blocks: copies whatever the sampler published last */
+    if (!sampler_read(&snapshot))
+      continue;
+
+    /* First, for readers that act on the temperature within microseconds */
+    shmpub_write(&snapshot);
+
+    history_record(&history, &snapshot);
+
+    if (record_path && !record_write(&recorder, &snapshot))
+    {
+      record_error = errno;
+      record_path  = NULL;
+    }
+
+    /* Due by tick, so a slow pass does not stretch the update period */
+    if (textfile_dir && snapshot.tick >= textfile_due)
+    {
+      if (!textfile_write(&textfile, &snapshot))
+      {
+        textfile_error = errno;
+        textfile_dir   = NULL;
+      }
+      textfile_due = snapshot.tick + (unsigned long) textfile_every;
+    }
+
+    /* A lost push is not fatal: UDP collectors come and go */
+    if (push_address && !push_write(&snapshot))
+    {
+      push_error = errno;
+      push_dropped++;
+    }
+
+    if (export_format != EXPORT_NONE)
+    {
+      if (!export_write(&exporter, &snapshot, STDOUT_FILENO))
+      {
+        output_error = errno;
+        break;
+      }
+    }
+
+    if (headless)
+    {
+      if (run_once)
+        break;
+      continue;
+    }
+
+    if (!run_once)
+      clear_screen();
+    print_header(VERSION, &config);
 
-    display_all_sensors(sensors, sensor_count, &config);
+    display_all_sensors(&registry, &snapshot, &history, &config);
 
     if (config.show_stats)
     {
       SystemStats stats;
-      calculate_system_stats(sensors, sensor_count, &stats);
+      calculate_system_stats(&registry, &snapshot, &stats);
       display_statistics(&stats, &config);
     }
 
+    if (run_once)
+      break;
+
     print_footer(&config);
+  }
+
+  if (!headless && !run_once)
+  {
+    show_cursor();
+    exit_alternate_screen();
+  }
+
+fail:
+  /* Reverse order of setup; each step is a no-op for what never started */
+  daemon_stop();
+  metrics_stop();
+  sampler_stop();
+  daemon_disconnect();
+  snapshot_free(&snapshot);
+  shmpub_close();
+  push_stop();
+  textfile_close(&textfile);
+  record_close(&recorder);
+  export_free(&exporter);
+  history_free(&history);
+
+  if (!started)
+    return 0;
+
+  if (record_error)
+  {
+    fprintf(report, COLOR_RED "Error: Recording stopped: %s\n" COLOR_RESET,
+            strerror(record_error));
+  }
+
+  if (textfile_error)
+  {
+    fprintf(report, COLOR_RED "Error: Textfile updates stopped: %s\n" COLOR_RESET,
+            strerror(textfile_error));
+  }
+
+  if (push_dropped)
+  {
+    fprintf(report, COLOR_RED "Error: %lu samples not fully pushed to %s: %s\n" COLOR_RESET,
+            push_dropped, push_address, strerror(push_error));
+  }
+
+  if (connection_lost)
+  {
+    fprintf(report, COLOR_RED "Error: Connection to the daemon on %s lost.\n" COLOR_RESET,
+            daemon_path);
+  }
 
-    sleep(config.refresh_rate);
+  /* A closed pipe is the reader being done, e.g. `| head` */
+  if (output_error && output_error != EPIPE)
+  {
+    fprintf(stderr, COLOR_RED "Error: Output stopped: %s\n" COLOR_RESET, strerror(output_error));
   }
 
-  show_cursor();
-  exit_alternate_screen();
+  return !connection_lost;
+}
+
+/**
+ * @brief Sleeps until get_time_us() reaches deadline, honouring Ctrl+C
+ */
+static void replay_wait(long long deadline)
+{
+  while (keep_running)
+  {
+    long long       left = deadline - get_time_us();
+    struct timespec ts;
+
+    if (left <= 0)
+      return;
+    if (left > 200000)
+      left = 200000;
+
+    ts.tv_sec  = 0;
+    ts.tv_nsec = left * 1000L;
+    nanosleep(&ts, NULL);
+  }
+}
+
+/**
+ * @brief Replay loop for --replay
+ *
+ * Feeds every recorded frame through the same history, statistics
+ * and render code as run_monitoring(), with replay_sensors() in place
+ * of the sampler. Frames are paced by their recorded timestamps
+ * divided by --speed; pauses longer than two intervals (the monitor
+ * was stopped) are cut short. With --max there are no pauses and the
+ * run ends with the time spent per frame in each stage. With --format
+ * the frames are written as records, e.g. to convert a recording to CSV.
+ *
+ * @return 1 if the recording was played, 0 if it could not be opened
+ */
+int run_replay(void)
+{
+  RecordReader reader;
+  RecordSample sample;
+  long long    interval_ms, previous_ms = 0, played_ms = 0, started, t0, t1;
+  long long    update_us = 0, render_us = 0;
+  int          output_error = 0;
+  FILE *       report       = export_format != EXPORT_NONE ? stderr : stdout;
+
+  if (!record_reader_open(&reader, replay_path, &registry))
+  {
+    fprintf(report, COLOR_RED "Error: Cannot replay %s: %s\n" COLOR_RESET, replay_path,
+            errno ? strerror(errno) : "not a recording, or from a different version");
+    record_reader_close(&reader);
+    return 0;
+  }
+
+  interval_ms         = reader.header.interval_ms > 0 ? reader.header.interval_ms : 1000;
+  config.refresh_rate = interval_ms >= 1000 ? (int) (interval_ms / 1000) : 1;
+  config.interval_ms  = (int) interval_ms;
+  config.replay_speed = replay_speed;
+
+  if (config.show_graphs && !history_init(&history, registry.count, history_capacity))
+  {
+    fprintf(report, COLOR_RED "Error: Not enough memory for %d history samples per sensor.\n"
+                            COLOR_RESET,
+            history_capacity);
+    record_reader_close(&reader);
+    return 0;
+  }
+
+  if (!snapshot_init(&snapshot, registry.count) || !snapshot_enable_histograms(&snapshot))
+  {
+    fprintf(report, COLOR_RED "Error: Not enough memory to replay %d sensors.\n" COLOR_RESET,
+            registry.count);
+    snapshot_free(&snapshot);
+    history_free(&history);
+    record_reader_close(&reader);
+    return 0;
+  }
+
+  if (export_format != EXPORT_NONE &&
+      !export_init(&exporter, &registry, export_format, export_per_sensor))
+  {
+    fprintf(report, COLOR_RED "Error: Not enough memory for %d sensors of output.\n" COLOR_RESET,
+            registry.count);
+    export_free(&exporter);
+    snapshot_free(&snapshot);
+    history_free(&history);
+    record_reader_close(&reader);
+    return 0;
+  }
+
+  if (export_format == EXPORT_NONE)
+  {
+    enter_alternate_screen();
+    hide_cursor();
+  }
+
+  started = get_time_us();
+  while (keep_running && record_reader_next(&reader, &sample))
+  {
+    /* Due times follow the recording itself, so render time does not add up */
+    if (replay_speed > 0 && previous_ms != 0)
+    {
+      long long gap = sample.timestamp_ms - previous_ms;
+      played_ms += gap < 0 ? 0 : gap > 2 * interval_ms ? 2 * interval_ms : gap;
+      replay_wait(started + (long long) (played_ms * 1000 / replay_speed));
+    }
+    previous_ms = sample.timestamp_ms;
+
+    t0 = get_time_us();
+    replay_sensors(registry.sensors, registry.count, sample.temps, sample.fans,
+                   (unsigned long) sample.tick, sample.timestamp_ms, &snapshot);
+    history_record(&history, &snapshot);
+
+    SystemStats stats;
+    if (config.show_stats)
+      calculate_system_stats(&registry, &snapshot, &stats);
+    t1 = get_time_us();
+
+    config.replay_ms = sample.timestamp_ms;
+    if (export_format != EXPORT_NONE)
+    {
+      if (!export_write(&exporter, &snapshot, STDOUT_FILENO))
+      {
+        output_error = errno;
+        break;
+      }
+    }
+    else
+    {
+      clear_screen();
+      print_header(VERSION, &config);
+      display_all_sensors(&registry, &snapshot, &history, &config);
+      if (config.show_stats)
+        display_statistics(&stats, &config);
+      print_footer(&config);
+      fflush(stdout);
+    }
+
+    update_us += t1 - t0;
+    render_us += get_time_us() - t1;
+  }
+
+  if (export_format == EXPORT_NONE)
+  {
+    show_cursor();
+    exit_alternate_screen();
+  }
+
+  /* With --format, stdout carries only records */
+  fprintf(report, COLOR_BRIGHT_CYAN "[~] Replayed %lu samples of %d sensors from %s\n" COLOR_RESET,
+          reader.frames, registry.count, replay_path);
+  if (reader.damaged)
+  {
+    fprintf(report, COLOR_YELLOW "    Skipped %lu damaged or incomplete %s\n" COLOR_RESET,
+            reader.damaged,
+            reader.header.encoding == RECORD_ENCODING_PACKED ? "blocks" : "frames");
+  }
+  if (replay_speed == 0 && reader.frames > 0)
+  {
+    double per_frame = 1.0 / reader.frames;
+
+    fprintf(report,
+            COLOR_BRIGHT_BLACK "    %.0f samples/s; per sample: update %.1f us, render %.1f us\n"
+                               COLOR_RESET,
+            reader.frames * 1e6 / (double) (get_time_us() - started), update_us * per_frame,
+            render_us * per_frame);
+  }
+  if (output_error && output_error != EPIPE)
+  {
+    fprintf(stderr, COLOR_RED "Error: Output stopped: %s\n" COLOR_RESET, strerror(output_error));
+  }
+
+  export_free(&exporter);
+  snapshot_free(&snapshot);
+  history_free(&history);
+  record_reader_close(&reader);
+  return 1;
 }
 
 /**
  * @brief Initializes and scans for temperature sensors
  *
  * Scans the hwmon and thermal subsystems for available temperature
- * sensors and populates the global sensors array.
+ * sensors and populates the global sensor registry.
  *
  * @return 1 if sensors were found, 0 otherwise
  */
@@ -194,9 +752,7 @@ int initialize_sensors(void)
   printf(COLOR_BRIGHT_YELLOW "[*] Initializing temperature monitoring system...\n" COLOR_RESET);
   printf(COLOR_CYAN "[~] Scanning for hardware sensors...\n" COLOR_RESET);
 
-  sensor_count = scan_temperature_sensors(sensors);
-
-  if (sensor_count == 0)
+  if (scan_temperature_sensors(&registry) == 0)
   {
     printf("\n");
     printf(COLOR_RED COLOR_BOLD "[X] ERROR: No temperature sensors detected!\n" COLOR_RESET);
@@ -232,12 +788,12 @@ int initialize_sensors(void)
   }
 
   printf(COLOR_GREEN "[+] Successfully detected %d temperature sensor%s!\n" COLOR_RESET,
-         sensor_count, sensor_count != 1 ? "s" : "");
+         registry.count, registry.count != 1 ? "s" : "");
 
   int cpu_sensors = 0, gpu_sensors = 0, nvme_sensors = 0, other_sensors = 0;
-  for (int i = 0; i < sensor_count; i++)
+  for (int i = 0; i < registry.count; i++)
   {
-    switch (sensors[i].type)
+    switch (registry.sensors[i].type)
     {
       case SENSOR_CPU:
         cpu_sensors++;
@@ -293,10 +849,35 @@ void parse_arguments(int argc, char *argv[])
     }
     else if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--list") == 0)
     {
-      if (!initialize_sensors())
+      list_only = 1;
+    }
+    else if (strcmp(argv[i], "--sysfs-root") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        printf(COLOR_RED "Error: --sysfs-root requires a directory.\n" COLOR_RESET);
         exit(1);
-      display_sensor_list(sensors, sensor_count);
-      exit(0);
+      }
+      set_sysfs_root(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--scan-threads") == 0)
+    {
+      int threads = i + 1 < argc ? parse_int(argv[i + 1], -1) : -1;
+      if (threads < 0)
+      {
+        printf(COLOR_RED "Error: --scan-threads requires a number (0 = auto).\n" COLOR_RESET);
+        exit(1);
+      }
+      set_scan_threads(threads);
+      i++;
+    }
+    else if (strcmp(argv[i], "--no-cache") == 0)
+    {
+      scan_cache_set_enabled(0);
+    }
+    else if (strcmp(argv[i], "--rescan") == 0)
+    {
+      scan_cache_set_rescan(1);
     }
     else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--compact") == 0)
     {
@@ -310,10 +891,211 @@ void parse_arguments(int argc, char *argv[])
     {
       config.show_fans = 0;
     }
+    else if (strcmp(argv[i], "--io-uring") == 0)
+    {
+      if (set_sampler_backend(SAMPLER_IO_URING) != SAMPLER_IO_URING)
+      {
+        printf(COLOR_YELLOW "Note: io_uring unavailable, using plain reads.\n" COLOR_RESET);
+      }
+    }
     else if (strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "--graphs") == 0)
     {
       config.show_graphs = 1;
-      printf(COLOR_YELLOW "Note: Graph feature is coming soon!\n" COLOR_RESET);
+    }
+    else if (strcmp(argv[i], "--history") == 0)
+    {
+      int samples = i + 1 < argc ? parse_int(argv[i + 1], -1) : -1;
+      if (samples < 1)
+      {
+        printf(COLOR_RED "Error: --history requires a positive sample count.\n" COLOR_RESET);
+        exit(1);
+      }
+      history_capacity = samples;
+      i++;
+    }
+    else if (strcmp(argv[i], "--record") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        printf(COLOR_RED "Error: --record requires a file name.\n" COLOR_RESET);
+        exit(1);
+      }
+      record_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--record-size") == 0)
+    {
+      int mb = i + 1 < argc ? parse_int(argv[i + 1], -1) : -1;
+      if (mb < 1)
+      {
+        printf(COLOR_RED "Error: --record-size requires a positive size in MB.\n" COLOR_RESET);
+        exit(1);
+      }
+      record_size_mb = mb;
+      i++;
+    }
+    else if (strcmp(argv[i], "--record-keep") == 0)
+    {
+      int keep = i + 1 < argc ? parse_int(argv[i + 1], -1) : -1;
+      if (keep < 0)
+      {
+        printf(COLOR_RED "Error: --record-keep requires a count of 0 or more.\n" COLOR_RESET);
+        exit(1);
+      }
+      record_keep = keep;
+      i++;
+    }
+    else if (strcmp(argv[i], "--record-compress") == 0)
+    {
+      record_packed = 1;
+    }
+    else if (strcmp(argv[i], "--replay") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        printf(COLOR_RED "Error: --replay requires a recording made with --record.\n" COLOR_RESET);
+        exit(1);
+      }
+      replay_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--speed") == 0)
+    {
+      double speed = i + 1 < argc ? parse_double(argv[i + 1], -1) : -1;
+      if (speed <= 0 || speed > 1000000)
+      {
+        printf(COLOR_RED "Error: --speed requires a factor such as 0.5, 10 or 3600.\n" COLOR_RESET);
+        exit(1);
+      }
+      replay_speed = speed;
+      i++;
+    }
+    else if (strcmp(argv[i], "--max") == 0)
+    {
+      replay_speed = 0;
+    }
+    else if (strcmp(argv[i], "--format") == 0)
+    {
+      export_format = i + 1 < argc ? export_parse_format(argv[i + 1]) : EXPORT_NONE;
+      if (export_format == EXPORT_NONE)
+      {
+        printf(COLOR_RED "Error: --format requires jsonl or csv.\n" COLOR_RESET);
+        exit(1);
+      }
+      i++;
+    }
+    else if (strcmp(argv[i], "--listen") == 0)
+    {
+      if (i + 1 >= argc || !strchr(argv[i + 1], ':'))
+      {
+        printf(COLOR_RED "Error: --listen requires HOST:PORT, e.g. 127.0.0.1:9101.\n" COLOR_RESET);
+        exit(1);
+      }
+      listen_address = argv[++i];
+    }
+    else if (strcmp(argv[i], "--shm") == 0)
+    {
+      if (i + 1 >= argc || strchr(argv[i + 1] + (argv[i + 1][0] == '/'), '/'))
+      {
+        printf(COLOR_RED "Error: --shm requires a name without '/', e.g. temp-monitor.\n"
+                         COLOR_RESET);
+        exit(1);
+      }
+      shm_name = argv[++i];
+    }
+    else if (strcmp(argv[i], "--daemon") == 0)
+    {
+      daemon_mode = 1;
+    }
+    else if (strcmp(argv[i], "--connect") == 0)
+    {
+      connect_mode = 1;
+    }
+    else if (strcmp(argv[i], "--socket") == 0)
+    {
+      if (i + 1 >= argc || strlen(argv[i + 1]) >= sizeof(daemon_path))
+      {
+        printf(COLOR_RED "Error: --socket requires a path of at most %zu bytes.\n" COLOR_RESET,
+               sizeof(daemon_path) - 1);
+        exit(1);
+      }
+      snprintf(daemon_path, sizeof(daemon_path), "%s", argv[++i]);
+    }
+    else if (strcmp(argv[i], "--once") == 0)
+    {
+      run_once = 1;
+    }
+    else if (strcmp(argv[i], "--textfile") == 0)
+    {
+      if (i + 1 >= argc)
+      {
+        printf(COLOR_RED "Error: --textfile requires a directory.\n" COLOR_RESET);
+        exit(1);
+      }
+      textfile_dir = argv[++i];
+    }
+    else if (strcmp(argv[i], "--textfile-every") == 0)
+    {
+      int every = i + 1 < argc ? parse_int(argv[i + 1], 0) : 0;
+      if (every < 1)
+      {
+        printf(COLOR_RED "Error: --textfile-every requires a count of 1 or more.\n" COLOR_RESET);
+        exit(1);
+      }
+      textfile_every = every;
+      i++;
+    }
+    else if (strcmp(argv[i], "--textfile-fsync") == 0)
+    {
+      textfile_sync = 1;
+    }
+    else if (strcmp(argv[i], "--statsd") == 0 || strcmp(argv[i], "--influx") == 0)
+    {
+      if (i + 1 >= argc || !strchr(argv[i + 1], ':'))
+      {
+        printf(COLOR_RED "Error: %s requires HOST:PORT, e.g. 127.0.0.1:8125.\n" COLOR_RESET,
+               argv[i]);
+        exit(1);
+      }
+      push_format  = strcmp(argv[i], "--statsd") == 0 ? EXPORT_STATSD : EXPORT_INFLUX;
+      push_address = argv[++i];
+    }
+    else if (strcmp(argv[i], "--push-mtu") == 0)
+    {
+      int mtu = i + 1 < argc ? parse_int(argv[i + 1], 0) : 0;
+      if (mtu < PUSH_MIN_MTU || mtu > PUSH_MAX_MTU)
+      {
+        printf(COLOR_RED "Error: --push-mtu requires %d to %d bytes.\n" COLOR_RESET, PUSH_MIN_MTU,
+               PUSH_MAX_MTU);
+        exit(1);
+      }
+      push_mtu = mtu;
+      i++;
+    }
+    else if (strcmp(argv[i], "--per-sensor") == 0)
+    {
+      export_per_sensor = 1;
+    }
+    else if (strcmp(argv[i], "--interval") == 0)
+    {
+      long interval = i + 1 < argc ? parse_duration_ms(argv[i + 1], -1) : -1;
+      if (interval < 10 || interval > 60000)
+      {
+        printf(COLOR_RED "Error: --interval requires 10ms to 60s, e.g. 100ms or 5s.\n" COLOR_RESET);
+        exit(1);
+      }
+      config.interval_ms = (int) interval;
+      i++;
+    }
+    else if (strcmp(argv[i], "--graph-span") == 0)
+    {
+      long span = i + 1 < argc ? parse_duration(argv[i + 1], -1) : -1;
+      if (span < 1 || span > INT_MAX)
+      {
+        printf(COLOR_RED "Error: --graph-span requires a duration such as 90s, 10m, 6h or 7d.\n"
+                         COLOR_RESET);
+        exit(1);
+      }
+      config.graph_span = (int) span;
+      i++;
     }
     else
     {
@@ -348,29 +1130,173 @@ void parse_arguments(int argc, char *argv[])
  */
 int main(int argc, char *argv[])
 {
+  /* `temp query FILE ...` reads a recording and exits */
+  if (argc > 1 && strcmp(argv[1], "query") == 0)
+    return query_main(argc - 1, argv + 1);
+
   /* Setup signal handler for Ctrl+C */
   signal(SIGINT, sigint_handler);
+  signal(SIGTERM, sigint_handler);
+
+  /* sigaction keeps the handler installed across repeated resets */
+  struct sigaction reset_action = {.sa_handler = sigusr1_handler, .sa_flags = SA_RESTART};
+  sigemptyset(&reset_action.sa_mask);
+  sigaction(SIGUSR1, &reset_action, NULL);
+
+  /* One descriptor per sensor attribute adds up on large machines */
+  raise_fd_limit();
+
+  /* Environment first so that --sysfs-root can override it */
+  set_sysfs_root(getenv(SYSFS_ROOT_ENV));
 
   /* Parse command-line arguments */
   parse_arguments(argc, argv);
+  if (config.interval_ms == 0)
+    config.interval_ms = config.refresh_rate * 1000;
+
+  if (daemon_mode && (connect_mode || replay_path || run_once))
+  {
+    printf(COLOR_RED "Error: --daemon cannot be combined with --connect, --replay or --once.\n"
+                     COLOR_RESET);
+    return 1;
+  }
+  if (connect_mode && replay_path)
+  {
+    printf(COLOR_RED "Error: --connect cannot be combined with --replay.\n" COLOR_RESET);
+    return 1;
+  }
+  if ((daemon_mode || connect_mode) && daemon_path[0] == '\0' &&
+      !daemon_socket_path(daemon_path, sizeof(daemon_path)))
+  {
+    printf(COLOR_RED "Error: Cannot use the daemon socket directory: %s\n" COLOR_RESET,
+           strerror(errno));
+    return 1;
+  }
+
+  /* Records go to a pipe; a reader that quits ends the run cleanly */
+  if (export_format != EXPORT_NONE)
+    signal(SIGPIPE, SIG_IGN);
+
+  if (replay_path)
+  {
+    int played = run_replay();
+    registry_free(&registry);
+    return played ? 0 : 1;
+  }
+
+  /* The daemon's sensor table replaces the scan; its interval, ours */
+  if (connect_mode)
+  {
+    FILE *report = export_format != EXPORT_NONE ? stderr : stdout;
+
+    if (!daemon_connect(daemon_path, run_once ? DAEMON_SNAPSHOT : DAEMON_SUBSCRIBE, &registry,
+                        &config.interval_ms))
+    {
+      fprintf(report, COLOR_RED "Error: Cannot connect to the daemon on %s: %s\n" COLOR_RESET,
+              daemon_path, errno ? strerror(errno) : "unsupported protocol version");
+      daemon_disconnect();
+      registry_free(&registry);
+      return 1;
+    }
+    config.refresh_rate = config.interval_ms >= 1000 ? config.interval_ms / 1000 : 1;
+  }
 
-  if (!initialize_sensors())
+  /* Machine-readable output, a daemon or --once: no banner on stdout */
+  if ((export_format != EXPORT_NONE || daemon_mode || run_once) && !list_only)
+  {
+    if (!connect_mode && scan_temperature_sensors(&registry) == 0)
+    {
+      fprintf(stderr, COLOR_RED "Error: No temperature sensors detected.\n" COLOR_RESET);
+      return 1;
+    }
+    int ran = run_monitoring();
+    daemon_disconnect();
+    registry_free(&registry);
+    set_sampler_backend(SAMPLER_READ);
+    return ran ? 0 : 1;
+  }
+
+  if (!connect_mode && !initialize_sensors())
   {
     return 1;
   }
 
+  if (list_only)
+  {
+    display_sensor_list(registry.sensors, registry.count);
+    /* Fan labels and live speeds are not part of the daemon's table */
+    if (!connect_mode)
+      display_fan_list(registry.sensors, registry.fans, registry.fan_count);
+    daemon_disconnect();
+    registry_free(&registry);
+    return 0;
+  }
+
   sleep(1);
 
   printf(COLOR_BRIGHT_CYAN "[~] Starting real-time monitoring" COLOR_RESET);
-  printf(COLOR_BRIGHT_BLACK " (refresh rate: %ds)...\n" COLOR_RESET, config.refresh_rate);
+  if (config.interval_ms % 1000 != 0)
+    printf(COLOR_BRIGHT_BLACK " (refresh rate: %dms)...\n" COLOR_RESET, config.interval_ms);
+  else
+    printf(COLOR_BRIGHT_BLACK " (refresh rate: %ds)...\n" COLOR_RESET, config.interval_ms / 1000);
+  if (config.show_graphs)
+  {
+    char reach[16];
+
+    format_duration(history_max_span() * config.interval_ms / 1000, reach, sizeof(reach));
+    printf(COLOR_BRIGHT_BLACK "    History: %d samples + rollups up to %s x %d sensors (%.1f MB)\n"
+                              COLOR_RESET,
+           history_capacity, reach, registry.count,
+           history_bytes(registry.count, history_capacity) / (1024.0 * 1024.0));
+  }
+  if (record_path && record_packed)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Recording: %s (compressed in %d-sample blocks, rotating at %d"
+                              " MB)\n" COLOR_RESET,
+           record_path, RECORD_BLOCK_FRAMES, record_size_mb);
+  }
+  else if (record_path)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Recording: %s (%zu bytes per sample, rotating at %d MB)\n"
+                              COLOR_RESET,
+           record_path, record_frame_size(registry.count), record_size_mb);
+  }
+  if (shm_name)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Shared memory: /dev/shm/%s (%d sensors)\n" COLOR_RESET,
+           shm_name + (shm_name[0] == '/'), registry.count);
+  }
+  if (connect_mode)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Daemon: %s (%d sensors)\n" COLOR_RESET, daemon_path,
+           registry.count);
+  }
+  if (listen_address)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Metrics: http://%s/metrics\n" COLOR_RESET, listen_address);
+  }
+  if (textfile_dir)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Textfile: %s/" TEXTFILE_NAME " (every %d samples)\n" COLOR_RESET,
+           textfile_dir, textfile_every);
+  }
+  if (push_address)
+  {
+    printf(COLOR_BRIGHT_BLACK "    Push: %s to udp://%s (datagrams up to %d bytes)\n" COLOR_RESET,
+           push_format == EXPORT_STATSD ? "StatsD" : "InfluxDB", push_address, push_mtu);
+  }
   sleep(1);
 
-  run_monitoring();
+  int ran = run_monitoring();
+
+  daemon_disconnect();
+  registry_free(&registry);
+  set_sampler_backend(SAMPLER_READ);
 
   printf("\n");
   printf(COLOR_BRIGHT_WHITE "Monitoring stopped.\n" COLOR_RESET);
   printf(COLOR_BRIGHT_BLACK "Temp Monitor v%s\n" COLOR_RESET, VERSION);
   printf("\n");
 
-  return 0;
+  return ran ? 0 : 1;
 }
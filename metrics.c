@@ -0,0 +1,617 @@
+/**
+ * @file metrics.c
+ * @brief Temp Monitor - Prometheus/OpenMetrics HTTP endpoint implementation
+ *
+ * One thread runs an epoll loop over the listening socket, an eventfd
+ * used to stop it and every client connection. Requests are parsed
+ * from a per-connection buffer; responses go out with sendmsg() of
+ * the response head plus a shared body, resuming on EPOLLOUT when the
+ * socket is full. Connections are kept alive for HTTP/1.1.
+ *
+ * The thread reads snapshots from the sampler like any other consumer.
+ * Bodies are reference counted: a rebuild never touches a body that a
+ * slow client is still receiving, and spare bodies are reused.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#define _GNU_SOURCE
+
+#include "metrics.h"
+
+#include "export.h"
+#include "registry.h"
+#include "sampler.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ * @brief One formatted exposition, shared by the connections sending it
+ */
+typedef struct MetricsBody
+{
+  struct MetricsBody *next;  /* Next spare body */
+  unsigned long       tick;  /* Sampler tick it was built from */
+  int                 users; /* Connections still sending it */
+  size_t              size;  /* Bytes in data */
+  char                data[];
+} MetricsBody;
+
+/**
+ * @brief State of one client connection
+ */
+typedef struct Connection
+{
+  struct Connection *next;      /* Next open connection */
+  int                fd;        /* Client socket */
+  long long          active_ms; /* Time of the last read or write */
+  size_t             received;  /* Bytes in request */
+  char               request[METRICS_REQUEST_MAX];
+
+  /* Response being sent: head, then body_data */
+  char         head[192];
+  size_t       head_size;
+  const char * body_data;
+  size_t       body_size;
+  MetricsBody *body; /* Reference held while body_data points into it */
+  size_t       sent; /* Bytes of head + body already sent */
+  int          close_after;
+  int          eof; /* Client shut down its side */
+} Connection;
+
+/* Server state, owned by the event-loop thread while it runs */
+static struct
+{
+  pthread_t             thread;
+  int                   running;
+  int                   listen_fd;
+  int                   epoll_fd;
+  int                   wake_fd;
+  const SensorRegistry *registry;
+
+  Exporter       exporter;
+  SensorSnapshot snapshot;
+  MetricsBody *  current; /* Latest body, NULL until the first scrape */
+  MetricsBody *  spare;   /* Bodies no connection uses */
+
+  Connection *connections;
+  int         connection_count;
+} server = {.listen_fd = -1, .epoll_fd = -1, .wake_fd = -1};
+
+static const char index_page[] = "Temp Monitor exporter: see /metrics\n";
+
+/**
+ * @brief Binds and listens on HOST:PORT, [HOST]:PORT or :PORT
+ *
+ * An empty host listens on all interfaces.
+ *
+ * @return Listening socket, or -1 with errno set
+ */
+static int open_listener(const char *address)
+{
+  struct addrinfo hints = {0}, *list, *ai;
+  char            host[256];
+  const char *    port;
+  int             fd = -1, one = 1;
+
+  if (!split_host_port(address, host, sizeof(host), &port))
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags    = AI_PASSIVE | AI_NUMERICSERV;
+  if (getaddrinfo(host[0] ? host : NULL, port, &hints, &list) != 0)
+  {
+    errno = EADDRNOTAVAIL;
+    return -1;
+  }
+
+  for (ai = list; ai; ai = ai->ai_next)
+  {
+    fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd < 0)
+      continue;
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 128) == 0)
+      break;
+
+    int saved = errno;
+    close(fd);
+    fd    = -1;
+    errno = saved;
+  }
+
+  freeaddrinfo(list);
+  return fd;
+}
+
+/**
+ * @brief Drops a connection's reference to its body
+ */
+static void release_body(Connection *conn)
+{
+  MetricsBody *body = conn->body;
+
+  conn->body = NULL;
+  if (body && --body->users == 0 && body != server.current)
+  {
+    body->next   = server.spare;
+    server.spare = body;
+  }
+}
+
+/**
+ * @brief Returns the body for the latest tick, formatting it if needed
+ *
+ * @return Body, or NULL if nothing was sampled yet or out of memory
+ */
+static MetricsBody *latest_body(void)
+{
+  MetricsBody *body = server.current;
+  SystemStats  stats;
+
+  if (body && body->tick == sampler_tick())
+    return body;
+
+  if (!sampler_read(&server.snapshot))
+    return body;
+
+  body = server.spare;
+  if (body)
+    server.spare = body->next;
+  else
+  {
+    body = malloc(sizeof(MetricsBody) + server.exporter.capacity);
+    if (!body)
+      return server.current;
+    body->users = 0;
+  }
+
+  calculate_system_stats(server.registry, &server.snapshot, &stats);
+  body->tick = server.snapshot.tick;
+  body->size = export_metrics(&server.exporter, &server.snapshot, &stats, body->data);
+
+  /* The previous body stays with the connections still sending it */
+  if (server.current && server.current->users == 0)
+  {
+    server.current->next = server.spare;
+    server.spare         = server.current;
+  }
+  server.current = body;
+  return body;
+}
+
+/**
+ * @brief Prepares the response to a complete request head
+ */
+static void prepare_response(Connection *conn, const char *request)
+{
+  const char * status = "200 OK";
+  const char * type   = "text/plain; version=0.0.4; charset=utf-8";
+  char         method[8] = "", path[256] = "", version[16] = "";
+  int          head_only;
+  MetricsBody *body = NULL;
+
+  sscanf(request, "%7s %255s %15s", method, path, version);
+  head_only = strcmp(method, "HEAD") == 0;
+
+  /* HTTP/1.1 keeps the connection unless asked not to; 1.0 closes it */
+  conn->close_after = conn->eof || strcmp(version, "HTTP/1.1") != 0 ||
+                      strcasestr(request, "\nConnection: close") != NULL;
+  conn->body_data   = NULL;
+  conn->body_size   = 0;
+
+  if (strcmp(method, "GET") != 0 && !head_only)
+  {
+    status            = "405 Method Not Allowed";
+    conn->close_after = 1;
+  }
+  else if (strcmp(path, "/metrics") == 0 || strncmp(path, "/metrics?", 9) == 0)
+  {
+    body = latest_body();
+    if (!body)
+      status = "503 Service Unavailable";
+  }
+  else if (strcmp(path, "/") == 0)
+  {
+    conn->body_data = index_page;
+    conn->body_size = sizeof(index_page) - 1;
+  }
+  else
+    status = "404 Not Found";
+
+  if (body)
+  {
+    body->users++;
+    conn->body      = body;
+    conn->body_data = body->data;
+    conn->body_size = body->size;
+  }
+
+  conn->head_size = (size_t) snprintf(conn->head, sizeof(conn->head),
+                                      "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                                      "%s\r\n",
+                                      status, type, conn->body_size,
+                                      conn->close_after ? "Connection: close\r\n" : "");
+  if (head_only)
+  {
+    release_body(conn);
+    conn->body_data = NULL;
+    conn->body_size = 0;
+  }
+  conn->sent = 0;
+}
+
+static void close_connection(Connection *conn)
+{
+  Connection **link = &server.connections;
+
+  while (*link != conn)
+    link = &(*link)->next;
+  *link = conn->next;
+
+  release_body(conn);
+  close(conn->fd);
+  free(conn);
+  server.connection_count--;
+}
+
+/**
+ * @brief Sends as much of the pending response as the socket takes
+ *
+ * @return 1 if the connection stays open, 0 if it was closed
+ */
+static int send_response(Connection *conn)
+{
+  size_t total = conn->head_size + conn->body_size;
+
+  while (conn->sent < total)
+  {
+    struct iovec  iov[2];
+    struct msghdr msg = {0};
+    int           n   = 0;
+    ssize_t       written;
+
+    if (conn->sent < conn->head_size)
+    {
+      iov[n].iov_base = conn->head + conn->sent;
+      iov[n].iov_len  = conn->head_size - conn->sent;
+      n++;
+    }
+    if (conn->body_size > 0)
+    {
+      size_t offset   = conn->sent > conn->head_size ? conn->sent - conn->head_size : 0;
+      iov[n].iov_base = (void *) (conn->body_data + offset);
+      iov[n].iov_len  = conn->body_size - offset;
+      n++;
+    }
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = (size_t) n;
+
+    written = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      struct epoll_event ev = {.events = EPOLLOUT, .data.ptr = conn};
+      epoll_ctl(server.epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+      return 1;
+    }
+    if (written <= 0)
+    {
+      close_connection(conn);
+      return 0;
+    }
+    conn->sent += (size_t) written;
+    conn->active_ms = get_time_ms();
+  }
+
+  release_body(conn);
+  conn->head_size = 0;
+  conn->body_size = 0;
+  conn->sent      = 0;
+
+  if (conn->close_after)
+  {
+    close_connection(conn);
+    return 0;
+  }
+
+  struct epoll_event ev = {.events = EPOLLIN, .data.ptr = conn};
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+  return 1;
+}
+
+/**
+ * @brief Answers every complete request in the buffer, in order
+ *
+ * @return 1 if the connection stays open, 0 if it was closed
+ */
+static int serve_requests(Connection *conn)
+{
+  char *end;
+
+  while (conn->head_size == 0 && (end = memmem(conn->request, conn->received, "\r\n\r\n", 4)))
+  {
+    size_t used = (size_t) (end + 4 - conn->request);
+
+    end[2] = '\0';
+    prepare_response(conn, conn->request);
+
+    memmove(conn->request, conn->request + used, conn->received - used);
+    conn->received -= used;
+
+    if (!send_response(conn))
+      return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Reads request bytes from a readable connection
+ */
+static void handle_readable(Connection *conn)
+{
+  for (;;)
+  {
+    ssize_t n;
+
+    /* One byte stays free for the terminator prepare_response() relies on */
+    if (conn->received >= sizeof(conn->request) - 1)
+    {
+      close_connection(conn);
+      return;
+    }
+
+    n = recv(conn->fd, conn->request + conn->received, sizeof(conn->request) - 1 - conn->received,
+             0);
+    if (n > 0)
+    {
+      conn->received += (size_t) n;
+      conn->request[conn->received] = '\0';
+      conn->active_ms                = get_time_ms();
+      continue;
+    }
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    if (n < 0)
+    {
+      close_connection(conn);
+      return;
+    }
+
+    /* Orderly shutdown: answer what was sent, then close */
+    conn->eof = 1;
+    break;
+  }
+
+  if (serve_requests(conn) && conn->eof && conn->head_size == 0)
+    close_connection(conn);
+}
+
+/**
+ * @brief Accepts every pending connection
+ */
+static void accept_connections(void)
+{
+  for (;;)
+  {
+    int                fd = accept4(server.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    Connection *       conn;
+    struct epoll_event ev = {.events = EPOLLIN};
+
+    if (fd < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+
+    if (server.connection_count >= METRICS_MAX_CONNECTIONS || !(conn = calloc(1, sizeof(*conn))))
+    {
+      close(fd);
+      continue;
+    }
+
+    conn->fd        = fd;
+    conn->active_ms = get_time_ms();
+    ev.data.ptr     = conn;
+    if (epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+      close(fd);
+      free(conn);
+      continue;
+    }
+
+    conn->next         = server.connections;
+    server.connections = conn;
+    server.connection_count++;
+  }
+}
+
+/**
+ * @brief Closes connections idle for METRICS_IDLE_MS
+ */
+static void expire_connections(void)
+{
+  long long   now  = get_time_ms();
+  Connection *conn = server.connections;
+
+  while (conn)
+  {
+    Connection *next = conn->next;
+    if (now - conn->active_ms > METRICS_IDLE_MS)
+      close_connection(conn);
+    conn = next;
+  }
+}
+
+/**
+ * @brief Event-loop thread body
+ */
+static void *metrics_main(void *arg)
+{
+  struct epoll_event events[64];
+  long long          expired = get_time_ms();
+
+  (void) arg;
+
+  for (;;)
+  {
+    int n = epoll_wait(server.epoll_fd, events, 64, 1000);
+
+    for (int i = 0; i < n; i++)
+    {
+      void *ptr = events[i].data.ptr;
+
+      if (ptr == &server.wake_fd)
+        return NULL;
+      if (ptr == &server.listen_fd)
+      {
+        accept_connections();
+        continue;
+      }
+
+      Connection *conn = ptr;
+      if (events[i].events & (EPOLLERR | EPOLLHUP))
+        close_connection(conn);
+      else if (events[i].events & EPOLLOUT)
+      {
+        if (send_response(conn))
+          serve_requests(conn);
+      }
+      else
+        handle_readable(conn);
+    }
+
+    if (get_time_ms() - expired >= 1000)
+    {
+      expire_connections();
+      expired = get_time_ms();
+    }
+  }
+}
+
+/**
+ * @brief Frees everything metrics_start() set up
+ */
+static void release_server(void)
+{
+  while (server.connections)
+    close_connection(server.connections);
+
+  while (server.spare)
+  {
+    MetricsBody *next = server.spare->next;
+    free(server.spare);
+    server.spare = next;
+  }
+  free(server.current);
+  server.current = NULL;
+
+  if (server.listen_fd >= 0)
+    close(server.listen_fd);
+  if (server.epoll_fd >= 0)
+    close(server.epoll_fd);
+  if (server.wake_fd >= 0)
+    close(server.wake_fd);
+  server.listen_fd = server.epoll_fd = server.wake_fd = -1;
+
+  export_free(&server.exporter);
+  snapshot_free(&server.snapshot);
+}
+
+/**
+ * @brief Starts serving /metrics on address
+ *
+ * Must be called after sampler_start(); the endpoint reads the
+ * sampler's snapshots and the registry's metadata only.
+ *
+ * @param address HOST:PORT, [HOST]:PORT or :PORT (all interfaces)
+ * @param registry Sensor table being sampled
+ * @return 1 on success, 0 on failure (errno set)
+ */
+int metrics_start(const char *address, const SensorRegistry *registry)
+{
+  struct epoll_event ev = {.events = EPOLLIN};
+  int                saved;
+
+  if (server.running)
+    return 1;
+
+  server.registry = registry;
+  if (!export_init(&server.exporter, registry, EXPORT_PROMETHEUS, 0) ||
+      !snapshot_init(&server.snapshot, registry->count))
+  {
+    release_server();
+    errno = ENOMEM;
+    return 0;
+  }
+
+  server.listen_fd = open_listener(address);
+  server.epoll_fd  = epoll_create1(EPOLL_CLOEXEC);
+  server.wake_fd   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (server.listen_fd < 0 || server.epoll_fd < 0 || server.wake_fd < 0)
+  {
+    saved = errno;
+    release_server();
+    errno = saved;
+    return 0;
+  }
+
+  ev.data.ptr = &server.listen_fd;
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &ev);
+  ev.data.ptr = &server.wake_fd;
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.wake_fd, &ev);
+
+  if (pthread_create(&server.thread, NULL, metrics_main, NULL) != 0)
+  {
+    release_server();
+    errno = EAGAIN;
+    return 0;
+  }
+
+  server.running = 1;
+  return 1;
+}
+
+/**
+ * @brief Stops the endpoint and closes every connection
+ */
+void metrics_stop(void)
+{
+  uint64_t one = 1;
+
+  if (!server.running)
+    return;
+
+  if (write(server.wake_fd, &one, sizeof(one)) < 0)
+    pthread_cancel(server.thread);
+  pthread_join(server.thread, NULL);
+
+  release_server();
+  server.running = 0;
+}
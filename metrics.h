@@ -0,0 +1,35 @@
+/**
+ * @file metrics.h
+ * @brief Temp Monitor - Prometheus/OpenMetrics HTTP endpoint
+ *
+ * --listen HOST:PORT serves GET /metrics from one event-loop thread
+ * (epoll, non-blocking sockets, no thread per connection). The body is
+ * formatted at most once per sampler tick, on the first scrape that
+ * sees a new tick, and every scrape of that tick sends the same
+ * buffer, so many scrapers cost little more than one.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "sensor.h"
+
+/* Open connections served at once; later ones are closed on accept */
+#define METRICS_MAX_CONNECTIONS 256
+
+/* Largest request head accepted, in bytes */
+#define METRICS_REQUEST_MAX 8192
+
+/* Connections idle this long are closed */
+#define METRICS_IDLE_MS 30000
+
+int  metrics_start(const char *address, const SensorRegistry *registry);
+void metrics_stop(void);
+
+#endif
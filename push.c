@@ -0,0 +1,195 @@
+/**
+ * @file push.c
+ * @brief Temp Monitor - StatsD and InfluxDB UDP push implementation
+ *
+ * A tick is formatted sensor by sensor into one buffer sized at
+ * start-up. Datagrams are cut between sensors as soon as the next
+ * sensor would push the current one past the MTU, so they are slices
+ * of that buffer and nothing is copied; a sensor longer than the MTU
+ * on its own gets a datagram of its own. The socket is connected, so
+ * the messages carry no address, and sends never block: a full socket
+ * buffer or an unreachable collector costs the rest of that tick, not
+ * a stall of the monitoring loop.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#define _GNU_SOURCE
+
+#include "push.h"
+
+#include "registry.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* Push state, owned by the monitoring loop */
+static struct
+{
+  int             fd;       /* Connected UDP socket */
+  size_t          mtu;      /* Largest datagram payload */
+  Exporter        exporter; /* StatsD or InfluxDB formatter; its buffer holds a tick */
+  struct mmsghdr *messages; /* One per datagram, up to one per sensor */
+  struct iovec *  iov;      /* Slice of the buffer sent by each message */
+} pusher = {.fd = -1};
+
+/**
+ * @brief Opens a UDP socket connected to HOST:PORT
+ *
+ * @return Socket, or -1 on failure (errno is set)
+ */
+static int open_sender(const char *address)
+{
+  struct addrinfo hints = {0}, *list, *ai;
+  char            host[256];
+  const char *    port;
+  int             fd = -1;
+
+  if (!split_host_port(address, host, sizeof(host), &port) || host[0] == '\0')
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags    = AI_NUMERICSERV;
+  if (getaddrinfo(host, port, &hints, &list) != 0)
+  {
+    errno = EADDRNOTAVAIL;
+    return -1;
+  }
+
+  for (ai = list; ai; ai = ai->ai_next)
+  {
+    fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd < 0)
+      continue;
+
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+      break;
+
+    int saved = errno;
+    close(fd);
+    fd    = -1;
+    errno = saved;
+  }
+
+  freeaddrinfo(list);
+  return fd;
+}
+
+/**
+ * @brief Starts pushing to a StatsD or InfluxDB UDP listener
+ *
+ * @param address Collector as HOST:PORT or [HOST]:PORT
+ * @param format EXPORT_STATSD or EXPORT_INFLUX
+ * @param mtu Largest datagram payload, PUSH_MIN_MTU to PUSH_MAX_MTU
+ * @param registry Sensor table; must stay valid until push_stop()
+ * @return 1 on success, 0 on failure (errno is set)
+ */
+int push_start(const char *address, ExportFormat format, int mtu, const SensorRegistry *registry)
+{
+  size_t slots = registry->count > 0 ? (size_t) registry->count : 1;
+
+  pusher.mtu      = (size_t) mtu;
+  pusher.messages = calloc(slots, sizeof(*pusher.messages));
+  pusher.iov      = calloc(slots, sizeof(*pusher.iov));
+  if (!export_init(&pusher.exporter, registry, format, 0) || !pusher.messages || !pusher.iov)
+  {
+    push_stop();
+    errno = ENOMEM;
+    return 0;
+  }
+
+  for (size_t k = 0; k < slots; k++)
+  {
+    pusher.messages[k].msg_hdr.msg_iov    = &pusher.iov[k];
+    pusher.messages[k].msg_hdr.msg_iovlen = 1;
+  }
+
+  pusher.fd = open_sender(address);
+  if (pusher.fd < 0)
+  {
+    int saved = errno;
+    push_stop();
+    errno = saved;
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Formats one snapshot and sends it as MTU-sized datagrams
+ *
+ * @param snapshot Readings to push
+ * @return 1 if every datagram was handed to the kernel, 0 if some of
+ *         the tick was dropped (errno is set); pushing can go on either way
+ */
+int push_write(const SensorSnapshot *snapshot)
+{
+  const Exporter *ex     = &pusher.exporter;
+  int             count  = snapshot->count < ex->registry->count ? snapshot->count
+                                                                  : ex->registry->count;
+  char *          packet = ex->buffer;
+  char *          out    = ex->buffer;
+  int             n      = 0, sent = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    char *lines = out;
+
+    out += export_lines(ex, snapshot, i, out);
+    if (lines > packet && (size_t) (out - packet) > pusher.mtu)
+    {
+      pusher.iov[n].iov_base = packet;
+      pusher.iov[n].iov_len  = (size_t) (lines - packet);
+      n++;
+      packet = lines;
+    }
+  }
+  if (out > packet)
+  {
+    pusher.iov[n].iov_base = packet;
+    pusher.iov[n].iov_len  = (size_t) (out - packet);
+    n++;
+  }
+
+  /* The kernel takes at most UIO_MAXIOV messages per call */
+  while (sent < n)
+  {
+    int r = sendmmsg(pusher.fd, pusher.messages + sent, (unsigned int) (n - sent), MSG_DONTWAIT);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0)
+      return 0;
+    sent += r;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Closes the socket and frees the formatter
+ */
+void push_stop(void)
+{
+  if (pusher.fd >= 0)
+    close(pusher.fd);
+  export_free(&pusher.exporter);
+  free(pusher.messages);
+  free(pusher.iov);
+  memset(&pusher, 0, sizeof(pusher));
+  pusher.fd = -1;
+}
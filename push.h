@@ -0,0 +1,37 @@
+/**
+ * @file push.h
+ * @brief Temp Monitor - StatsD and InfluxDB UDP push
+ *
+ * --statsd HOST:PORT and --influx HOST:PORT send every sample as StatsD
+ * gauges or InfluxDB line protocol over UDP, for hosts whose metrics
+ * pipeline is push-based. Lines are packed into datagrams of at most
+ * --push-mtu bytes, never splitting a sensor across two, and a tick
+ * goes out with as few sendmmsg() calls as the kernel allows (one for
+ * up to 1024 datagrams), not one send per sensor.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef PUSH_H
+#define PUSH_H
+
+#include "export.h"
+#include "sensor.h"
+
+/* Default datagram payload: fits a 1500-byte Ethernet MTU with headroom
+   for IP options and tunnels, the usual StatsD recommendation */
+#define PUSH_DEFAULT_MTU 1432
+
+/* Accepted --push-mtu range; the upper bound is the largest IPv4 UDP payload */
+#define PUSH_MIN_MTU 512
+#define PUSH_MAX_MTU 65507
+
+int  push_start(const char *address, ExportFormat format, int mtu, const SensorRegistry *registry);
+int  push_write(const SensorSnapshot *snapshot);
+void push_stop(void);
+
+#endif
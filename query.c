@@ -0,0 +1,581 @@
+/**
+ * @file query.c
+ * @brief Temp Monitor - Range queries over recordings
+ *
+ * Walks the index of a recording in time order. Entries outside the
+ * range are skipped without reading them; for min/max, an entry that
+ * falls entirely inside one output step is folded in from its stored
+ * ranges. Everything else is decoded frame by frame from the entry's
+ * offset, up to the next entry.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "query.h"
+
+#include "display.h"
+#include "record.h"
+#include "registry.h"
+#include "stats.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Aggregates understood by --agg
+ */
+typedef enum
+{
+  AGG_MIN = 0,
+  AGG_MAX,
+  AGG_MEAN,
+  AGG_P99,
+  AGG_COUNT
+} Aggregate;
+
+static const char *aggregate_names[AGG_COUNT] = {"min", "max", "mean", "p99"};
+
+/**
+ * @brief Running aggregate of one sensor over the current step
+ */
+typedef struct
+{
+  int32_t  min;
+  int32_t  max;
+  int64_t  sum;
+  uint32_t n; /* Valid samples folded in */
+} QueryCell;
+
+/**
+ * @brief State of one query
+ */
+typedef struct
+{
+  SensorRegistry registry;   /* Sensor table of the recording */
+  RecordReader   reader;     /* The recording */
+  RecordIndex    index;      /* Its time index */
+  int *          sensors;    /* Registry indices of the matched sensors */
+  int            matched;    /* Number of matched sensors */
+  int            width;      /* Widest "name/label" of the matched sensors */
+  Aggregate      agg;        /* Requested aggregate */
+  QueryCell *    cells;      /* One per matched sensor */
+  TempHistogram *histograms; /* One per matched sensor, for p99 only */
+  int64_t        from;       /* First timestamp in the range */
+  int64_t        to;         /* Last timestamp in the range */
+  int64_t        step;       /* Step in ms, 0 for one row per sensor */
+  int64_t        bucket;     /* Start of the step being filled */
+  unsigned long  decoded;    /* Index entries read frame by frame */
+  unsigned long  summarised; /* Index entries answered from the index */
+} Query;
+
+/**
+ * @brief Prints the usage of `temp query`
+ */
+static void print_query_help(const char *prog_name)
+{
+  printf("\n" COLOR_BOLD COLOR_GREEN "USAGE:\n" COLOR_RESET);
+  printf("  %s query FILE [--sensor GLOB] [--from T] [--to T] [--agg A] [--step T]\n\n",
+         prog_name);
+
+  printf(COLOR_BOLD COLOR_GREEN "OPTIONS:\n" COLOR_RESET);
+  printf("  " COLOR_YELLOW "--sensor GLOB" COLOR_RESET
+         "   Sensors whose label or chip/label matches (default: all)\n");
+  printf("  " COLOR_YELLOW "--from T" COLOR_RESET
+         "        Start of the range (default: start of the recording)\n");
+  printf("  " COLOR_YELLOW "--to T" COLOR_RESET
+         "          End of the range (default: end of the recording)\n");
+  printf("  " COLOR_YELLOW "--agg A" COLOR_RESET "         min, max, mean or p99 (default: max)\n");
+  printf("  " COLOR_YELLOW "--step T" COLOR_RESET
+         "        One row per sensor every T, e.g. 1m (default: one row)\n");
+  printf("  " COLOR_YELLOW "--stats" COLOR_RESET
+         "         Report how many index entries were decoded\n\n");
+
+  printf(COLOR_BOLD COLOR_GREEN "TIMES:\n" COLOR_RESET);
+  printf("  2024-12-05 14:30[:00]  Local time (a 'T' may replace the space)\n");
+  printf("  @1733405400            Seconds since the epoch\n");
+  printf("  +2h / -15m             After the start / before the end of the recording\n\n");
+
+  printf(COLOR_BOLD COLOR_GREEN "EXAMPLES:\n" COLOR_RESET);
+  printf("  %s query soak.rec --sensor 'Core*' --agg max --step 1m --from -1h\n", prog_name);
+  printf("  %s query soak.rec --sensor 'nvme/*' --agg p99 --from '2024-12-05 02:00'"
+         " --to '2024-12-05 03:00'\n\n",
+         prog_name);
+}
+
+/**
+ * @brief Parses a --from/--to time
+ *
+ * @param text Time as described in the help
+ * @param first Timestamp of the first sample, for +DURATION
+ * @param last Timestamp of the last sample, for -DURATION
+ * @param out Parsed time in ms since the epoch
+ * @return 1 on success, 0 if the text is not a time
+ */
+static int parse_time(const char *text, int64_t first, int64_t last, int64_t *out)
+{
+  struct tm tm = {0};
+  int       year, month, day, consumed = 0, fields;
+  long      span;
+
+  if (text[0] == '+' || text[0] == '-')
+  {
+    span = parse_duration(text + 1, -1);
+    if (span < 0)
+      return 0;
+    *out = text[0] == '+' ? first + span * 1000LL : last - span * 1000LL;
+    return 1;
+  }
+
+  if (text[0] == '@')
+  {
+    char *    end;
+    long long seconds;
+
+    errno   = 0;
+    seconds = strtoll(text + 1, &end, 10);
+    if (errno != 0 || end == text + 1 || *end != '\0')
+      return 0;
+    *out = seconds * 1000LL;
+    return 1;
+  }
+
+  fields = sscanf(text, "%d-%d-%d%n", &year, &month, &day, &consumed);
+  if (fields != 3)
+    return 0;
+
+  tm.tm_year  = year - 1900;
+  tm.tm_mon   = month - 1;
+  tm.tm_mday  = day;
+  tm.tm_isdst = -1;
+
+  if (text[consumed] == ' ' || text[consumed] == 'T')
+  {
+    int rest = 0;
+
+    fields = sscanf(text + consumed + 1, "%d:%d%n:%d%n", &tm.tm_hour, &tm.tm_min, &rest,
+                    &tm.tm_sec, &rest);
+    if (fields < 2)
+      return 0;
+    consumed += 1 + rest;
+  }
+
+  if (text[consumed] != '\0')
+    return 0;
+
+  *out = (int64_t) mktime(&tm) * 1000LL;
+  return 1;
+}
+
+/**
+ * @brief Selects the sensors matching glob
+ */
+static int match_sensors(Query *q, const char *glob)
+{
+  char id[MAX_PATH];
+
+  q->sensors = malloc(sizeof(int) * (size_t) q->registry.count);
+  if (!q->sensors)
+    return 0;
+
+  for (int i = 0; i < q->registry.count; i++)
+  {
+    const TempSensor *s = &q->registry.sensors[i];
+    int               len;
+
+    len = snprintf(id, sizeof(id), "%s/%s", s->name, s->label);
+    if (fnmatch(glob, s->label, 0) != 0 && fnmatch(glob, id, 0) != 0)
+      continue;
+
+    q->sensors[q->matched++] = i;
+    if (len > q->width)
+      q->width = len;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Finds the true end of an index rebuilt by scanning
+ *
+ * The last rebuilt entry has no end time; decoding it (one block or
+ * at most RECORD_INDEX_FRAMES raw frames) finds it.
+ */
+static void find_last_timestamp(Query *q)
+{
+  RecordIndexEntry *last    = &q->index.entries[q->index.count - 1];
+  unsigned long     damaged = q->reader.damaged;
+  RecordSample      sample;
+
+  if (last->last_timestamp_ms != INT64_MAX)
+    return;
+
+  last->last_timestamp_ms = last->first_timestamp_ms;
+  if (!record_reader_seek(&q->reader, last->offset, q->reader.end))
+    return;
+
+  while (record_reader_next(&q->reader, &sample))
+  {
+    if (sample.timestamp_ms > last->last_timestamp_ms)
+      last->last_timestamp_ms = sample.timestamp_ms;
+  }
+
+  /* The query reads these frames again and counts damage then */
+  q->reader.damaged = damaged;
+}
+
+/**
+ * @brief Start of the step holding timestamp
+ *
+ * Steps are aligned to whole multiples of the step since the epoch
+ * (full minutes, hours, ...), so rows line up between queries.
+ */
+static int64_t bucket_of(const Query *q, int64_t timestamp)
+{
+  if (q->step == 0)
+    return q->from;
+  return timestamp - ((timestamp % q->step) + q->step) % q->step;
+}
+
+/**
+ * @brief Prints one row per sensor with data in the current step, then
+ *        empties the step
+ */
+static void flush_bucket(Query *q)
+{
+  char when[64], value[MILLI_STR_MAX];
+
+  format_time_ms(q->bucket, when, sizeof(when));
+
+  for (int k = 0; k < q->matched; k++)
+  {
+    const TempSensor *s    = &q->registry.sensors[q->sensors[k]];
+    QueryCell *       cell = &q->cells[k];
+    int32_t           result;
+
+    if (cell->n == 0)
+      continue;
+
+    if (q->agg == AGG_MIN)
+      result = cell->min;
+    else if (q->agg == AGG_MAX)
+      result = cell->max;
+    else if (q->agg == AGG_MEAN)
+      result = (int32_t) ((cell->sum + (cell->sum < 0 ? -(int64_t) cell->n : cell->n) / 2) /
+                          cell->n);
+    else
+    {
+      result = histogram_quantile(&q->histograms[k], QUANTILE_P99);
+      if (result < cell->min)
+        result = cell->min;
+      if (result > cell->max)
+        result = cell->max;
+      histogram_reset(&q->histograms[k]);
+    }
+
+    format_millidegrees(value, result, 1);
+    printf("%s  %s/%-*s  %6s\n", when, s->name, q->width - (int) strlen(s->name) - 1, s->label,
+           value);
+    memset(cell, 0, sizeof(*cell));
+  }
+}
+
+/**
+ * @brief Makes the step starting at bucket the current one
+ */
+static void enter_bucket(Query *q, int64_t bucket)
+{
+  if (bucket == q->bucket)
+    return;
+
+  flush_bucket(q);
+  q->bucket = bucket;
+}
+
+/**
+ * @brief Folds one valid temperature into a sensor's cell
+ */
+static void fold_value(Query *q, int k, int32_t temp)
+{
+  QueryCell *cell = &q->cells[k];
+
+  if (cell->n == 0 || temp < cell->min)
+    cell->min = temp;
+  if (cell->n == 0 || temp > cell->max)
+    cell->max = temp;
+  cell->sum += temp;
+  cell->n++;
+
+  if (q->histograms)
+    histogram_add(&q->histograms[k], temp);
+}
+
+/**
+ * @brief Folds a decoded frame into the current step
+ */
+static void fold_frame(Query *q, const RecordSample *sample)
+{
+  if (sample->timestamp_ms < q->from || sample->timestamp_ms > q->to)
+    return;
+
+  enter_bucket(q, bucket_of(q, sample->timestamp_ms));
+
+  for (int k = 0; k < q->matched; k++)
+  {
+    int32_t temp = sample->temps[q->sensors[k]];
+    if (temp != TEMP_INVALID)
+      fold_value(q, k, temp);
+  }
+}
+
+/**
+ * @brief Folds index entry e from its stored min/max, if that is exact
+ *
+ * @return 1 if the entry was folded, 0 if it has to be decoded
+ */
+static int fold_ranges(Query *q, int e)
+{
+  const RecordIndexEntry *entry = &q->index.entries[e];
+  const int32_t *         min, *max;
+
+  if (!q->index.ranges || (q->agg != AGG_MIN && q->agg != AGG_MAX) ||
+      entry->first_timestamp_ms < q->from || entry->last_timestamp_ms > q->to ||
+      bucket_of(q, entry->first_timestamp_ms) != bucket_of(q, entry->last_timestamp_ms))
+    return 0;
+
+  min = q->index.ranges + (size_t) e * 2 * q->registry.count;
+  max = min + q->registry.count;
+
+  enter_bucket(q, bucket_of(q, entry->first_timestamp_ms));
+
+  for (int k = 0; k < q->matched; k++)
+  {
+    int i = q->sensors[k];
+
+    if (min[i] == TEMP_INVALID)
+      continue;
+    fold_value(q, k, min[i]);
+    fold_value(q, k, max[i]);
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Runs the query over the index, in time order
+ */
+static void run_query(Query *q)
+{
+  RecordSample sample;
+
+  q->bucket = bucket_of(q, q->from);
+
+  for (int e = 0; e < q->index.count; e++)
+  {
+    const RecordIndexEntry *entry = &q->index.entries[e];
+    uint64_t limit = e + 1 < q->index.count ? q->index.entries[e + 1].offset : q->reader.end;
+
+    if (entry->last_timestamp_ms < q->from)
+      continue;
+    if (entry->first_timestamp_ms > q->to)
+      break;
+
+    if (fold_ranges(q, e))
+    {
+      q->summarised++;
+      continue;
+    }
+
+    q->decoded++;
+    if (!record_reader_seek(&q->reader, entry->offset, limit))
+      continue;
+    while (record_reader_next(&q->reader, &sample))
+      fold_frame(q, &sample);
+  }
+
+  flush_bucket(q);
+}
+
+/**
+ * @brief Opens the recording, loads its index and matches sensors
+ */
+static int open_query(Query *q, const char *path, const char *glob)
+{
+  if (!record_reader_open(&q->reader, path, &q->registry))
+  {
+    printf(COLOR_RED "Error: Cannot query %s: %s\n" COLOR_RESET, path,
+           errno ? strerror(errno) : "not a recording, or from a different version");
+    return 0;
+  }
+
+  if (!record_reader_index(&q->reader, &q->index) || !match_sensors(q, glob))
+  {
+    printf(COLOR_RED "Error: Cannot read %s: %s\n" COLOR_RESET, path, strerror(errno));
+    return 0;
+  }
+
+  if (q->matched == 0)
+  {
+    printf(COLOR_RED "Error: No sensor in %s matches '%s'.\n" COLOR_RESET, path, glob);
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Resolves --from/--to/--step and allocates the step cells
+ */
+static int set_range(Query *q, const char *from, const char *to, long step)
+{
+  int64_t first, last;
+
+  if (q->index.count == 0)
+    return 1;
+
+  find_last_timestamp(q);
+  first   = q->index.entries[0].first_timestamp_ms;
+  last    = q->index.entries[q->index.count - 1].last_timestamp_ms;
+  q->from = first;
+  q->to   = last;
+  q->step = step * 1000LL;
+
+  if ((from && !parse_time(from, first, last, &q->from)) ||
+      (to && !parse_time(to, first, last, &q->to)))
+  {
+    printf(COLOR_RED "Error: Invalid time in --from/--to (see temp query --help).\n" COLOR_RESET);
+    return 0;
+  }
+
+  q->cells = calloc((size_t) q->matched, sizeof(QueryCell));
+  if (q->agg == AGG_P99)
+    q->histograms = calloc((size_t) q->matched, sizeof(TempHistogram));
+  if (!q->cells || (q->agg == AGG_P99 && !q->histograms))
+  {
+    printf(COLOR_RED "Error: Not enough memory for %d sensors.\n" COLOR_RESET, q->matched);
+    return 0;
+  }
+
+  for (int k = 0; q->histograms && k < q->matched; k++)
+    histogram_reset(&q->histograms[k]);
+
+  return 1;
+}
+
+/**
+ * @brief Entry point of `temp query`
+ *
+ * @param argc Argument count, argv[0] being "query"
+ * @param argv Argument vector
+ * @return 0 on success, 1 on failure
+ */
+int query_main(int argc, char *argv[])
+{
+  Query       q;
+  const char *path = NULL, *glob = "*", *from = NULL, *to = NULL;
+  long        step  = 0;
+  int         stats = 0, status = 1;
+  long long   started;
+
+  memset(&q, 0, sizeof(q));
+  q.agg = AGG_MAX;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+    {
+      print_query_help("temp");
+      return 0;
+    }
+    else if (strcmp(argv[i], "--stats") == 0)
+    {
+      stats = 1;
+      continue;
+    }
+    else if (argv[i][0] != '-' && !path)
+    {
+      path = argv[i];
+      continue;
+    }
+    else if (!value)
+    {
+      printf(COLOR_RED "Error: Unknown query option '%s' (see temp query --help).\n" COLOR_RESET,
+             argv[i]);
+      return 1;
+    }
+    else if (strcmp(argv[i], "--sensor") == 0)
+      glob = value;
+    else if (strcmp(argv[i], "--from") == 0)
+      from = value;
+    else if (strcmp(argv[i], "--to") == 0)
+      to = value;
+    else if (strcmp(argv[i], "--step") == 0)
+    {
+      step = parse_duration(value, -1);
+      if (step < 1)
+      {
+        printf(COLOR_RED "Error: --step requires a duration such as 10s, 1m or 1h.\n" COLOR_RESET);
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], "--agg") == 0)
+    {
+      int a = 0;
+      while (a < AGG_COUNT && strcmp(value, aggregate_names[a]) != 0)
+        a++;
+      if (a == AGG_COUNT)
+      {
+        printf(COLOR_RED "Error: --agg must be min, max, mean or p99.\n" COLOR_RESET);
+        return 1;
+      }
+      q.agg = (Aggregate) a;
+    }
+    else
+    {
+      printf(COLOR_RED "Error: Unknown query option '%s' (see temp query --help).\n" COLOR_RESET,
+             argv[i]);
+      return 1;
+    }
+    i++;
+  }
+
+  if (!path)
+  {
+    print_query_help("temp");
+    return 1;
+  }
+
+  started = get_time_us();
+  status  = open_query(&q, path, glob) && set_range(&q, from, to, step) ? 0 : 1;
+
+  if (status == 0 && q.index.count > 0)
+  {
+    printf("%-19s  %-*s  %6s\n", "TIME", q.width, "SENSOR", aggregate_names[q.agg]);
+    run_query(&q);
+  }
+
+  if (status == 0 && stats)
+  {
+    fprintf(stderr, "%d index entries: %lu from the index, %lu decoded (%lu damaged), %.1f ms\n",
+            q.index.count, q.summarised, q.decoded, q.reader.damaged,
+            (get_time_us() - started) / 1000.0);
+  }
+
+  free(q.sensors);
+  free(q.cells);
+  free(q.histograms);
+  record_index_free(&q.index);
+  record_reader_close(&q.reader);
+  registry_free(&q.registry);
+  return status;
+}
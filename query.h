@@ -0,0 +1,23 @@
+/**
+ * @file query.h
+ * @brief Temp Monitor - Range queries over recordings
+ *
+ * `temp query FILE` answers min/max/mean/p99 questions about a
+ * --record log per sensor and time step. The file's time index is
+ * used to seek past data outside the requested range, and min/max
+ * over whole index entries come straight from the index, so only the
+ * edges of a range are decoded.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef QUERY_H
+#define QUERY_H
+
+int query_main(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,1074 @@
+/**
+ * @file record.c
+ * @brief Temp Monitor - Binary recording of sensor readings
+ *
+ * Writes the header and sensor table once per file, then one
+ * fixed-size frame per tick with a single write() on an O_APPEND
+ * descriptor, or one compressed block per RECORD_BLOCK_FRAMES ticks.
+ * Data is flushed with fdatasync() every RECORD_SYNC_MS and on
+ * rotation, so a power loss costs at most that much. The reader
+ * side turns either encoding back into frames for --replay.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "record.h"
+
+#include "codec.h"
+#include "registry.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Bytes per frame for count sensors
+ *
+ * @param count Number of sensors
+ * @return Frame size including its header
+ */
+size_t record_frame_size(int count)
+{
+  return sizeof(RecordFrameHeader) + (size_t) (count > 0 ? count : 0) * 2 * sizeof(int32_t);
+}
+
+/**
+ * @brief Formats the file header and sensor table describing a registry
+ *
+ * The table is padded to 8 bytes so frames start aligned. The same
+ * bytes start every file and every daemon stream (see daemon.h).
+ *
+ * @param registry Sensor table to describe
+ * @param interval_ms Sampling interval
+ * @param encoding RECORD_ENCODING_* of the frames that follow
+ * @param out Destination, or NULL to only compute the size
+ * @return Bytes of header and table
+ */
+size_t record_describe(const SensorRegistry *registry, int interval_ms, int encoding,
+                       unsigned char *out)
+{
+  RecordFileHeader file;
+  size_t           table = 0, offset;
+
+  for (int i = 0; i < registry->count; i++)
+  {
+    table += sizeof(RecordSensorEntry) + strlen(registry->sensors[i].name) + 1 +
+             strlen(registry->sensors[i].label) + 1;
+  }
+  table = (table + 7) & ~(size_t) 7;
+  if (!out)
+    return sizeof(file) + table;
+
+  memset(out + sizeof(file), 0, table);
+  offset = sizeof(file);
+  for (int i = 0; i < registry->count; i++)
+  {
+    const TempSensor *s     = &registry->sensors[i];
+    RecordSensorEntry entry = {.type          = (uint8_t) s->type,
+                               .has_fan       = (uint8_t) (s->has_fan != 0),
+                               .reserved      = 0,
+                               .temp_critical = s->temp_critical,
+                               .fan_max_rpm   = s->has_fan ? s->fan_max_rpm : 0};
+    size_t            name  = strlen(s->name) + 1;
+    size_t            label = strlen(s->label) + 1;
+
+    memcpy(out + offset, &entry, sizeof(entry));
+    offset += sizeof(entry);
+    memcpy(out + offset, s->name, name);
+    offset += name;
+    memcpy(out + offset, s->label, label);
+    offset += label;
+  }
+
+  memset(&file, 0, sizeof(file));
+  memcpy(file.magic, RECORD_MAGIC, sizeof(file.magic));
+  file.version      = RECORD_VERSION;
+  file.sensor_count = (uint32_t) registry->count;
+  file.interval_ms  = (uint32_t) interval_ms;
+  file.frame_size   = (uint32_t) record_frame_size(registry->count);
+  file.started_ms   = get_time_ms();
+  file.table_size   = (uint32_t) table;
+  file.table_crc    = crc32_update(0, out + sizeof(file), table);
+  file.encoding     = (uint32_t) encoding;
+  file.block_frames = encoding == RECORD_ENCODING_PACKED ? RECORD_BLOCK_FRAMES : 0;
+  memcpy(out, &file, sizeof(file));
+
+  return sizeof(file) + table;
+}
+
+/**
+ * @brief Builds the file header and sensor table, plus room for one frame
+ */
+static int build_header(Recorder *rec, const SensorRegistry *registry, int interval_ms,
+                        int encoding)
+{
+  rec->header_size = record_describe(registry, interval_ms, encoding, NULL);
+  rec->frame_size  = record_frame_size(registry->count);
+  rec->header      = calloc(1, rec->header_size + rec->frame_size);
+  if (!rec->header)
+    return 0;
+  rec->frame = rec->header + rec->header_size;
+
+  record_describe(registry, interval_ms, encoding, rec->header);
+  return 1;
+}
+
+/**
+ * @brief Allocates the buffers of one compressed block
+ */
+static int alloc_block(Recorder *rec)
+{
+  size_t frames  = RECORD_BLOCK_FRAMES;
+  size_t columns = (size_t) rec->count * 2;
+  size_t bytes   = frames * (sizeof(uint64_t) + sizeof(int64_t) + columns * sizeof(int32_t)) +
+                 sizeof(RecordBlockHeader) + codec_bound(RECORD_BLOCK_FRAMES, (int) columns);
+
+  rec->ticks = malloc(bytes);
+  if (!rec->ticks)
+    return 0;
+
+  rec->timestamps = (int64_t *) (rec->ticks + frames);
+  rec->values     = (int32_t *) (rec->timestamps + frames);
+  rec->block      = (unsigned char *) (rec->values + frames * columns);
+  return 1;
+}
+
+/**
+ * @brief Makes room for one more index entry
+ *
+ * @param index Index to grow
+ * @param count Sensors per entry, or 0 to keep no min/max ranges
+ */
+static int index_grow(RecordIndex *index, int count)
+{
+  RecordIndexEntry *entries;
+  int               capacity;
+
+  if (index->count < index->capacity)
+    return 1;
+
+  capacity = index->capacity ? index->capacity * 2 : 64;
+  entries  = realloc(index->entries, (size_t) capacity * sizeof(*entries));
+  if (!entries)
+    return 0;
+  index->entries = entries;
+
+  if (count > 0)
+  {
+    int32_t *ranges = realloc(index->ranges, (size_t) capacity * 2 * count * sizeof(int32_t));
+    if (!ranges)
+      return 0;
+    index->ranges = ranges;
+  }
+
+  index->capacity = capacity;
+  return 1;
+}
+
+/**
+ * @brief Folds frames just written at offset into the current file's index
+ *
+ * The last entry is extended while the frames fall in its time span;
+ * packed entries always hold whole blocks.
+ */
+static int index_add(Recorder *rec, uint64_t offset, const uint64_t *ticks,
+                     const int64_t *timestamps, const int32_t *rows, int frames)
+{
+  RecordIndex *     index = &rec->index;
+  RecordIndexEntry *entry = index->count ? &index->entries[index->count - 1] : NULL;
+  int64_t           span  = RECORD_INDEX_FRAMES * rec->interval_ms;
+  int32_t *         min, *max;
+
+  if (!entry || entry->first_timestamp_ms / span != timestamps[0] / span)
+  {
+    if (!index_grow(index, rec->count))
+      return 0;
+
+    entry = &index->entries[index->count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->offset             = offset;
+    entry->first_tick         = ticks[0];
+    entry->first_timestamp_ms = timestamps[0];
+
+    min = index->ranges + (size_t) (index->count - 1) * 2 * rec->count;
+    for (int i = 0; i < 2 * rec->count; i++)
+      min[i] = TEMP_INVALID;
+  }
+
+  min = index->ranges + (size_t) (index->count - 1) * 2 * rec->count;
+  max = min + rec->count;
+
+  entry->frames += (uint32_t) frames;
+  entry->last_timestamp_ms = timestamps[frames - 1];
+
+  for (int f = 0; f < frames; f++)
+  {
+    const int32_t *temps = rows + (size_t) f * 2 * rec->count;
+
+    for (int i = 0; i < rec->count; i++)
+    {
+      if (temps[i] == TEMP_INVALID)
+        continue;
+      if (min[i] == TEMP_INVALID || temps[i] < min[i])
+        min[i] = temps[i];
+      if (max[i] == TEMP_INVALID || temps[i] > max[i])
+        max[i] = temps[i];
+    }
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Appends the index and its trailer to the current file
+ *
+ * Written with one write(); the index is then emptied for the next
+ * file.
+ */
+static int write_index(Recorder *rec)
+{
+  RecordIndexTrailer trailer;
+  size_t             ranges = 2 * (size_t) rec->count * sizeof(int32_t);
+  size_t             entry  = sizeof(RecordIndexEntry) + ranges;
+  size_t             size   = (size_t) rec->index.count * entry;
+  unsigned char *    buffer;
+  int                ok;
+
+  if (rec->index.count == 0)
+    return 1;
+
+  buffer = malloc(size + sizeof(trailer));
+  if (!buffer)
+    return 0;
+
+  for (int e = 0; e < rec->index.count; e++)
+  {
+    memcpy(buffer + e * entry, &rec->index.entries[e], sizeof(RecordIndexEntry));
+    memcpy(buffer + e * entry + sizeof(RecordIndexEntry),
+           rec->index.ranges + (size_t) e * 2 * rec->count, ranges);
+  }
+
+  trailer.magic      = RECORD_INDEX_MAGIC;
+  trailer.crc        = crc32_update(0, buffer, size);
+  trailer.offset     = rec->written;
+  trailer.entries    = (uint32_t) rec->index.count;
+  trailer.entry_size = (uint32_t) entry;
+  memcpy(buffer + size, &trailer, sizeof(trailer));
+
+  ok = write_fd(rec->fd, buffer, size + sizeof(trailer));
+  free(buffer);
+
+  rec->index.count = 0;
+  return ok;
+}
+
+/**
+ * @brief Creates the current file and writes its header
+ */
+static int start_file(Recorder *rec)
+{
+  int64_t now = get_time_ms();
+
+  memcpy(rec->header + offsetof(RecordFileHeader, started_ms), &now, sizeof(now));
+
+  rec->fd = open(rec->path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+  if (rec->fd < 0)
+    return 0;
+
+  if (!write_fd(rec->fd, rec->header, rec->header_size) || fdatasync(rec->fd) != 0)
+    return 0;
+
+  rec->written   = rec->header_size;
+  rec->synced_ms = now;
+  return 1;
+}
+
+/**
+ * @brief Shifts FILE.N to FILE.N+1 and FILE to FILE.1
+ *
+ * The oldest file beyond keep is overwritten by the rename; with
+ * keep 0 the current file is simply removed.
+ */
+static void rotate_files(const Recorder *rec)
+{
+  char from[MAX_PATH + 16], to[MAX_PATH + 16];
+
+  if (rec->keep <= 0)
+  {
+    unlink(rec->path);
+    return;
+  }
+
+  for (int n = rec->keep - 1; n >= 1; n--)
+  {
+    snprintf(from, sizeof(from), "%s.%d", rec->path, n);
+    snprintf(to, sizeof(to), "%s.%d", rec->path, n + 1);
+    rename(from, to);
+  }
+
+  snprintf(to, sizeof(to), "%s.1", rec->path);
+  rename(rec->path, to);
+}
+
+/**
+ * @brief Starts a recording
+ *
+ * An existing file at path is rotated away first, never appended to
+ * or overwritten.
+ *
+ * @param rec Recorder to initialize
+ * @param path File to record to
+ * @param registry Sensor table described by the header
+ * @param interval_ms Sampling interval, stored in the header
+ * @param max_bytes Rotate before a file grows past this
+ * @param keep Number of rotated files to keep
+ * @param encoding RECORD_ENCODING_RAW or RECORD_ENCODING_PACKED
+ * @return 1 on success, 0 on failure (errno is set)
+ */
+int record_open(Recorder *rec, const char *path, const SensorRegistry *registry, int interval_ms,
+                size_t max_bytes, int keep, int encoding)
+{
+  memset(rec, 0, sizeof(*rec));
+  rec->fd = -1;
+
+  if (strlen(path) >= sizeof(rec->path))
+  {
+    errno = ENAMETOOLONG;
+    return 0;
+  }
+
+  strcpy(rec->path, path);
+  rec->max_bytes   = max_bytes;
+  rec->keep        = keep;
+  rec->count       = registry->count;
+  rec->encoding    = encoding;
+  rec->interval_ms = interval_ms > 0 ? interval_ms : 1000;
+
+  if (!build_header(rec, registry, interval_ms, encoding) ||
+      (encoding == RECORD_ENCODING_PACKED && !alloc_block(rec)))
+    return 0;
+
+  if (file_exists(rec->path))
+    rotate_files(rec);
+
+  return start_file(rec);
+}
+
+/**
+ * @brief Starts a new file if size more bytes and the index would pass
+ *        the limit
+ */
+static int rotate_if_full(Recorder *rec, size_t size)
+{
+  size_t index = (size_t) (rec->index.count + 1) *
+                     (sizeof(RecordIndexEntry) + 2 * sizeof(int32_t) * rec->count) +
+                 sizeof(RecordIndexTrailer);
+
+  if (rec->written + size + index <= rec->max_bytes || rec->written <= rec->header_size)
+    return 1;
+
+  if (!write_index(rec))
+    return 0;
+  fdatasync(rec->fd);
+  close(rec->fd);
+  rotate_files(rec);
+  return start_file(rec);
+}
+
+/**
+ * @brief Writes a frame or block and syncs if RECORD_SYNC_MS passed
+ */
+static int append(Recorder *rec, const void *data, size_t size)
+{
+  long long now;
+
+  if (!rotate_if_full(rec, size) || !write_fd(rec->fd, data, size))
+    return 0;
+
+  rec->written += size;
+
+  now = get_time_ms();
+  if (now - rec->synced_ms >= RECORD_SYNC_MS)
+  {
+    fdatasync(rec->fd);
+    rec->synced_ms = now;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Copies a snapshot into one row of temp[count], fan_rpm[count]
+ */
+static void fill_row(int count, const SensorSnapshot *snapshot, int32_t *temps)
+{
+  int32_t *fans = temps + count;
+
+  for (int i = 0; i < count; i++)
+  {
+    int live = i < snapshot->count && snapshot->active[i];
+
+    temps[i] = live ? snapshot->temp_current[i] : TEMP_INVALID;
+    fans[i]  = i < snapshot->count ? snapshot->fan_rpm[i] : -1;
+  }
+}
+
+/**
+ * @brief Formats one raw frame, checksum included
+ *
+ * @param snapshot Readings to store
+ * @param count Sensors per frame; missing ones are stored as failed reads
+ * @param frame Destination, record_frame_size(count) bytes
+ */
+void record_frame(const SensorSnapshot *snapshot, int count, unsigned char *frame)
+{
+  size_t            size = record_frame_size(count);
+  RecordFrameHeader head;
+
+  fill_row(count, snapshot, (int32_t *) (frame + sizeof(head)));
+
+  head.magic        = RECORD_FRAME_MAGIC;
+  head.crc          = 0;
+  head.tick         = snapshot->tick;
+  head.timestamp_ms = snapshot->timestamp_ms;
+  memcpy(frame, &head, sizeof(head));
+
+  head.crc = crc32_update(0, frame + offsetof(RecordFrameHeader, tick),
+                          size - offsetof(RecordFrameHeader, tick));
+  memcpy(frame + offsetof(RecordFrameHeader, crc), &head.crc, sizeof(head.crc));
+}
+
+/**
+ * @brief Checks the magic and checksum of one raw frame
+ *
+ * @param frame Frame of size bytes, header included
+ * @param size Frame size from the file header
+ * @return 1 if the frame is intact
+ */
+int record_frame_valid(const unsigned char *frame, size_t size)
+{
+  RecordFrameHeader head;
+
+  memcpy(&head, frame, sizeof(head));
+  return head.magic == RECORD_FRAME_MAGIC &&
+         crc32_update(0, frame + offsetof(RecordFrameHeader, tick),
+                      size - offsetof(RecordFrameHeader, tick)) == head.crc;
+}
+
+/**
+ * @brief Encodes and writes the buffered frames as one block
+ */
+static int flush_block(Recorder *rec)
+{
+  RecordBlockHeader head;
+  unsigned char *   body   = rec->block + sizeof(head);
+  int               frames = rec->pending;
+
+  if (frames == 0)
+    return 1;
+
+  head.magic              = RECORD_BLOCK_MAGIC;
+  head.crc                = 0;
+  head.frames             = (uint32_t) frames;
+  head.first_tick         = rec->ticks[0];
+  head.first_timestamp_ms = rec->timestamps[0];
+  head.size = (uint32_t) codec_encode(rec->ticks, rec->timestamps, rec->values, frames,
+                                      rec->count * 2, body);
+  rec->pending = 0;
+
+  memcpy(rec->block, &head, sizeof(head));
+  head.crc = crc32_update(0, rec->block + offsetof(RecordBlockHeader, frames),
+                          sizeof(head) - offsetof(RecordBlockHeader, frames) + head.size);
+  memcpy(rec->block + offsetof(RecordBlockHeader, crc), &head.crc, sizeof(head.crc));
+
+  if (!append(rec, rec->block, sizeof(head) + head.size))
+    return 0;
+
+  return index_add(rec, rec->written - sizeof(head) - head.size, rec->ticks, rec->timestamps,
+                   rec->values, frames);
+}
+
+/**
+ * @brief Appends one snapshot as a frame
+ *
+ * Redraws of an already written tick are ignored. Raw frames are
+ * written at once; packed frames are buffered until a block is full.
+ *
+ * @param rec Open recorder
+ * @param snapshot Snapshot to record
+ * @return 1 on success, 0 on a write error (errno is set)
+ */
+int record_write(Recorder *rec, const SensorSnapshot *snapshot)
+{
+  RecordFrameHeader head;
+
+  if (rec->fd < 0)
+    return 0;
+  if (snapshot->tick == 0 || snapshot->tick <= rec->tick)
+    return 1;
+
+  rec->tick = snapshot->tick;
+
+  if (rec->encoding == RECORD_ENCODING_PACKED)
+  {
+    int64_t span = RECORD_BLOCK_FRAMES * rec->interval_ms;
+
+    /* Blocks cover one span each, e.g. one wall-clock minute at 1 Hz */
+    if (rec->pending > 0 && rec->timestamps[0] / span != snapshot->timestamp_ms / span &&
+        !flush_block(rec))
+      return 0;
+
+    rec->ticks[rec->pending]      = snapshot->tick;
+    rec->timestamps[rec->pending] = snapshot->timestamp_ms;
+    fill_row(rec->count, snapshot, rec->values + (size_t) rec->pending * rec->count * 2);
+
+    if (++rec->pending < RECORD_BLOCK_FRAMES)
+      return 1;
+    return flush_block(rec);
+  }
+
+  record_frame(snapshot, rec->count, rec->frame);
+  memcpy(&head, rec->frame, sizeof(head));
+
+  if (!append(rec, rec->frame, rec->frame_size))
+    return 0;
+
+  return index_add(rec, rec->written - rec->frame_size, &head.tick, &head.timestamp_ms,
+                   (const int32_t *) (rec->frame + sizeof(head)), 1);
+}
+
+/**
+ * @brief Writes any buffered frames and the index, flushes and closes
+ */
+void record_close(Recorder *rec)
+{
+  if (rec->fd >= 0)
+  {
+    if (flush_block(rec))
+      write_index(rec);
+    fdatasync(rec->fd);
+    close(rec->fd);
+  }
+
+  free(rec->header);
+  free(rec->ticks);
+  record_index_free(&rec->index);
+  memset(rec, 0, sizeof(*rec));
+  rec->fd = -1;
+}
+
+/* Sanity limits for headers read back from disk */
+#define READER_MAX_SENSORS 65536
+#define READER_MAX_TABLE (16 * 1024 * 1024)
+#define READER_MAX_BLOCK_FRAMES 4096
+
+/**
+ * @brief Checks a file header against what this build can read
+ *
+ * @return 1 if the header is valid; table_size is then safe to allocate
+ */
+int record_header_valid(const RecordFileHeader *h)
+{
+  if (memcmp(h->magic, RECORD_MAGIC, sizeof(h->magic)) != 0 || h->version != RECORD_VERSION)
+    return 0;
+  if (h->sensor_count == 0 || h->sensor_count > READER_MAX_SENSORS ||
+      h->table_size > READER_MAX_TABLE || h->table_size % 8 != 0 ||
+      h->frame_size != record_frame_size((int) h->sensor_count))
+    return 0;
+  if (h->encoding == RECORD_ENCODING_PACKED)
+    return h->block_frames >= 1 && h->block_frames <= READER_MAX_BLOCK_FRAMES;
+  return h->encoding == RECORD_ENCODING_RAW;
+}
+
+/**
+ * @brief Rebuilds the sensor table and fan registry from a file's table
+ *
+ * Paths stay empty: a replayed sensor is never read from sysfs.
+ *
+ * @param h Header accepted by record_header_valid()
+ * @param table The h->table_size bytes that follow it
+ * @param registry Empty registry to fill
+ * @return 1 on success, 0 if the table is corrupt or out of memory
+ */
+int record_load_table(const RecordFileHeader *h, const unsigned char *table,
+                      SensorRegistry *registry)
+{
+  size_t offset = 0, size = h->table_size;
+  int    count  = (int) h->sensor_count;
+
+  if (crc32_update(0, table, size) != h->table_crc)
+    return 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    RecordSensorEntry entry;
+    const char *      name, *label;
+    const void *      end;
+    TempSensor *      s;
+
+    if (size - offset < sizeof(entry))
+      return 0;
+    memcpy(&entry, table + offset, sizeof(entry));
+    offset += sizeof(entry);
+
+    name = (const char *) table + offset;
+    end  = memchr(name, '\0', size - offset);
+    if (!end)
+      return 0;
+    offset = (size_t) ((const unsigned char *) end - table) + 1;
+
+    label = (const char *) table + offset;
+    end   = memchr(label, '\0', size - offset);
+    if (!end)
+      return 0;
+    offset = (size_t) ((const unsigned char *) end - table) + 1;
+
+    s = registry_add_sensor(registry);
+    if (!s)
+      return 0;
+
+    s->name          = registry_strdup(registry, name);
+    s->label         = registry_strdup(registry, label);
+    s->type          = entry.type < SENSOR_TYPE_COUNT ? (SensorType) entry.type : SENSOR_OTHER;
+    s->temp_critical = entry.temp_critical;
+    s->has_fan       = entry.has_fan != 0;
+    s->fan_max_rpm   = entry.fan_max_rpm;
+
+    if (s->has_fan)
+    {
+      FanSensor *fan = registry_add_fan(registry);
+      if (!fan)
+        return 0;
+
+      fan->name    = s->name;
+      fan->label   = s->label;
+      fan->max_rpm = s->fan_max_rpm;
+      fan->active  = 1;
+      fan->sensor  = i;
+      s->fan       = registry->fan_count - 1;
+    }
+  }
+
+  return registry_index_types(registry);
+}
+
+/**
+ * @brief Finds where the data ends, looking for an index trailer
+ *
+ * A trailer is only trusted if the index it describes ends exactly
+ * where the file does; otherwise the whole file is data.
+ */
+static int find_trailer(RecordReader *reader)
+{
+  RecordIndexTrailer *t     = &reader->trailer;
+  size_t              entry = sizeof(RecordIndexEntry) + 2 * sizeof(int32_t) * reader->count;
+  off_t               size;
+
+  if (fseeko(reader->file, 0, SEEK_END) != 0 || (size = ftello(reader->file)) < 0)
+    return 0;
+
+  reader->end = (uint64_t) size;
+  if (reader->end >= reader->start + sizeof(*t) &&
+      fseeko(reader->file, size - (off_t) sizeof(*t), SEEK_SET) == 0 &&
+      fread(t, sizeof(*t), 1, reader->file) == 1 && t->magic == RECORD_INDEX_MAGIC &&
+      t->entry_size == entry && t->offset >= reader->start && t->offset <= reader->end &&
+      (reader->end - t->offset - sizeof(*t)) / entry == t->entries &&
+      (reader->end - t->offset - sizeof(*t)) % entry == 0)
+  {
+    reader->end = t->offset;
+  }
+  else
+  {
+    memset(t, 0, sizeof(*t));
+  }
+
+  reader->offset = reader->start;
+  reader->limit  = reader->end;
+  return 1;
+}
+
+/**
+ * @brief Opens a recording and rebuilds its sensor table
+ *
+ * On success registry holds the recorded sensors, in recorded order,
+ * ready for snapshot_init() and the display code.
+ *
+ * @param reader Reader to initialize
+ * @param path Recording written by --record
+ * @param registry Empty registry to fill
+ * @return 1 on success, 0 on failure (errno is set, or 0 if the file
+ *         is not a recording this build can read)
+ */
+int record_reader_open(RecordReader *reader, const char *path, SensorRegistry *registry)
+{
+  RecordFileHeader *h = &reader->header;
+  unsigned char *   table;
+  size_t            columns, frames, bytes;
+  int               ok;
+
+  memset(reader, 0, sizeof(*reader));
+
+  reader->file = fopen(path, "rb");
+  if (!reader->file)
+    return 0;
+
+  errno = 0;
+  if (fread(h, sizeof(*h), 1, reader->file) != 1 || !record_header_valid(h))
+    return 0;
+
+  table = malloc(h->table_size ? h->table_size : 1);
+  if (!table)
+    return 0;
+
+  ok    = fread(table, 1, h->table_size, reader->file) == h->table_size;
+  errno = 0;
+  ok    = ok && record_load_table(h, table, registry);
+  free(table);
+  if (!ok)
+    return 0;
+
+  reader->count = (int) h->sensor_count;
+  columns       = (size_t) reader->count * 2;
+  frames        = h->encoding == RECORD_ENCODING_PACKED ? h->block_frames : 1;
+  bytes         = frames * (sizeof(uint64_t) + sizeof(int64_t) + columns * sizeof(int32_t)) +
+          sizeof(RecordBlockHeader) + codec_bound((int) frames, (int) columns) + h->frame_size;
+
+  reader->ticks = malloc(bytes);
+  if (!reader->ticks)
+    return 0;
+
+  reader->timestamps = (int64_t *) (reader->ticks + frames);
+  reader->values     = (int32_t *) (reader->timestamps + frames);
+  reader->buffer     = (unsigned char *) (reader->values + frames * columns);
+
+  reader->start = sizeof(*h) + h->table_size;
+  if (!find_trailer(reader))
+    return 0;
+  return fseeko(reader->file, (off_t) reader->start, SEEK_SET) == 0;
+}
+
+/**
+ * @brief Reads up to size bytes without passing the read limit
+ *
+ * @return Bytes read; fewer than size at the limit or on a short file
+ */
+static size_t read_bytes(RecordReader *reader, void *data, size_t size)
+{
+  size_t n;
+
+  if (reader->offset >= reader->limit)
+    return 0;
+  if (size > reader->limit - reader->offset)
+    size = (size_t) (reader->limit - reader->offset);
+
+  n = fread(data, 1, size, reader->file);
+  reader->offset += n;
+  return n;
+}
+
+/**
+ * @brief Reads the next raw frame into row 0
+ *
+ * Frames are fixed-size, so a corrupt one is dropped and reading goes
+ * on; only a torn last frame ends the file.
+ */
+static int read_frame(RecordReader *reader)
+{
+  size_t            size = reader->header.frame_size, n;
+  RecordFrameHeader head;
+
+  while ((n = read_bytes(reader, reader->buffer, size)) == size)
+  {
+    if (!record_frame_valid(reader->buffer, size))
+    {
+      reader->damaged++;
+      continue;
+    }
+
+    memcpy(&head, reader->buffer, sizeof(head));
+    reader->ticks[0]      = head.tick;
+    reader->timestamps[0] = head.timestamp_ms;
+    memcpy(reader->values, reader->buffer + sizeof(head), size - sizeof(head));
+    return 1;
+  }
+
+  if (n > 0)
+    reader->damaged++;
+  return 0;
+}
+
+/**
+ * @brief Reads and decodes the next block
+ *
+ * Blocks with a bad checksum are skipped using their size field; a
+ * short read, a lost magic or an impossible size ends the file.
+ */
+static int read_block(RecordReader *reader)
+{
+  int               columns = reader->count * 2;
+  RecordBlockHeader head;
+  unsigned char *   body = reader->buffer + sizeof(head);
+  size_t            n;
+
+  while ((n = read_bytes(reader, &head, sizeof(head))) == sizeof(head))
+  {
+    if (head.magic != RECORD_BLOCK_MAGIC || head.frames == 0 ||
+        head.frames > reader->header.block_frames ||
+        head.size > codec_bound((int) head.frames, columns) ||
+        read_bytes(reader, body, head.size) != head.size)
+      break;
+
+    memcpy(reader->buffer, &head, sizeof(head));
+    if (crc32_update(0, reader->buffer + offsetof(RecordBlockHeader, frames),
+                     sizeof(head) - offsetof(RecordBlockHeader, frames) + head.size) != head.crc ||
+        !codec_decode(body, head.size, (int) head.frames, columns, reader->ticks,
+                      reader->timestamps, reader->values))
+    {
+      reader->damaged++;
+      continue;
+    }
+
+    reader->rows = (int) head.frames;
+    reader->row  = 0;
+    return 1;
+  }
+
+  if (n > 0)
+    reader->damaged++;
+  return 0;
+}
+
+/**
+ * @brief Hands out the next intact frame
+ *
+ * @param reader Open reader
+ * @param sample Output frame, valid until the next call
+ * @return 1 if a frame was read, 0 at the end of the recording
+ */
+int record_reader_next(RecordReader *reader, RecordSample *sample)
+{
+  int32_t *row;
+
+  if (!reader->file)
+    return 0;
+
+  if (reader->header.encoding == RECORD_ENCODING_PACKED)
+  {
+    if (reader->row >= reader->rows && !read_block(reader))
+      return 0;
+  }
+  else
+  {
+    if (!read_frame(reader))
+      return 0;
+    reader->rows = 1;
+    reader->row  = 0;
+  }
+
+  row                  = reader->values + (size_t) reader->row * reader->count * 2;
+  sample->tick         = reader->ticks[reader->row];
+  sample->timestamp_ms = reader->timestamps[reader->row];
+  sample->temps        = row;
+  sample->fans         = row + reader->count;
+
+  reader->row++;
+  reader->frames++;
+  return 1;
+}
+
+/**
+ * @brief Moves the reader to a frame or block boundary
+ *
+ * Reading then stops at limit, so a caller can decode just the span
+ * of one index entry.
+ *
+ * @param reader Open reader
+ * @param offset File offset from an index entry
+ * @param limit File offset to stop at, clamped to the end of the data
+ * @return 1 on success, 0 if the seek failed
+ */
+int record_reader_seek(RecordReader *reader, uint64_t offset, uint64_t limit)
+{
+  if (offset < reader->start || offset > reader->end ||
+      fseeko(reader->file, (off_t) offset, SEEK_SET) != 0)
+    return 0;
+
+  reader->offset = offset;
+  reader->limit  = limit < reader->end ? limit : reader->end;
+  reader->rows   = 0;
+  reader->row    = 0;
+  return 1;
+}
+
+/**
+ * @brief Reads the index written when the file was closed
+ */
+static int load_index(RecordReader *reader, RecordIndex *index)
+{
+  const RecordIndexTrailer *t      = &reader->trailer;
+  size_t                    ranges = 2 * (size_t) reader->count * sizeof(int32_t);
+  size_t                    size   = (size_t) t->entries * t->entry_size;
+  unsigned char *           buffer;
+  int                       ok;
+
+  if (fseeko(reader->file, (off_t) t->offset, SEEK_SET) != 0 || !(buffer = malloc(size + 1)))
+    return 0;
+
+  ok = fread(buffer, 1, size, reader->file) == size && crc32_update(0, buffer, size) == t->crc;
+  for (uint32_t e = 0; ok && e < t->entries; e++)
+  {
+    if (!index_grow(index, reader->count))
+    {
+      ok = 0;
+      break;
+    }
+
+    memcpy(&index->entries[index->count], buffer + e * t->entry_size, sizeof(RecordIndexEntry));
+    memcpy(index->ranges + (size_t) index->count * 2 * reader->count,
+           buffer + e * t->entry_size + sizeof(RecordIndexEntry), ranges);
+    index->count++;
+  }
+
+  free(buffer);
+  return ok;
+}
+
+/**
+ * @brief Appends an entry rebuilt from a frame or block header
+ *
+ * Without the index the last timestamp is unknown; the next entry's
+ * first timestamp (or the end of time) stands in as an upper bound.
+ */
+static int scan_add(RecordIndex *index, uint64_t offset, uint64_t tick, int64_t timestamp_ms,
+                    uint32_t frames)
+{
+  RecordIndexEntry *entry;
+
+  if (!index_grow(index, 0))
+    return 0;
+
+  if (index->count > 0)
+    index->entries[index->count - 1].last_timestamp_ms = timestamp_ms;
+
+  entry = &index->entries[index->count++];
+  memset(entry, 0, sizeof(*entry));
+  entry->offset             = offset;
+  entry->first_tick         = tick;
+  entry->first_timestamp_ms = timestamp_ms;
+  entry->last_timestamp_ms  = INT64_MAX;
+  entry->frames             = frames;
+  return 1;
+}
+
+/**
+ * @brief Rebuilds an index without ranges from frame or block headers
+ *
+ * Raw frames are fixed-size, so only every RECORD_INDEX_FRAMES-th
+ * header is read; blocks are walked header to header, skipping their
+ * payloads.
+ */
+static int scan_index(RecordReader *reader, RecordIndex *index)
+{
+  uint64_t offset = reader->start;
+
+  if (reader->header.encoding == RECORD_ENCODING_PACKED)
+  {
+    RecordBlockHeader head;
+
+    while (offset + sizeof(head) <= reader->end &&
+           fseeko(reader->file, (off_t) offset, SEEK_SET) == 0 &&
+           fread(&head, sizeof(head), 1, reader->file) == 1 && head.magic == RECORD_BLOCK_MAGIC &&
+           head.frames > 0 && head.frames <= reader->header.block_frames &&
+           head.size <= codec_bound((int) head.frames, reader->count * 2))
+    {
+      if (!scan_add(index, offset, head.first_tick, head.first_timestamp_ms, head.frames))
+        return 0;
+      offset += sizeof(head) + head.size;
+    }
+  }
+  else
+  {
+    uint64_t          size   = reader->header.frame_size;
+    uint64_t          frames = (reader->end - reader->start) / size;
+    RecordFrameHeader head;
+
+    for (uint64_t f = 0; f < frames; f += RECORD_INDEX_FRAMES)
+    {
+      int64_t when = index->count ? index->entries[index->count - 1].first_timestamp_ms : 0;
+
+      offset = reader->start + f * size;
+      if (fseeko(reader->file, (off_t) offset, SEEK_SET) != 0 ||
+          fread(&head, sizeof(head), 1, reader->file) != 1)
+        return 0;
+
+      /* A corrupt header must not move the bounds; its frames are
+       * dropped when they are read */
+      if (head.magic == RECORD_FRAME_MAGIC && head.timestamp_ms >= when)
+        when = head.timestamp_ms;
+
+      if (!scan_add(index, offset, head.tick, when,
+                    (uint32_t) (frames - f < RECORD_INDEX_FRAMES ? frames - f
+                                                                  : RECORD_INDEX_FRAMES)))
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Loads the file's time index
+ *
+ * Reads the index written at close, or rebuilds one from the frame
+ * and block headers when the file has none (the recorder crashed or
+ * is still writing it); rebuilt entries carry no min/max ranges.
+ *
+ * @param reader Open reader
+ * @param index Empty index to fill, freed with record_index_free()
+ * @return 1 on success, 0 on a read error or out of memory
+ */
+int record_reader_index(RecordReader *reader, RecordIndex *index)
+{
+  int ok;
+
+  memset(index, 0, sizeof(*index));
+
+  ok = reader->trailer.entries > 0 ? load_index(reader, index) : 0;
+  if (!ok)
+  {
+    record_index_free(index);
+    ok = scan_index(reader, index);
+  }
+
+  return record_reader_seek(reader, reader->start, reader->end) && ok;
+}
+
+/**
+ * @brief Frees an index
+ */
+void record_index_free(RecordIndex *index)
+{
+  free(index->entries);
+  free(index->ranges);
+  memset(index, 0, sizeof(*index));
+}
+
+/**
+ * @brief Closes a reader and frees its buffers
+ */
+void record_reader_close(RecordReader *reader)
+{
+  if (reader->file)
+    fclose(reader->file);
+
+  free(reader->ticks);
+  memset(reader, 0, sizeof(*reader));
+}
@@ -0,0 +1,257 @@
+/**
+ * @file record.h
+ * @brief Temp Monitor - Binary recording of sensor readings
+ *
+ * An append-only log for --record: a header describing the sensor
+ * table, then one fixed-size, checksummed frame per snapshot tick.
+ * Each frame is written with a single write(), so a crash can only
+ * leave a torn last frame, which readers detect and drop. With
+ * --record-compress, frames are instead buffered and written as
+ * checksummed blocks of up to RECORD_BLOCK_FRAMES (see codec.h). Files
+ * rotate by size, logrotate-style (FILE, FILE.1, FILE.2, ...).
+ *
+ * When a file is closed or rotated, a sparse time index is appended:
+ * one entry per RECORD_INDEX_FRAMES frames with its file offset, time
+ * span and per-sensor min/max, then a fixed-size trailer pointing at
+ * it. Queries seek through the index instead of decoding every block;
+ * files without one (crash, still recording) are indexed by scanning
+ * frame and block headers.
+ *
+ * All fields are in host byte order. The magic is a byte string and
+ * reads the same everywhere, so a file from a machine of the other
+ * endianness is only caught by its byte-swapped version and rejected
+ * as unreadable rather than converted.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "sensor.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* File magic, and the layout version that follows it */
+#define RECORD_MAGIC "TMPREC\r\n"
+#define RECORD_VERSION 1
+
+/* First word of every frame or block; lets readers resynchronise */
+#define RECORD_FRAME_MAGIC 0x52464d54u /* "TMFR" */
+#define RECORD_BLOCK_MAGIC 0x4b424d54u /* "TMBK" */
+
+/* Body encodings */
+#define RECORD_ENCODING_RAW 0    /* RecordFrameHeader frames */
+#define RECORD_ENCODING_PACKED 1 /* RecordBlockHeader blocks */
+
+/* Frames per compressed block; also the most a crash can lose */
+#define RECORD_BLOCK_FRAMES 60
+
+/* Intervals summarised by one index entry (whole blocks when packed).
+ * Blocks and entries start at multiples of their span since the epoch,
+ * e.g. whole minutes and 10-minute marks at 1 Hz, so queries by the
+ * minute or hour line up with them */
+#define RECORD_INDEX_FRAMES 600
+
+/* Magic of the index trailer at the very end of a closed file */
+#define RECORD_INDEX_MAGIC 0x58494d54u /* "TMIX" */
+
+/* Default rotation size in MB and number of rotated files kept */
+#define RECORD_DEFAULT_SIZE_MB 256
+#define RECORD_DEFAULT_KEEP 4
+
+/* Interval between fdatasync() calls while recording */
+#define RECORD_SYNC_MS 10000
+
+/**
+ * @brief File header, followed by table_size bytes of sensor table
+ *
+ * Each table entry is a RecordSensorEntry followed by the sensor's
+ * name and label as NUL-terminated strings, in registry order.
+ */
+typedef struct
+{
+  char     magic[8];     /* RECORD_MAGIC */
+  uint32_t version;      /* RECORD_VERSION */
+  uint32_t sensor_count; /* Sensors per frame */
+  uint32_t interval_ms;  /* Sampling interval */
+  uint32_t frame_size;   /* Bytes per raw frame, header included */
+  int64_t  started_ms;   /* Wall clock when the file was opened */
+  uint32_t table_size;   /* Bytes of sensor table after this header */
+  uint32_t table_crc;    /* CRC-32 of the sensor table */
+  uint32_t encoding;     /* RECORD_ENCODING_* */
+  uint32_t block_frames; /* Most frames per block, 0 for raw files */
+} RecordFileHeader;
+
+/**
+ * @brief Fixed part of one sensor table entry
+ */
+typedef struct
+{
+  uint8_t  type;          /* SensorType */
+  uint8_t  has_fan;       /* 1 if fan_rpm carries a paired fan */
+  uint16_t reserved;      /* Zero */
+  int32_t  temp_critical; /* Millidegrees */
+  int32_t  fan_max_rpm;   /* Paired fan's maximum RPM, 0 if unknown */
+} RecordSensorEntry;
+
+/**
+ * @brief Frame header, followed by int32 temp[count], int32 fan_rpm[count]
+ *
+ * Temperatures are millidegrees, TEMP_INVALID for failed or inactive
+ * sensors. Fan speeds are the paired fan's RPM: 0 without a fan, -1
+ * if the read failed.
+ */
+typedef struct
+{
+  uint32_t magic;        /* RECORD_FRAME_MAGIC */
+  uint32_t crc;          /* CRC-32 of the frame after this field */
+  uint64_t tick;         /* Snapshot tick */
+  int64_t  timestamp_ms; /* Wall clock of the sample */
+} RecordFrameHeader;
+
+/**
+ * @brief Block header, followed by size bytes of codec_encode() output
+ *
+ * The block decodes to frames rows of temp[count] then fan_rpm[count],
+ * with the same meaning as in raw frames.
+ */
+typedef struct
+{
+  uint32_t magic;              /* RECORD_BLOCK_MAGIC */
+  uint32_t crc;                /* CRC-32 of the block after this field */
+  uint32_t frames;             /* Frames in the block */
+  uint32_t size;               /* Encoded bytes after this header */
+  uint64_t first_tick;         /* Tick of the first frame */
+  int64_t  first_timestamp_ms; /* Timestamp of the first frame */
+} RecordBlockHeader;
+
+/**
+ * @brief Index entry, followed by int32 min[count], int32 max[count]
+ *
+ * Min and max cover the valid temperatures of the entry's frames,
+ * TEMP_INVALID for a sensor without any.
+ */
+typedef struct
+{
+  uint64_t offset;             /* File offset of the first frame or block */
+  uint64_t first_tick;         /* Tick of the first frame */
+  int64_t  first_timestamp_ms; /* Timestamp of the first frame */
+  int64_t  last_timestamp_ms;  /* Timestamp of the last frame */
+  uint32_t frames;             /* Frames covered */
+  uint32_t reserved;           /* Zero */
+} RecordIndexEntry;
+
+/**
+ * @brief Last bytes of a file with an index
+ */
+typedef struct
+{
+  uint32_t magic;      /* RECORD_INDEX_MAGIC */
+  uint32_t crc;        /* CRC-32 of all index entries */
+  uint64_t offset;     /* File offset of the first entry, i.e. end of the data */
+  uint32_t entries;    /* Number of entries */
+  uint32_t entry_size; /* Bytes per entry, min/max arrays included */
+} RecordIndexTrailer;
+
+/**
+ * @brief Index of one file in memory
+ */
+typedef struct
+{
+  RecordIndexEntry *entries;  /* Entries in file order */
+  int32_t *         ranges;   /* min[count], max[count] per entry, NULL if rebuilt */
+  int               count;    /* Number of entries */
+  int               capacity; /* Allocated entries */
+} RecordIndex;
+
+/**
+ * @brief An open recording
+ */
+typedef struct
+{
+  int            fd;             /* Current file, -1 if closed */
+  char           path[MAX_PATH]; /* Current file name */
+  size_t         max_bytes;      /* Rotate before a file grows past this */
+  int            keep;           /* Rotated files kept */
+  size_t         written;        /* Bytes in the current file */
+  int            count;          /* Sensors per frame */
+  unsigned char *header;         /* File header and sensor table */
+  size_t         header_size;    /* Bytes in header */
+  unsigned char *frame;          /* Frame being assembled */
+  size_t         frame_size;     /* Bytes per frame */
+  int            encoding;       /* RECORD_ENCODING_* */
+  int64_t        interval_ms;    /* Sampling interval, for block and index spans */
+  int            pending;        /* Frames buffered for the next block */
+  uint64_t *     ticks;          /* Tick of each buffered frame */
+  int64_t *      timestamps;     /* Timestamp of each buffered frame */
+  int32_t *      values;         /* Buffered rows of 2 * count values */
+  unsigned char *block;          /* Encoded block being written */
+  unsigned long  tick;           /* Newest tick written */
+  long long      synced_ms;      /* Time of the last fdatasync() */
+  RecordIndex    index;          /* Index of the current file so far */
+} Recorder;
+
+/**
+ * @brief One frame handed out by record_reader_next()
+ *
+ * The arrays point into the reader and stay valid until the next call.
+ */
+typedef struct
+{
+  uint64_t       tick;         /* Snapshot tick */
+  int64_t        timestamp_ms; /* Wall clock of the sample */
+  const int32_t *temps;        /* count temperatures, as in RecordFrameHeader */
+  const int32_t *fans;         /* count fan speeds */
+} RecordSample;
+
+/**
+ * @brief A recording opened for reading, e.g. by --replay
+ */
+typedef struct
+{
+  FILE *             file;       /* Recording, NULL if closed */
+  RecordFileHeader   header;     /* Header of the file */
+  int                count;      /* Sensors per frame */
+  uint64_t           start;      /* File offset of the first frame or block */
+  uint64_t           end;        /* File offset where the data ends */
+  uint64_t           offset;     /* File offset of the next read */
+  uint64_t           limit;      /* Reads stop here, see record_reader_seek() */
+  RecordIndexTrailer trailer;    /* Index trailer, zero if the file has none */
+  unsigned char *    buffer;     /* One raw frame or one encoded block */
+  uint64_t *         ticks;      /* Tick of each decoded frame */
+  int64_t *          timestamps; /* Timestamp of each decoded frame */
+  int32_t *          values;     /* Decoded rows of 2 * count values */
+  int                rows;       /* Rows decoded from the current block */
+  int                row;        /* Next row to hand out */
+  unsigned long      frames;     /* Frames handed out so far */
+  unsigned long      damaged;    /* Frames or blocks dropped as corrupt or torn */
+} RecordReader;
+
+size_t record_frame_size(int count);
+size_t record_describe(const SensorRegistry *registry, int interval_ms, int encoding,
+                       unsigned char *out);
+void   record_frame(const SensorSnapshot *snapshot, int count, unsigned char *frame);
+int    record_frame_valid(const unsigned char *frame, size_t size);
+int    record_header_valid(const RecordFileHeader *h);
+int    record_load_table(const RecordFileHeader *h, const unsigned char *table,
+                         SensorRegistry *registry);
+int    record_open(Recorder *rec, const char *path, const SensorRegistry *registry, int interval_ms,
+                   size_t max_bytes, int keep, int encoding);
+int    record_write(Recorder *rec, const SensorSnapshot *snapshot);
+void   record_close(Recorder *rec);
+
+int  record_reader_open(RecordReader *reader, const char *path, SensorRegistry *registry);
+int  record_reader_next(RecordReader *reader, RecordSample *sample);
+int  record_reader_index(RecordReader *reader, RecordIndex *index);
+int  record_reader_seek(RecordReader *reader, uint64_t offset, uint64_t limit);
+void record_index_free(RecordIndex *index);
+void record_reader_close(RecordReader *reader);
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * @file registry.c
+ * @brief Temp Monitor - Growable sensor registry implementation
+ *
+ * Arrays double on demand, so a machine with five sensors pays for
+ * five and a storage node with thousands is not cut off. Because the
+ * arrays may move, callers hold on to indices, never pointers into
+ * them; arena strings, on the other hand, never move.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "registry.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief One chunk of arena storage
+ */
+struct ArenaBlock
+{
+  ArenaBlock *next;     /* Previously filled block */
+  size_t      used;     /* Bytes used in data */
+  size_t      capacity; /* Bytes available in data */
+  char        data[];   /* String storage */
+};
+
+/**
+ * @brief Copies a string into the arena
+ *
+ * @param arena Arena to store into
+ * @param str String to copy; NULL is stored as ""
+ * @return Stable pointer to the copy, or NULL if out of memory
+ */
+const char *arena_strdup(StringArena *arena, const char *str)
+{
+  ArenaBlock *block = arena->head;
+  size_t      len;
+  char *      copy;
+
+  if (!str)
+    str = "";
+
+  len = strlen(str) + 1;
+
+  if (!block || block->capacity - block->used < len)
+  {
+    size_t capacity = len > ARENA_BLOCK_SIZE ? len : ARENA_BLOCK_SIZE;
+
+    block = malloc(sizeof(ArenaBlock) + capacity);
+    if (!block)
+      return NULL;
+
+    block->used     = 0;
+    block->capacity = capacity;
+
+    /* Oversized strings go behind the head so it keeps filling up */
+    if (arena->head && capacity > ARENA_BLOCK_SIZE)
+    {
+      block->next       = arena->head->next;
+      arena->head->next = block;
+    }
+    else
+    {
+      block->next = arena->head;
+      arena->head = block;
+    }
+  }
+
+  copy = block->data + block->used;
+  memcpy(copy, str, len);
+  block->used += len;
+  arena->bytes += len;
+  return copy;
+}
+
+/**
+ * @brief Moves all blocks of src into dest without copying strings
+ *
+ * Pointers into src stay valid and are now owned by dest.
+ */
+void arena_adopt(StringArena *dest, StringArena *src)
+{
+  ArenaBlock *tail;
+
+  if (!src->head)
+    return;
+
+  if (!dest->head)
+  {
+    *dest = *src;
+  }
+  else
+  {
+    /* dest keeps filling its own head; src blocks go behind it */
+    for (tail = src->head; tail->next; tail = tail->next)
+      ;
+    tail->next       = dest->head->next;
+    dest->head->next = src->head;
+    dest->bytes += src->bytes;
+  }
+
+  src->head  = NULL;
+  src->bytes = 0;
+}
+
+/**
+ * @brief Releases all arena blocks
+ */
+void arena_free(StringArena *arena)
+{
+  while (arena->head)
+  {
+    ArenaBlock *next = arena->head->next;
+    free(arena->head);
+    arena->head = next;
+  }
+  arena->bytes = 0;
+}
+
+/**
+ * @brief Grows an array to hold at least one more element
+ *
+ * @return 1 on success, 0 if out of memory
+ */
+static int grow_array(void **items, int *capacity, int count, size_t item_size)
+{
+  void *grown;
+  int   new_capacity;
+
+  if (count < *capacity)
+    return 1;
+
+  new_capacity = *capacity ? *capacity * 2 : 16;
+  grown        = realloc(*items, new_capacity * item_size);
+  if (!grown)
+    return 0;
+
+  *items    = grown;
+  *capacity = new_capacity;
+  return 1;
+}
+
+/**
+ * @brief Appends a blank sensor to the registry
+ *
+ * The sensor has no strings yet, closed descriptors and no fan.
+ * The returned pointer is valid until the next registry_add_sensor().
+ *
+ * @return New sensor, or NULL if out of memory
+ */
+TempSensor *registry_add_sensor(SensorRegistry *registry)
+{
+  TempSensor *s;
+
+  if (!grow_array((void **) &registry->sensors, &registry->capacity, registry->count,
+                  sizeof(TempSensor)))
+  {
+    return NULL;
+  }
+
+  s = &registry->sensors[registry->count++];
+  memset(s, 0, sizeof(TempSensor));
+  s->name     = "";
+  s->label    = "";
+  s->path     = "";
+  s->fan_path = "";
+  s->fd       = -1;
+  s->fan_fd   = -1;
+  s->fan      = -1;
+  return s;
+}
+
+/**
+ * @brief Appends a blank, unpaired fan to the registry
+ *
+ * The returned pointer is valid until the next registry_add_fan().
+ *
+ * @return New fan, or NULL if out of memory
+ */
+FanSensor *registry_add_fan(SensorRegistry *registry)
+{
+  FanSensor *fan;
+
+  if (!grow_array((void **) &registry->fans, &registry->fan_capacity, registry->fan_count,
+                  sizeof(FanSensor)))
+  {
+    return NULL;
+  }
+
+  fan = &registry->fans[registry->fan_count++];
+  memset(fan, 0, sizeof(FanSensor));
+  fan->name   = "";
+  fan->label  = "";
+  fan->path   = "";
+  fan->sensor = -1;
+  return fan;
+}
+
+/**
+ * @brief Copies a string into the registry's arena
+ *
+ * @return Stable pointer, or "" if out of memory
+ */
+const char *registry_strdup(SensorRegistry *registry, const char *str)
+{
+  const char *copy = arena_strdup(&registry->strings, str);
+  return copy ? copy : "";
+}
+
+/**
+ * @brief Moves every sensor, fan and string of src to the end of dest
+ *
+ * Sensor/fan cross indices are rebased; src is left empty.
+ *
+ * @return 1 on success, 0 if out of memory (src is left untouched)
+ */
+int registry_append(SensorRegistry *dest, SensorRegistry *src)
+{
+  int sensor_base = dest->count;
+  int fan_base    = dest->fan_count;
+
+  if (dest->capacity < dest->count + src->count)
+  {
+    TempSensor *grown = realloc(dest->sensors, (dest->count + src->count) * sizeof(TempSensor));
+    if (!grown)
+      return 0;
+    dest->sensors  = grown;
+    dest->capacity = dest->count + src->count;
+  }
+
+  if (dest->fan_capacity < dest->fan_count + src->fan_count)
+  {
+    FanSensor *grown = realloc(dest->fans, (dest->fan_count + src->fan_count) * sizeof(FanSensor));
+    if (!grown)
+      return 0;
+    dest->fans         = grown;
+    dest->fan_capacity = dest->fan_count + src->fan_count;
+  }
+
+  for (int i = 0; i < src->count; i++)
+  {
+    TempSensor *s = &dest->sensors[dest->count++];
+
+    *s = src->sensors[i];
+    if (s->fan >= 0)
+      s->fan += fan_base;
+  }
+
+  for (int i = 0; i < src->fan_count; i++)
+  {
+    FanSensor *fan = &dest->fans[dest->fan_count++];
+
+    *fan = src->fans[i];
+    if (fan->sensor >= 0)
+      fan->sensor += sensor_base;
+  }
+
+  arena_adopt(&dest->strings, &src->strings);
+
+  /* Descriptors now belong to dest */
+  src->count     = 0;
+  src->fan_count = 0;
+  registry_free(src);
+  return 1;
+}
+
+/**
+ * @brief Builds the per-type index lists
+ *
+ * A counting sort over the sensor types: renderers and statistics
+ * then visit exactly the sensors of one type without scanning the
+ * whole table. Must be called again after sensors are added.
+ *
+ * @return 1 on success, 0 if out of memory
+ */
+int registry_index_types(SensorRegistry *registry)
+{
+  int  next[SENSOR_TYPE_COUNT];
+  int *by_type = realloc(registry->by_type, (registry->count + 1) * sizeof(int));
+
+  if (!by_type)
+    return 0;
+  registry->by_type = by_type;
+
+  memset(registry->type_start, 0, sizeof(registry->type_start));
+  for (int i = 0; i < registry->count; i++)
+  {
+    registry->type_start[registry->sensors[i].type + 1]++;
+  }
+
+  for (int t = 0; t < SENSOR_TYPE_COUNT; t++)
+  {
+    registry->type_start[t + 1] += registry->type_start[t];
+    next[t] = registry->type_start[t];
+  }
+
+  for (int i = 0; i < registry->count; i++)
+  {
+    registry->by_type[next[registry->sensors[i].type]++] = i;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Closes all descriptors and frees the registry
+ *
+ * Leaves an empty registry that can be filled again.
+ */
+void registry_free(SensorRegistry *registry)
+{
+  close_sensor_files(registry->sensors, registry->count);
+  free(registry->sensors);
+  free(registry->fans);
+  free(registry->by_type);
+  arena_free(&registry->strings);
+  memset(registry, 0, sizeof(*registry));
+}
@@ -0,0 +1,70 @@
+/**
+ * @file registry.h
+ * @brief Temp Monitor - Growable sensor registry and string arena
+ *
+ * Holds the sensor table and fan registry in arrays that grow with
+ * the hardware actually found. Names, labels and paths live in a
+ * block arena owned by the registry, so TempSensor only carries
+ * pointers.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include "sensor.h"
+
+/* Size of one string arena block; longer strings get their own block */
+#define ARENA_BLOCK_SIZE 16384
+
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * @brief Append-only string storage
+ *
+ * Strings are never moved once stored, so pointers into the arena
+ * stay valid until arena_free(). Blocks can be handed from one arena
+ * to another without copying.
+ */
+typedef struct
+{
+  ArenaBlock *head;  /* Block currently being filled */
+  size_t      bytes; /* Total bytes stored, for diagnostics */
+} StringArena;
+
+/**
+ * @brief Sensor table, fan registry and the strings they point to
+ */
+struct SensorRegistry
+{
+  TempSensor *sensors;      /* Temperature sensors, in scan order */
+  int         count;        /* Number of sensors */
+  int         capacity;     /* Allocated entries in sensors */
+  FanSensor * fans;         /* Every detected fan */
+  int         fan_count;    /* Number of fans */
+  int         fan_capacity; /* Allocated entries in fans */
+  StringArena strings;      /* Storage for names, labels and paths */
+
+  /* Sensor indices grouped by type; type T owns by_type[type_start[T]]
+   * up to by_type[type_start[T + 1]], in table order */
+  int *by_type;
+  int  type_start[SENSOR_TYPE_COUNT + 1];
+};
+
+const char *arena_strdup(StringArena *arena, const char *str);
+void        arena_adopt(StringArena *dest, StringArena *src);
+void        arena_free(StringArena *arena);
+
+TempSensor *registry_add_sensor(SensorRegistry *registry);
+FanSensor * registry_add_fan(SensorRegistry *registry);
+const char *registry_strdup(SensorRegistry *registry, const char *str);
+int         registry_append(SensorRegistry *dest, SensorRegistry *src);
+int         registry_index_types(SensorRegistry *registry);
+void        registry_free(SensorRegistry *registry);
+
+#endif
@@ -0,0 +1,401 @@
+/**
+ * @file sampler.c
+ * @brief Temp Monitor - Background sampling thread implementation
+ *
+ * The sampler thread owns the sensor table while running: it samples
+ * into a private snapshot and then copies it into the published one
+ * under a seqlock. Readers copy the published snapshot without ever
+ * taking a lock and retry if a publish raced with them. A condition
+ * variable lets consumers sleep until the next tick; threads that sleep
+ * in epoll instead can have an eventfd signalled on every publish.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "sampler.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Sampler thread state */
+static struct
+{
+  pthread_t   thread;
+  int         running;
+  TempSensor *sensors;
+  int         count;
+  int         interval_ms;
+
+  /* Set by sampler_start_source(): samples come from here, not sysfs */
+  SamplerSource source;
+  atomic_int    finished; /* 1 once the source has ended */
+
+  /* Eventfd signalled after every publish, -1 for none */
+  atomic_int notify_fd;
+
+  /* Private buffer the thread samples into */
+  SensorSnapshot work;
+
+  /* Set by sampler_reset_stats(), consumed before the next sample */
+  atomic_int reset;
+
+  /* Seqlock-protected published snapshot; odd seq means write in progress */
+  atomic_uint    seq;
+  SensorSnapshot published;
+  atomic_ulong   tick;
+
+  /* Wakes consumers on publish and the thread on stop */
+  pthread_mutex_t lock;
+  pthread_cond_t  published_cond;
+  pthread_cond_t  stop_cond;
+  int             stop;
+} sampler = {.lock = PTHREAD_MUTEX_INITIALIZER, .notify_fd = -1};
+
+/**
+ * @brief Adds milliseconds to a CLOCK_MONOTONIC timespec
+ */
+static void timespec_add_ms(struct timespec *ts, long ms)
+{
+  ts->tv_sec += ms / 1000;
+  ts->tv_nsec += (ms % 1000) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L)
+  {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+
+/**
+ * @brief Tells whether a CLOCK_MONOTONIC timespec is earlier than b
+ */
+static int timespec_before(const struct timespec *a, const struct timespec *b)
+{
+  return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+/**
+ * @brief Copies the private snapshot into the published one
+ *
+ * Writers bump seq to odd, copy, then bump it back to even.
+ */
+static void publish_snapshot(void)
+{
+  unsigned seq = atomic_load_explicit(&sampler.seq, memory_order_relaxed);
+
+  atomic_store_explicit(&sampler.seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  snapshot_copy(&sampler.published, &sampler.work);
+
+  atomic_store_explicit(&sampler.seq, seq + 2, memory_order_release);
+  atomic_store_explicit(&sampler.tick, sampler.work.tick, memory_order_release);
+
+  pthread_mutex_lock(&sampler.lock);
+  pthread_cond_broadcast(&sampler.published_cond);
+  pthread_mutex_unlock(&sampler.lock);
+
+  int fd = atomic_load(&sampler.notify_fd);
+  if (fd >= 0)
+  {
+    uint64_t one = 1;
+    ssize_t  n   = write(fd, &one, sizeof(one));
+    (void) n; /* Fails only while a wakeup is already pending */
+  }
+}
+
+/**
+ * @brief Sampler thread body
+ *
+ * Samples on a fixed CLOCK_MONOTONIC schedule. A stalled read only
+ * delays this thread; consumers keep seeing the last snapshot. Ticks
+ * missed while a pass overran are skipped rather than run back to back.
+ */
+static void *sampler_main(void *arg)
+{
+  struct timespec next, now;
+
+  (void) arg;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  pthread_mutex_lock(&sampler.lock);
+  while (!sampler.stop)
+  {
+    pthread_mutex_unlock(&sampler.lock);
+
+    if (atomic_exchange(&sampler.reset, 0))
+      snapshot_reset_stats(&sampler.work);
+
+    sample_sensors(sampler.sensors, sampler.count, &sampler.work);
+    publish_snapshot();
+
+    timespec_add_ms(&next, sampler.interval_ms);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (timespec_before(&next, &now))
+    {
+      next = now;
+      timespec_add_ms(&next, sampler.interval_ms);
+    }
+
+    pthread_mutex_lock(&sampler.lock);
+    while (!sampler.stop)
+    {
+      if (pthread_cond_timedwait(&sampler.stop_cond, &sampler.lock, &next) != 0)
+        break;
+    }
+  }
+  pthread_mutex_unlock(&sampler.lock);
+
+  return NULL;
+}
+
+/**
+ * @brief Sampler thread body with a SamplerSource
+ *
+ * The source paces the thread; it returns at least every ~200 ms so
+ * that a stop request is noticed.
+ */
+static void *source_main(void *arg)
+{
+  int stop = 0, taken = 0;
+
+  (void) arg;
+
+  while (!stop && taken >= 0)
+  {
+    if (atomic_exchange(&sampler.reset, 0))
+      snapshot_reset_stats(&sampler.work);
+
+    taken = sampler.source(&sampler.work);
+    if (taken > 0)
+      publish_snapshot();
+
+    pthread_mutex_lock(&sampler.lock);
+    stop = sampler.stop;
+    pthread_mutex_unlock(&sampler.lock);
+  }
+
+  /* Wake consumers so they can see the source is gone */
+  atomic_store(&sampler.finished, 1);
+  pthread_mutex_lock(&sampler.lock);
+  pthread_cond_broadcast(&sampler.published_cond);
+  pthread_mutex_unlock(&sampler.lock);
+
+  return NULL;
+}
+
+/**
+ * @brief Sets up the snapshots and starts the thread
+ */
+static int start_thread(void *(*body)(void *), int count)
+{
+  pthread_condattr_t attr;
+
+  sampler.count = count;
+  sampler.stop  = 0;
+
+  if (!snapshot_init(&sampler.work, count) || !snapshot_enable_histograms(&sampler.work) ||
+      !snapshot_init(&sampler.published, count))
+  {
+    snapshot_free(&sampler.work);
+    return 0;
+  }
+
+  atomic_store(&sampler.reset, 0);
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&sampler.stop_cond, &attr);
+  pthread_condattr_destroy(&attr);
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&sampler.published_cond, &attr);
+  pthread_condattr_destroy(&attr);
+
+  atomic_store(&sampler.finished, 0);
+  if (pthread_create(&sampler.thread, NULL, body, NULL) != 0)
+  {
+    pthread_cond_destroy(&sampler.stop_cond);
+    pthread_cond_destroy(&sampler.published_cond);
+    snapshot_free(&sampler.work);
+    snapshot_free(&sampler.published);
+    return 0;
+  }
+
+  sampler.running = 1;
+  return 1;
+}
+
+/**
+ * @brief Starts the background sampler thread
+ *
+ * The sensor table belongs to the sampler until sampler_stop();
+ * other threads may only read its metadata (name, label, type...).
+ *
+ * @param sensors Array of sensors to sample
+ * @param count Number of sensors
+ * @param interval_ms Sampling period in milliseconds
+ * @return 1 on success, 0 on failure
+ */
+int sampler_start(TempSensor *sensors, int count, int interval_ms)
+{
+  if (sampler.running)
+    return 1;
+
+  sampler.sensors     = sensors;
+  sampler.source      = NULL;
+  sampler.interval_ms = interval_ms > 0 ? interval_ms : 1000;
+  return start_thread(sampler_main, count);
+}
+
+/**
+ * @brief Starts the sampler thread on samples from a source
+ *
+ * Consumers see the source's snapshots exactly as they would see
+ * sampled ones, statistics included.
+ *
+ * @param source Called in a loop on the sampler thread
+ * @param count Number of sensors the source fills
+ * @return 1 on success, 0 on failure
+ */
+int sampler_start_source(SamplerSource source, int count)
+{
+  if (sampler.running)
+    return 1;
+
+  sampler.sensors = NULL;
+  sampler.source  = source;
+  return start_thread(source_main, count);
+}
+
+/**
+ * @brief Tells whether the source given to sampler_start_source() ended
+ *
+ * The last snapshot stays published after it did.
+ */
+int sampler_finished(void)
+{
+  return atomic_load(&sampler.finished);
+}
+
+/**
+ * @brief Has an eventfd signalled after every publish
+ *
+ * @param fd Eventfd to write to from the sampler thread, or -1 to stop
+ */
+void sampler_notify(int fd)
+{
+  atomic_store(&sampler.notify_fd, fd);
+}
+
+/**
+ * @brief Stops the sampler thread and waits for it to exit
+ *
+ * Blocks until any in-flight sample pass has finished.
+ */
+void sampler_stop(void)
+{
+  if (!sampler.running)
+    return;
+
+  pthread_mutex_lock(&sampler.lock);
+  sampler.stop = 1;
+  pthread_cond_broadcast(&sampler.stop_cond);
+  pthread_mutex_unlock(&sampler.lock);
+
+  pthread_join(sampler.thread, NULL);
+  pthread_cond_destroy(&sampler.stop_cond);
+  pthread_cond_destroy(&sampler.published_cond);
+  snapshot_free(&sampler.work);
+  snapshot_free(&sampler.published);
+  atomic_store(&sampler.tick, 0);
+  sampler.running = 0;
+}
+
+/**
+ * @brief Copies the latest published snapshot without blocking
+ *
+ * @param out Destination snapshot, sized for the sampled sensor count
+ * @return 1 if a snapshot has been published, 0 if none yet
+ */
+int sampler_read(SensorSnapshot *out)
+{
+  unsigned before, after = 0;
+
+  if (atomic_load_explicit(&sampler.tick, memory_order_acquire) == 0)
+    return 0;
+
+  do
+  {
+    before = atomic_load_explicit(&sampler.seq, memory_order_acquire);
+    if (before & 1)
+      continue;
+
+    snapshot_copy(out, &sampler.published);
+
+    atomic_thread_fence(memory_order_acquire);
+    after = atomic_load_explicit(&sampler.seq, memory_order_relaxed);
+  } while ((before & 1) || before != after);
+
+  return 1;
+}
+
+/**
+ * @brief Asks the sampler to start its statistics over
+ *
+ * Only sets a flag, so it is safe to call from a signal handler. The
+ * reset takes effect before the next sample pass; the published
+ * snapshot keeps the old statistics until then.
+ */
+void sampler_reset_stats(void)
+{
+  atomic_store(&sampler.reset, 1);
+}
+
+/**
+ * @brief Gets the tick number of the latest published snapshot
+ */
+unsigned long sampler_tick(void)
+{
+  return atomic_load_explicit(&sampler.tick, memory_order_acquire);
+}
+
+/**
+ * @brief Waits until a snapshot newer than last_tick is published
+ *
+ * @param last_tick Tick the caller has already consumed
+ * @param timeout_ms Maximum time to wait
+ * @return 1 if a newer snapshot is available, 0 on timeout
+ */
+int sampler_wait(unsigned long last_tick, int timeout_ms)
+{
+  struct timespec deadline;
+  int             ready;
+
+  if (sampler_tick() > last_tick)
+    return 1;
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  timespec_add_ms(&deadline, timeout_ms);
+
+  pthread_mutex_lock(&sampler.lock);
+  while (!(ready = sampler_tick() > last_tick))
+  {
+    if (pthread_cond_timedwait(&sampler.published_cond, &sampler.lock, &deadline) != 0)
+    {
+      ready = sampler_tick() > last_tick;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&sampler.lock);
+
+  return ready;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file sampler.h
+ * @brief Temp Monitor - Background sampling thread
+ *
+ * Runs sample_sensors() on a dedicated thread and publishes each
+ * finished snapshot through a seqlock, so the UI and other consumers
+ * never block on a slow sysfs read. With --connect the thread takes
+ * its samples from a SamplerSource (the daemon) instead of sysfs, and
+ * every consumer works the same.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "sensor.h"
+
+/**
+ * @brief Fills snapshot with the next sample, waiting at most ~200 ms
+ *
+ * @return 1 if a sample was taken, 0 if none came yet (called again
+ *         unless stopping), -1 if the source has ended
+ */
+typedef int (*SamplerSource)(SensorSnapshot *snapshot);
+
+int           sampler_start(TempSensor *sensors, int count, int interval_ms);
+int           sampler_start_source(SamplerSource source, int count);
+int           sampler_finished(void);
+void          sampler_notify(int fd);
+void          sampler_stop(void);
+int           sampler_read(SensorSnapshot *out);
+void          sampler_reset_stats(void);
+unsigned long sampler_tick(void);
+int           sampler_wait(unsigned long last_tick, int timeout_ms);
+
+#endif
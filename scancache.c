@@ -0,0 +1,569 @@
+/**
+ * @file scancache.c
+ * @brief Temp Monitor - Persistent sensor scan cache implementation
+ *
+ * The cache is a small tab-separated text file. Its header holds a
+ * fingerprint of the current hwmon set: a hash over the sorted
+ * device identities of every hwmon chip. Checking it only needs one
+ * getdents pass and one readlinkat() per chip, so a warm start skips
+ * all label/threshold reads and type classification.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "scancache.h"
+
+#include "registry.h"
+#include "utils.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Magic string on the first line of the cache file */
+#define SCAN_CACHE_MAGIC "temp-monitor-scan-cache"
+
+/**
+ * @brief Device identity of one hwmon class entry
+ */
+typedef struct
+{
+  char entry[64];     /* hwmonN */
+  char key[MAX_PATH]; /* Stable device identity */
+} ChipKey;
+
+/**
+ * @brief Current hwmon set with its fingerprint
+ */
+typedef struct
+{
+  int      class_fd;             /* Descriptor of the hwmon class dir */
+  char     class_path[MAX_PATH]; /* Absolute hwmon class path */
+  ChipKey *chips;                /* One entry per hwmon chip */
+  int      count;                /* Number of chips */
+  uint64_t fingerprint;          /* Hash over sorted keys */
+} ChipSet;
+
+static int cache_enabled = 1;
+static int cache_rescan  = 0;
+
+/**
+ * @brief Enables or disables the scan cache (--no-cache)
+ */
+void scan_cache_set_enabled(int enabled)
+{
+  cache_enabled = enabled;
+}
+
+/**
+ * @brief Forces a fresh scan that rewrites the cache (--rescan)
+ */
+void scan_cache_set_rescan(int rescan)
+{
+  cache_rescan = rescan;
+}
+
+/**
+ * @brief Builds the cache file path from XDG_CACHE_HOME or HOME
+ *
+ * @return 1 if a path could be built, 0 if no cache location exists
+ */
+static int cache_path(char *path, size_t size, int create_dir)
+{
+  const char *xdg  = getenv("XDG_CACHE_HOME");
+  const char *home = getenv("HOME");
+  char        base[MAX_PATH];
+  char        dir[MAX_PATH];
+
+  if (xdg && xdg[0] == '/')
+    snprintf(base, sizeof(base), "%s", xdg);
+  else if (home && home[0] == '/')
+    snprintf(base, sizeof(base), "%s/.cache", home);
+  else
+    return 0;
+
+  path_join(dir, sizeof(dir), base, "temp-monitor");
+
+  if (create_dir)
+  {
+    mkdir(base, 0755);
+    mkdir(dir, 0755);
+  }
+
+  path_join(path, size, dir, SCAN_CACHE_FILE);
+  return 1;
+}
+
+/**
+ * @brief 64-bit FNV-1a over a byte string, chained through hash
+ */
+static uint64_t fnv1a(uint64_t hash, const char *data)
+{
+  while (*data)
+  {
+    hash ^= (unsigned char) *data++;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Resolves the device identity of one hwmon class entry
+ *
+ * The class entry is a symlink into the device tree, e.g.
+ * ../../devices/platform/coretemp.0/hwmon/hwmon3. Stripping the
+ * trailing hwmon/hwmonN yields the directory hwmonN/device points
+ * to, which survives renumbering across boots and driver reloads.
+ */
+static void resolve_chip_key(int class_fd, const char *entry, char *key, size_t size)
+{
+  char    link[MAX_PATH];
+  char    attr[96];
+  ssize_t len;
+
+  len = readlinkat(class_fd, entry, link, sizeof(link) - 1);
+  if (len > 0)
+  {
+    char  suffix[80];
+    char *start = link;
+
+    link[len] = '\0';
+    snprintf(suffix, sizeof(suffix), "/hwmon/%s", entry);
+    if (str_endswith(link, suffix))
+      link[len - strlen(suffix)] = '\0';
+
+    while (str_startswith(start, "../"))
+      start += 3;
+
+    snprintf(key, size, "%s", start);
+    return;
+  }
+
+  /* Plain directory (not a class symlink): fall back to its device link */
+  snprintf(attr, sizeof(attr), "%s/device", entry);
+  len = readlinkat(class_fd, attr, link, sizeof(link) - 1);
+  if (len > 0)
+  {
+    link[len] = '\0';
+    snprintf(key, size, "device:%s", link);
+    return;
+  }
+
+  snprintf(key, size, "entry:%s", entry);
+}
+
+static int compare_chip_key(const void *a, const void *b)
+{
+  return strcmp(((const ChipKey *) a)->key, ((const ChipKey *) b)->key);
+}
+
+/**
+ * @brief Enumerates hwmon chips and computes the set fingerprint
+ *
+ * @return 1 on success, 0 if the hwmon class cannot be read
+ */
+static int load_chip_set(ChipSet *set)
+{
+  DIR *          dir;
+  struct dirent *entry;
+  int            capacity = 0;
+  uint64_t       hash     = 1469598103934665603ULL;
+  char           version[16];
+
+  memset(set, 0, sizeof(*set));
+  set->class_fd = open_sysfs_class(HWMON_SUBDIR, set->class_path, sizeof(set->class_path));
+  if (set->class_fd < 0)
+    return 0;
+
+  dir = fdopendir(dup(set->class_fd));
+  if (!dir)
+  {
+    close(set->class_fd);
+    return 0;
+  }
+
+  while ((entry = readdir(dir)) != NULL)
+  {
+    ChipKey *chip;
+
+    if (entry->d_name[0] == '.')
+      continue;
+
+    if (set->count == capacity)
+    {
+      ChipKey *grown;
+      capacity = capacity ? capacity * 2 : 16;
+      grown    = realloc(set->chips, capacity * sizeof(ChipKey));
+      if (!grown)
+        break;
+      set->chips = grown;
+    }
+
+    chip = &set->chips[set->count++];
+    snprintf(chip->entry, sizeof(chip->entry), "%s", entry->d_name);
+    resolve_chip_key(set->class_fd, chip->entry, chip->key, sizeof(chip->key));
+  }
+  closedir(dir);
+
+  if (set->count > 1)
+    qsort(set->chips, set->count, sizeof(ChipKey), compare_chip_key);
+
+  snprintf(version, sizeof(version), "%d\n", SCAN_CACHE_VERSION);
+  hash = fnv1a(hash, version);
+  hash = fnv1a(hash, get_sysfs_root());
+  for (int i = 0; i < set->count; i++)
+  {
+    hash = fnv1a(hash, "\n");
+    hash = fnv1a(hash, set->chips[i].key);
+  }
+  set->fingerprint = hash;
+
+  return 1;
+}
+
+static void free_chip_set(ChipSet *set)
+{
+  if (set->class_fd >= 0)
+    close(set->class_fd);
+  free(set->chips);
+  set->chips = NULL;
+}
+
+static const ChipKey *find_chip_by_key(const ChipSet *set, const char *key)
+{
+  for (int i = 0; i < set->count; i++)
+  {
+    if (strcmp(set->chips[i].key, key) == 0)
+      return &set->chips[i];
+  }
+  return NULL;
+}
+
+static const ChipKey *find_chip_by_entry(const ChipSet *set, const char *entry)
+{
+  for (int i = 0; i < set->count; i++)
+  {
+    if (strcmp(set->chips[i].entry, entry) == 0)
+      return &set->chips[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Splits a line on tabs in place
+ *
+ * @return Number of fields found (at most max)
+ */
+static int split_fields(char *line, char **fields, int max)
+{
+  int n = 0;
+
+  line[strcspn(line, "\n")] = '\0';
+  while (n < max)
+  {
+    fields[n++] = line;
+    line        = strchr(line, '\t');
+    if (!line)
+      break;
+    *line++ = '\0';
+  }
+  return n;
+}
+
+/**
+ * @brief Copies a string with tabs and newlines replaced by spaces
+ */
+static void sanitize_field(char *dest, size_t size, const char *src)
+{
+  snprintf(dest, size, "%s", src);
+  for (char *p = dest; *p; p++)
+  {
+    if (*p == '\t' || *p == '\n')
+      *p = ' ';
+  }
+}
+
+
+/**
+ * @brief Restores one temperature sensor from a 'T' record
+ *
+ * Fields: T, key, attr, name, label, type, critical (millidegrees).
+ *
+ * @return 1 on success, 0 if the record is stale or malformed
+ */
+static int restore_sensor(const ChipSet *set, char **f, SensorRegistry *registry)
+{
+  const ChipKey *chip = find_chip_by_key(set, f[1]);
+  char           rel[MAX_PATH];
+  char           path[MAX_PATH * 2];
+  TempSensor *   s;
+  int            type = parse_int(f[5], SENSOR_OTHER);
+
+  /* The type indexes per-type tables; a damaged record must not */
+  if (!chip || type < 0 || type >= SENSOR_TYPE_COUNT || !(s = registry_add_sensor(registry)))
+    return 0;
+
+  snprintf(rel, sizeof(rel), "%s/%s", chip->entry, f[2]);
+  /* Past the descriptor budget the sensor is read by path; it must exist */
+  s->fd = open_sensor_attr(set->class_fd, rel);
+  if (s->fd < 0 && (errno != EMFILE || !file_exists_at(set->class_fd, rel)))
+    return 0;
+
+  snprintf(path, sizeof(path), "%s/%s", set->class_path, rel);
+  s->path          = registry_strdup(registry, path);
+  s->name          = registry_strdup(registry, f[3]);
+  s->label         = registry_strdup(registry, f[4]);
+  s->type          = (SensorType) type;
+  if (!parse_millidegrees(f[6], &s->temp_critical))
+    s->temp_critical = 90000;
+  return 1;
+}
+
+/**
+ * @brief Restores one fan from an 'F' record and re-pairs it
+ *
+ * Fields: F, key, attr, name, label, max, min, sensor index.
+ * Fan records follow all sensor records, so the paired sensor is
+ * already in the table. The current speed is read once so the
+ * registry matches a fresh scan.
+ *
+ * @return 1 on success, 0 if the record is stale or malformed
+ */
+static int restore_fan(const ChipSet *set, char **f, SensorRegistry *registry)
+{
+  const ChipKey *chip = find_chip_by_key(set, f[1]);
+  char           rel[MAX_PATH];
+  char           path[MAX_PATH * 2];
+  char           buffer[32];
+  FanSensor *    fan;
+
+  if (!chip || !(fan = registry_add_fan(registry)))
+    return 0;
+
+  snprintf(rel, sizeof(rel), "%s/%s", chip->entry, f[2]);
+  snprintf(path, sizeof(path), "%s/%s", set->class_path, rel);
+
+  fan->path    = registry_strdup(registry, path);
+  fan->name    = registry_strdup(registry, f[3]);
+  fan->label   = registry_strdup(registry, f[4]);
+  fan->max_rpm = parse_int(f[5], 5000);
+  fan->min_rpm = parse_int(f[6], 0);
+  fan->sensor  = parse_int(f[7], -1);
+  fan->active  = 1;
+
+  if (fan->sensor < -1 || fan->sensor >= registry->count)
+    return 0;
+
+  if (fan->sensor >= 0)
+  {
+    TempSensor *s = &registry->sensors[fan->sensor];
+
+    s->fan_fd = open_sensor_attr(set->class_fd, rel);
+    if (s->fan_fd >= 0 ? !read_fd(s->fan_fd, buffer, sizeof(buffer))
+                       : !read_file_at(set->class_fd, rel, buffer, sizeof(buffer)))
+      return 0;
+
+    s->has_fan     = 1;
+    s->fan         = registry->fan_count - 1;
+    s->fan_max_rpm = fan->max_rpm;
+    s->fan_path    = fan->path;
+  }
+  else if (!read_file_at(set->class_fd, rel, buffer, sizeof(buffer)))
+  {
+    return 0;
+  }
+
+  str_trim(buffer);
+  fan->speed_rpm = parse_int(buffer, 0);
+  if (fan->max_rpm > 0)
+  {
+    fan->speed_percent = (fan->speed_rpm * 100) / fan->max_rpm;
+    if (fan->speed_percent > 100)
+      fan->speed_percent = 100;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Restores the sensor table and fan registry from the cache
+ *
+ * The cache is used only when its fingerprint matches the current
+ * hwmon set and every cached attribute can be opened. On any
+ * mismatch the partially filled registry is emptied again.
+ *
+ * @param registry Empty registry to populate
+ * @return 1 if the registry was restored, 0 if a full scan is needed
+ */
+int scan_cache_load(SensorRegistry *registry)
+{
+  ChipSet            set;
+  char               path[MAX_PATH];
+  char               line[1024];
+  unsigned long long fingerprint = 0;
+  int                version     = 0;
+  int                ok          = 1;
+  FILE *             file;
+
+  if (!cache_enabled || cache_rescan || !cache_path(path, sizeof(path), 0))
+    return 0;
+
+  file = fopen(path, "r");
+  if (!file)
+    return 0;
+
+  if (!fgets(line, sizeof(line), file) ||
+      sscanf(line, SCAN_CACHE_MAGIC " %d %llx", &version, &fingerprint) != 2 ||
+      version != SCAN_CACHE_VERSION || !load_chip_set(&set))
+  {
+    fclose(file);
+    return 0;
+  }
+
+  if (set.fingerprint != fingerprint)
+  {
+    free_chip_set(&set);
+    fclose(file);
+    return 0;
+  }
+
+  while (ok && fgets(line, sizeof(line), file))
+  {
+    char *f[8];
+    int   n = split_fields(line, f, 8);
+
+    if (n == 7 && strcmp(f[0], "T") == 0)
+      ok = restore_sensor(&set, f, registry);
+    else if (n == 8 && strcmp(f[0], "F") == 0)
+      ok = restore_fan(&set, f, registry);
+    else
+      ok = 0;
+  }
+
+  free_chip_set(&set);
+  fclose(file);
+
+  if (!ok || registry->count == 0)
+  {
+    registry_free(registry);
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Resolves a sysfs path to its chip key and attribute name
+ *
+ * @return 1 if path lies directly inside a chip of the current set
+ */
+static int resolve_record(const ChipSet *set, const char *path, const char **key,
+                          const char **attr)
+{
+  size_t         len = strlen(set->class_path);
+  const char *   rest, *slash;
+  char           entry[64];
+  const ChipKey *chip;
+
+  if (strncmp(path, set->class_path, len) != 0 || path[len] != '/')
+    return 0;
+
+  rest  = path + len + 1;
+  slash = strchr(rest, '/');
+  if (!slash || (size_t) (slash - rest) >= sizeof(entry) || strchr(slash + 1, '/'))
+    return 0;
+
+  memcpy(entry, rest, slash - rest);
+  entry[slash - rest] = '\0';
+
+  chip = find_chip_by_entry(set, entry);
+  if (!chip)
+    return 0;
+
+  *key  = chip->key;
+  *attr = slash + 1;
+  return 1;
+}
+
+/**
+ * @brief Writes the sensor table and fan registry to the cache
+ *
+ * Only hwmon-backed tables are cached; thermal-zone fallbacks are
+ * cheap to rediscover. The file is replaced atomically.
+ *
+ * @param registry Registry filled by a full scan
+ */
+void scan_cache_save(const SensorRegistry *registry)
+{
+  ChipSet set;
+  char    path[MAX_PATH];
+  char    tmp_path[MAX_PATH + 16];
+  char    name[MAX_NAME_LEN], label[MAX_NAME_LEN];
+  FILE *  file;
+  int     ok = 1;
+
+  if (!cache_enabled || registry->count == 0 || !cache_path(path, sizeof(path), 1))
+    return;
+
+  if (!load_chip_set(&set))
+    return;
+
+  snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, (int) getpid());
+  file = fopen(tmp_path, "w");
+  if (!file)
+  {
+    free_chip_set(&set);
+    return;
+  }
+
+  fprintf(file, SCAN_CACHE_MAGIC " %d %llx\n", SCAN_CACHE_VERSION,
+          (unsigned long long) set.fingerprint);
+
+  for (int i = 0; i < registry->count && ok; i++)
+  {
+    const TempSensor *s = &registry->sensors[i];
+    const char *      key, *attr;
+
+    if (!(ok = resolve_record(&set, s->path, &key, &attr)))
+      break;
+
+    sanitize_field(name, sizeof(name), s->name);
+    sanitize_field(label, sizeof(label), s->label);
+    fprintf(file, "T\t%s\t%s\t%s\t%s\t%d\t%d\n", key, attr, name, label, (int) s->type,
+            (int) s->temp_critical);
+  }
+
+  for (int i = 0; i < registry->fan_count && ok; i++)
+  {
+    const FanSensor *fan = &registry->fans[i];
+    const char *     key, *attr;
+
+    if (!(ok = resolve_record(&set, fan->path, &key, &attr)))
+      break;
+
+    sanitize_field(name, sizeof(name), fan->name);
+    sanitize_field(label, sizeof(label), fan->label);
+    fprintf(file, "F\t%s\t%s\t%s\t%s\t%d\t%d\t%d\n", key, attr, name, label, fan->max_rpm,
+            fan->min_rpm, fan->sensor);
+  }
+
+  if (fclose(file) != 0)
+    ok = 0;
+
+  if (ok)
+    rename(tmp_path, path);
+  else
+    unlink(tmp_path);
+
+  free_chip_set(&set);
+}
@@ -0,0 +1,35 @@
+/**
+ * @file scancache.h
+ * @brief Temp Monitor - Persistent sensor scan cache
+ *
+ * Saves the result of sensor discovery (labels, names, types,
+ * thresholds, the fan registry and fan pairing) so later launches can skip the
+ * sysfs walk. Entries are keyed by the device each hwmon chip
+ * belongs to, not by its unstable hwmonN number.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef SCANCACHE_H
+#define SCANCACHE_H
+
+#include "sensor.h"
+
+/* Cache file name inside $XDG_CACHE_HOME/temp-monitor */
+#define SCAN_CACHE_FILE "sensors.cache"
+
+/* Bumped whenever the cache layout or classification rules change, or
+   caches written by an older version may be wrong (4: tables short of
+   chips that could not be scanned were saved) */
+#define SCAN_CACHE_VERSION 4
+
+void scan_cache_set_enabled(int enabled);
+void scan_cache_set_rescan(int rescan);
+int  scan_cache_load(SensorRegistry *registry);
+void scan_cache_save(const SensorRegistry *registry);
+
+#endif
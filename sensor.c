@@ -15,45 +15,158 @@
 
 #include "sensor.h"
 
+#include "registry.h"
+#include "scancache.h"
+#include "stats.h"
+#include "uring.h"
 #include "utils.h"
 
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
-/* Maximum safe path length for buffer operations */
-#define SAFE_PATH_LEN 256
+/* Backend used by update_all_sensors() */
+static SamplerBackend sampler_backend = SAMPLER_READ;
+
+/* Upper bound on hwmon scan worker threads */
+#define MAX_SCAN_THREADS 8
+
+/* io_uring submission queue size; larger batches are chunked */
+#define URING_ENTRIES 256
+
+/* Descriptors never used for cached sysfs attributes: kept free for
+   sockets, output files, the scan itself and uncached reads */
+#define FD_RESERVE 128
+
+/**
+ * @brief Per-read bookkeeping for one io_uring sample pass
+ */
+typedef struct
+{
+  char buffer[32]; /* Read destination */
+  int  owner;      /* Index of the sensor the read belongs to */
+  char is_fan;     /* 1 for the fan attribute, 0 for temperature */
+} UringSlot;
+
+/* sysfs descriptors held open by sensors, and the most allowed (-1 until known) */
+static atomic_int cached_fds      = 0;
+static atomic_int cached_fd_limit = -1;
+
+/* Reusable io_uring batch, grown to fit the sensor table */
+static UringRead *uring_reads    = NULL;
+static UringSlot *uring_slots    = NULL;
+static int        uring_capacity = 0;
+
+/**
+ * @brief One hwmon chip to scan and the sensors found in it
+ */
+typedef struct
+{
+  int            class_fd;       /* Descriptor of the hwmon class directory */
+  char           entry[64];      /* hwmonN entry name relative to class_fd */
+  char           path[MAX_PATH]; /* Absolute hwmon path, for sensor paths */
+  SensorRegistry found;          /* Sensors, fans and strings of this chip */
+  int            error;          /* errno if the chip could not be fully scanned, else 0 */
+} HwmonScanJob;
+
+/**
+ * @brief Work queue shared by the scan worker threads
+ */
+typedef struct
+{
+  HwmonScanJob *jobs;      /* One job per hwmon directory */
+  int           job_count; /* Number of jobs */
+  atomic_int    next;      /* Index of the next unclaimed job */
+} HwmonScanPool;
+
+/* Scan worker count, 0 for automatic */
+static int scan_threads = 0;
+
+/* hwmon chips the last scan_hwmon_sensors() could not scan fully */
+static int scan_failures = 0;
+
+/* Root of the sysfs tree all scanners read from */
+static char sysfs_root[MAX_PATH] = SYSFS_ROOT;
+
+/**
+ * @brief Sets the sysfs root used by all scanners
+ *
+ * Allows scanning a synthetic tree (see tools/gen-hwmon.sh) instead
+ * of /sys. Trailing slashes are dropped; NULL or empty restores the
+ * default.
+ *
+ * @param root Directory that contains class/hwmon, class/thermal, ...
+ */
+void set_sysfs_root(const char *root)
+{
+  size_t len;
+
+  if (!root || root[0] == '\0')
+    root = SYSFS_ROOT;
+
+  snprintf(sysfs_root, sizeof(sysfs_root), "%s", root);
+
+  len = strlen(sysfs_root);
+  while (len > 1 && sysfs_root[len - 1] == '/')
+    sysfs_root[--len] = '\0';
+}
+
+/**
+ * @brief Gets the sysfs root used by all scanners
+ */
+const char *get_sysfs_root(void)
+{
+  return sysfs_root;
+}
 
 /**
- * @brief Gets the sensor chip name from hwmon path
+ * @brief Opens a sysfs class directory under the sysfs root
+ *
+ * @param subdir Class directory relative to the sysfs root
+ * @param path Output buffer for the absolute path, used to build
+ *             sensor paths for later reopening
+ * @param size Size of path buffer
+ * @return Directory descriptor, or -1 on failure
+ */
+int open_sysfs_class(const char *subdir, char *path, size_t size)
+{
+  int root_fd, class_fd;
+
+  path_join(path, size, sysfs_root, subdir);
+
+  root_fd = open_dir_at(AT_FDCWD, sysfs_root);
+  if (root_fd < 0)
+    return -1;
+
+  class_fd = open_dir_at(root_fd, subdir);
+  close(root_fd);
+
+  return class_fd;
+}
+
+/**
+ * @brief Gets the sensor chip name from an hwmon directory
  *
  * Reads the 'name' file in the hwmon directory to get
  * the driver/chip name (e.g., coretemp, k10temp, nvme).
  *
- * @param hwmon_path Path to hwmon directory
+ * @param hwmon_fd Descriptor of the hwmon directory
  * @param name Output buffer for sensor name
  * @param size Size of output buffer
  */
-static void get_sensor_name(const char *hwmon_path, char *name, size_t size)
+static void get_sensor_name(int hwmon_fd, char *name, size_t size)
 {
-  char   path[MAX_PATH];
-  size_t hwmon_len = strlen(hwmon_path);
-
-  if (hwmon_len > SAFE_PATH_LEN)
-  {
-    strncpy(name, "Unknown", size - 1);
-    name[size - 1] = '\0';
-    return;
-  }
-
-  snprintf(path, sizeof(path), "%s/name", hwmon_path);
-
-  if (!read_file(path, name, size))
+  if (!read_file_at(hwmon_fd, "name", name, size))
   {
-    strncpy(name, "Unknown", size - 1);
-    name[size - 1] = '\0';
+    snprintf(name, size, "Unknown");
     return;
   }
 
@@ -66,22 +179,15 @@ static void get_sensor_name(const char *hwmon_path, char *name, size_t size)
  * Reads the tempX_label file if available, otherwise generates
  * a generic label based on the sensor number.
  *
- * @param base_path Path to hwmon directory
+ * @param hwmon_fd Descriptor of the hwmon directory
  * @param temp_file Temperature input filename (e.g., temp1_input)
  * @param label Output buffer for label
  * @param size Size of output buffer
  */
-static void get_sensor_label(const char *base_path, const char *temp_file, char *label, size_t size)
+static void get_sensor_label(int hwmon_fd, const char *temp_file, char *label, size_t size)
 {
-  char   path[MAX_PATH];
-  char   temp_num[16];
-  size_t base_len = strlen(base_path);
-
-  if (base_len > SAFE_PATH_LEN)
-  {
-    snprintf(label, size, "Sensor");
-    return;
-  }
+  char attr[32];
+  char temp_num[16];
 
   if (sscanf(temp_file, "temp%15[^_]", temp_num) != 1)
   {
@@ -89,9 +195,9 @@ static void get_sensor_label(const char *base_path, const char *temp_file, char
     return;
   }
 
-  snprintf(path, sizeof(path), "%s/temp%s_label", base_path, temp_num);
+  snprintf(attr, sizeof(attr), "temp%s_label", temp_num);
 
-  if (!read_file(path, label, size))
+  if (!read_file_at(hwmon_fd, attr, label, size))
   {
     snprintf(label, size, "Sensor %s", temp_num);
     return;
@@ -106,49 +212,68 @@ static void get_sensor_label(const char *base_path, const char *temp_file, char
  * Reads tempX_crit or tempX_max to determine the critical
  * temperature threshold. Defaults to 90C if not available.
  *
- * @param base_path Path to hwmon directory
+ * @param hwmon_fd Descriptor of the hwmon directory
  * @param temp_file Temperature input filename
- * @return Critical temperature in Celsius
+ * @return Critical temperature in millidegrees Celsius
  */
-static double get_critical_temp(const char *base_path, const char *temp_file)
+static int32_t get_critical_temp(int hwmon_fd, const char *temp_file)
 {
-  char   path[MAX_PATH];
-  char   temp_num[16];
-  char   buffer[32];
-  double crit_temp;
-  size_t base_len = strlen(base_path);
-
-  if (base_len > SAFE_PATH_LEN)
-  {
-    return 90.0;
-  }
+  char    attr[32];
+  char    temp_num[16];
+  char    buffer[32];
+  int32_t crit_temp;
 
   if (sscanf(temp_file, "temp%15[^_]", temp_num) != 1)
   {
-    return 90.0;
+    return 90000;
   }
 
-  snprintf(path, sizeof(path), "%s/temp%s_crit", base_path, temp_num);
+  snprintf(attr, sizeof(attr), "temp%s_crit", temp_num);
 
-  if (!read_file(path, buffer, sizeof(buffer)))
+  if (!read_file_at(hwmon_fd, attr, buffer, sizeof(buffer)))
   {
-    snprintf(path, sizeof(path), "%s/temp%s_max", base_path, temp_num);
-    if (!read_file(path, buffer, sizeof(buffer)))
+    snprintf(attr, sizeof(attr), "temp%s_max", temp_num);
+    if (!read_file_at(hwmon_fd, attr, buffer, sizeof(buffer)))
     {
-      return 90.0;
+      return 90000;
     }
   }
 
-  crit_temp = parse_double(buffer, 90000.0) / 1000.0;
+  if (!parse_millidegrees(buffer, &crit_temp))
+    crit_temp = 90000;
 
-  if (crit_temp < 50.0)
-    crit_temp = 50.0;
-  if (crit_temp > 150.0)
-    crit_temp = 100.0;
+  if (crit_temp < 50000)
+    crit_temp = 50000;
+  if (crit_temp > 150000)
+    crit_temp = 100000;
 
   return crit_temp;
 }
 
+/**
+ * @brief qsort() comparator ordering sensors by natural path order
+ */
+static int compare_sensor_path(const void *a, const void *b)
+{
+  return str_natcmp(((const TempSensor *) a)->path, ((const TempSensor *) b)->path);
+}
+
+/**
+ * @brief qsort() comparator ordering fans by natural path order
+ */
+static int compare_fan_path(const void *a, const void *b)
+{
+  return str_natcmp(((const FanSensor *) a)->path, ((const FanSensor *) b)->path);
+}
+
+/**
+ * @brief qsort() comparator ordering scan jobs by natural path order
+ */
+static int compare_job_path(const void *a, const void *b)
+{
+  return str_natcmp(((const HwmonScanJob *) a)->path, ((const HwmonScanJob *) b)->path);
+}
+
 /**
  * @brief Detects the type of sensor based on name and label
  *
@@ -230,77 +355,197 @@ SensorType detect_sensor_type(const char *name, const char *label, const char *p
 }
 
 /**
- * @brief Reads temperature value from sysfs file
+ * @brief Parses a raw sysfs temperature buffer
  *
- * Reads the raw millidegree value and converts to Celsius.
- * Returns -999.0 on read failure.
+ * @param buffer NUL-terminated sysfs contents
+ * @return Temperature in millidegrees Celsius, or TEMP_INVALID on parse failure
+ */
+static int32_t parse_temperature(const char *buffer)
+{
+  int32_t temp_milli;
+
+  if (!parse_millidegrees(buffer, &temp_milli) || temp_milli == TEMP_INVALID)
+  {
+    return TEMP_INVALID;
+  }
+
+  return temp_milli;
+}
+
+/**
+ * @brief Number of sysfs descriptors sensors may keep open
  *
- * @param path Full path to temperature input file
- * @return Temperature in Celsius, or -999.0 on error
+ * The RLIMIT_NOFILE soft limit (see raise_fd_limit()) less
+ * FD_RESERVE, read on first use.
  */
-double read_temperature(const char *path)
+static int cached_fd_budget(void)
 {
-  char buffer[32];
-  if (!read_file(path, buffer, sizeof(buffer)))
+  int           limit = atomic_load(&cached_fd_limit);
+  struct rlimit rl;
+
+  if (limit >= 0)
+    return limit;
+
+  limit = INT_MAX;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY &&
+      rl.rlim_cur < (rlim_t) INT_MAX)
+    limit = rl.rlim_cur > FD_RESERVE ? (int) rl.rlim_cur - FD_RESERVE : 0;
+
+  atomic_store(&cached_fd_limit, limit);
+  return limit;
+}
+
+/**
+ * @brief Opens a sysfs attribute to keep open for per-tick reads
+ *
+ * Thread-safe; scan workers call it concurrently. Once the descriptor
+ * budget is used up it fails with EMFILE without opening anything,
+ * and the attribute is read with open+read+close on every tick.
+ *
+ * @param dirfd Directory descriptor (or AT_FDCWD)
+ * @param name Path relative to dirfd
+ * @return File descriptor, or -1 on failure (errno is set)
+ */
+int open_sensor_attr(int dirfd, const char *name)
+{
+  int fd;
+
+  if (atomic_fetch_add(&cached_fds, 1) >= cached_fd_budget())
   {
-    return -999.0;
+    atomic_fetch_sub(&cached_fds, 1);
+    errno = EMFILE;
+    return -1;
   }
 
-  long temp_milli = strtol(buffer, NULL, 10);
-  if (temp_milli == 0 && buffer[0] != '0')
+  fd = open_readonly_at(dirfd, name);
+  if (fd < 0)
+    atomic_fetch_sub(&cached_fds, 1);
+  return fd;
+}
+
+/**
+ * @brief Closes a descriptor opened by open_sensor_attr()
+ *
+ * @param fd Pointer to the descriptor, set to -1
+ */
+static void close_sensor_attr(int *fd)
+{
+  if (*fd >= 0)
   {
-    return -999.0;
+    close(*fd);
+    atomic_fetch_sub(&cached_fds, 1);
   }
+  *fd = -1;
+}
+
+/**
+ * @brief Reads a sysfs attribute through a cached descriptor
+ *
+ * Opens the descriptor lazily and re-reads it with pread(). If the
+ * device behind it went away (ENODEV/ESTALE, e.g. after a driver
+ * rebind) the descriptor is reopened once from the path. Without a
+ * descriptor to spare, the attribute is read from its path instead.
+ *
+ * @param fd Pointer to cached descriptor, -1 if not open
+ * @param path Sysfs path used to (re)open the descriptor
+ * @param buffer Output buffer
+ * @param size Size of output buffer
+ * @return 1 on success, 0 on failure
+ */
+static int read_cached_attr(int *fd, const char *path, char *buffer, size_t size)
+{
+  if (*fd >= 0)
+  {
+    if (read_fd(*fd, buffer, size))
+      return 1;
 
-  return (double) temp_milli / 1000.0;
+    if (errno != ENODEV && errno != ESTALE && errno != EBADF)
+      return 0;
+
+    close_sensor_attr(fd);
+  }
+
+  *fd = open_sensor_attr(AT_FDCWD, path);
+  if (*fd < 0)
+    return (errno == EMFILE || errno == ENFILE) && read_file(path, buffer, size);
+
+  return read_fd(*fd, buffer, size);
 }
 
 /**
- * @brief Reads fan speed from sysfs file
+ * @brief Reads a sensor's temperature through its cached descriptor
  *
- * @param path Full path to fan input file
+ * @param sensor Sensor to read
+ * @return Temperature in millidegrees Celsius, or TEMP_INVALID on error
+ */
+int32_t read_sensor_temperature(TempSensor *sensor)
+{
+  char buffer[32];
+  if (!read_cached_attr(&sensor->fd, sensor->path, buffer, sizeof(buffer)))
+  {
+    return TEMP_INVALID;
+  }
+
+  return parse_temperature(buffer);
+}
+
+/**
+ * @brief Reads a sensor's fan speed through its cached descriptor
+ *
+ * @param sensor Sensor with associated fan
  * @return Fan speed in RPM, or -1 on error
  */
-int read_fan_speed(const char *path)
+int read_sensor_fan_speed(TempSensor *sensor)
 {
   char buffer[32];
-  if (!read_file(path, buffer, sizeof(buffer)))
+  if (!read_cached_attr(&sensor->fan_fd, sensor->fan_path, buffer, sizeof(buffer)))
   {
     return -1;
   }
 
+  str_trim(buffer);
   return parse_int(buffer, -1);
 }
 
+/**
+ * @brief Closes all cached sensor descriptors
+ *
+ * @param sensors Array of sensors
+ * @param count Number of sensors
+ */
+void close_sensor_files(TempSensor *sensors, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    close_sensor_attr(&sensors[i].fd);
+    close_sensor_attr(&sensors[i].fan_fd);
+  }
+}
+
 /**
  * @brief Gets the maximum RPM value for a fan
  *
  * Reads fanX_max or pwmX_max to determine the maximum
  * fan speed for percentage calculations.
  *
- * @param hwmon_path Path to hwmon directory
+ * @param hwmon_fd Descriptor of the hwmon directory
  * @param fan_num Fan number string
  * @return Maximum RPM value
  */
-int read_fan_max(const char *hwmon_path, const char *fan_num)
+int read_fan_max(int hwmon_fd, const char *fan_num)
 {
-  char   path[MAX_PATH];
-  char   buffer[32];
-  size_t hwmon_len = strlen(hwmon_path);
-
-  if (hwmon_len > SAFE_PATH_LEN)
-  {
-    return 5000;
-  }
+  char attr[32];
+  char buffer[32];
 
-  snprintf(path, sizeof(path), "%s/fan%s_max", hwmon_path, fan_num);
-  if (read_file(path, buffer, sizeof(buffer)))
+  snprintf(attr, sizeof(attr), "fan%s_max", fan_num);
+  if (read_file_at(hwmon_fd, attr, buffer, sizeof(buffer)))
   {
+    str_trim(buffer);
     return parse_int(buffer, 5000);
   }
 
-  snprintf(path, sizeof(path), "%s/pwm%s_max", hwmon_path, fan_num);
-  if (read_file(path, buffer, sizeof(buffer)))
+  snprintf(attr, sizeof(attr), "pwm%s_max", fan_num);
+  if (file_exists_at(hwmon_fd, attr))
   {
     return 255;
   }
@@ -311,63 +556,126 @@ int read_fan_max(const char *hwmon_path, const char *fan_num)
 /**
  * @brief Determines sensor status based on temperature
  *
- * @param temp Current temperature in Celsius
- * @param critical Critical temperature threshold
+ * @param temp Current temperature in millidegrees Celsius
+ * @param critical Critical temperature threshold in millidegrees
  * @return SensorStatus enumeration value
  */
-SensorStatus get_sensor_status(double temp, double critical)
+SensorStatus get_sensor_status(int32_t temp, int32_t critical)
 {
   if (temp < 0)
     return STATUS_ERROR;
   if (temp >= critical)
     return STATUS_CRITICAL;
-  if (temp >= critical * 0.85)
+  if ((int64_t) temp * 100 >= (int64_t) critical * 85)
     return STATUS_WARN;
   return STATUS_OK;
 }
 
 /**
- * @brief Updates a sensor's current temperature and statistics
+ * @brief Clamps a histogram estimate to the observed range
  *
- * Reads the current temperature and updates min/max/average
- * statistics. Also updates associated fan data if present.
+ * Edge bins collect outliers and a bin centre can lie outside the
+ * samples that fell into it; neither may report a value the sensor
+ * never produced.
+ */
+static int32_t clamp_observed(const SensorSnapshot *snapshot, int i, int32_t value)
+{
+  if (value < snapshot->temp_min[i])
+    return snapshot->temp_min[i];
+  if (value > snapshot->temp_max[i])
+    return snapshot->temp_max[i];
+  return value;
+}
+
+/**
+ * @brief Applies a temperature sample to a sensor's running state
  *
- * @param sensor Pointer to sensor structure to update
+ * @param sensor Sensor metadata (critical threshold)
+ * @param snapshot Running state to update
+ * @param i Sensor index
+ * @param temp Temperature in millidegrees, or TEMP_INVALID on read failure
+ * @return 1 if the sample was valid, 0 otherwise
  */
-void update_sensor_data(TempSensor *sensor)
+static int apply_temperature(const TempSensor *sensor, SensorSnapshot *snapshot, int i,
+                             int32_t temp)
 {
-  double temp = read_temperature(sensor->path);
+  long n;
 
-  if (temp < -500)
+  if (temp == TEMP_INVALID)
   {
-    sensor->active = 0;
-    return;
+    snapshot->temp_current[i] = TEMP_INVALID;
+    snapshot->status[i]       = STATUS_ERROR;
+    snapshot->active[i]       = 0;
+    return 0;
   }
 
-  sensor->temp_current = temp;
-  sensor->active       = 1;
-  sensor->read_count++;
+  n = ++snapshot->read_count[i];
 
-  if (sensor->read_count == 1)
+  snapshot->temp_current[i] = temp;
+  snapshot->active[i]       = 1;
+
+  welford_add(&snapshot->temp_mean[i], &snapshot->temp_m2[i], n, temp);
+
+  if (temp > snapshot->temp_max[i])
+    snapshot->temp_max[i] = temp;
+  if (temp < snapshot->temp_min[i])
+    snapshot->temp_min[i] = temp;
+
+  if (snapshot->histograms)
   {
-    sensor->temp_max = temp;
-    sensor->temp_min = temp;
-    sensor->temp_avg = temp;
+    TempHistogram *hist = &snapshot->histograms[i];
+
+    histogram_add(hist, temp);
+    snapshot->temp_p50[i] = clamp_observed(snapshot, i, histogram_quantile(hist, QUANTILE_P50));
+    snapshot->temp_p95[i] = clamp_observed(snapshot, i, histogram_quantile(hist, QUANTILE_P95));
+    snapshot->temp_p99[i] = clamp_observed(snapshot, i, histogram_quantile(hist, QUANTILE_P99));
   }
-  else
+
+  snapshot->status[i] = get_sensor_status(temp, sensor->temp_critical);
+  return 1;
+}
+
+/**
+ * @brief Applies a fan speed sample and derives the percentage
+ *
+ * @param sensor Sensor with associated fan
+ * @param snapshot Running state to update
+ * @param i Sensor index
+ * @param rpm Fan speed in RPM, or -1 on read failure
+ */
+static void apply_fan_speed(const TempSensor *sensor, SensorSnapshot *snapshot, int i, int rpm)
+{
+  int percent = 0;
+
+  if (rpm > 0 && sensor->fan_max_rpm > 0)
   {
-    if (temp > sensor->temp_max)
-      sensor->temp_max = temp;
-    if (temp < sensor->temp_min)
-      sensor->temp_min = temp;
-    sensor->temp_avg = (sensor->temp_avg * (sensor->read_count - 1) + temp) / sensor->read_count;
+    percent = (rpm * 100) / sensor->fan_max_rpm;
+    if (percent > 100)
+      percent = 100;
   }
 
-  sensor->status = get_sensor_status(temp, sensor->temp_critical);
+  snapshot->fan_rpm[i]     = rpm;
+  snapshot->fan_percent[i] = (unsigned char) percent;
+}
+
+/**
+ * @brief Updates a sensor's current temperature and statistics
+ *
+ * Reads the current temperature and updates min/max/average
+ * statistics. Also updates associated fan data if present.
+ *
+ * @param sensor Sensor to read
+ * @param snapshot Running state to update
+ * @param index Index of sensor in the table
+ */
+void update_sensor_data(TempSensor *sensor, SensorSnapshot *snapshot, int index)
+{
+  if (!apply_temperature(sensor, snapshot, index, read_sensor_temperature(sensor)))
+    return;
 
   if (sensor->has_fan && sensor->fan_path[0] != '\0')
   {
-    update_fan_data(sensor);
+    update_fan_data(sensor, snapshot, index);
   }
 }
 
@@ -376,253 +684,792 @@ void update_sensor_data(TempSensor *sensor)
  *
  * Reads current fan RPM and calculates percentage.
  *
- * @param sensor Pointer to sensor with fan data
+ * @param sensor Sensor with fan data
+ * @param snapshot Running state to update
+ * @param index Index of sensor in the table
  */
-void update_fan_data(TempSensor *sensor)
+void update_fan_data(TempSensor *sensor, SensorSnapshot *snapshot, int index)
 {
   if (!sensor->has_fan || sensor->fan_path[0] == '\0')
   {
     return;
   }
 
-  sensor->fan_speed_rpm = read_fan_speed(sensor->fan_path);
+  apply_fan_speed(sensor, snapshot, index, read_sensor_fan_speed(sensor));
+}
 
-  if (sensor->fan_speed_rpm > 0 && sensor->fan_max_rpm > 0)
+/**
+ * @brief Selects the backend used by update_all_sensors()
+ *
+ * Selecting SAMPLER_READ releases the io_uring instance, if any.
+ *
+ * @param backend Requested backend
+ * @return Backend actually in use (falls back to SAMPLER_READ)
+ */
+SamplerBackend set_sampler_backend(SamplerBackend backend)
+{
+  sampler_backend = SAMPLER_READ;
+
+  if (backend == SAMPLER_IO_URING && uring_init(URING_ENTRIES))
   {
-    sensor->fan_speed_percent = (sensor->fan_speed_rpm * 100) / sensor->fan_max_rpm;
-    if (sensor->fan_speed_percent > 100)
-      sensor->fan_speed_percent = 100;
+    sampler_backend = SAMPLER_IO_URING;
   }
   else
   {
-    sensor->fan_speed_percent = 0;
+    uring_cleanup();
+    free(uring_reads);
+    free(uring_slots);
+    uring_reads    = NULL;
+    uring_slots    = NULL;
+    uring_capacity = 0;
   }
+
+  return sampler_backend;
 }
 
-static int scan_fans_for_hwmon(const char *hwmon_path, TempSensor *sensors, int sensor_count)
+/**
+ * @brief Samples every sensor through one io_uring batch
+ *
+ * Queues the temperature and fan reads of all sensors, waits for
+ * all completions and only then applies the results. Attributes
+ * whose descriptor is closed or whose read failed go through the
+ * plain read path so the reopen logic still applies.
+ *
+ * @return 1 on success, 0 if the caller must fall back
+ */
+static int update_all_sensors_uring(TempSensor *sensors, int count, SensorSnapshot *snapshot)
 {
-  DIR *          dir;
-  struct dirent *entry;
-  int            fans_found = 0;
-  size_t         hwmon_len  = strlen(hwmon_path);
+  UringRead *reads;
+  UringSlot *slots;
+  int        n = 0;
 
-  if (hwmon_len > SAFE_PATH_LEN)
+  if (uring_capacity < 2 * count)
   {
-    return 0;
+    UringRead *grown_reads = realloc(uring_reads, 2 * count * sizeof(UringRead));
+    UringSlot *grown_slots;
+
+    if (!grown_reads)
+      return 0;
+    uring_reads = grown_reads;
+
+    grown_slots = realloc(uring_slots, 2 * count * sizeof(UringSlot));
+    if (!grown_slots)
+      return 0;
+    uring_slots    = grown_slots;
+    uring_capacity = 2 * count;
   }
 
-  dir = opendir(hwmon_path);
-  if (!dir)
-    return 0;
+  reads = uring_reads;
+  slots = uring_slots;
 
-  while ((entry = readdir(dir)) != NULL)
+  for (int i = 0; i < count; i++)
   {
-    char fan_num[8];
-    char fan_path[MAX_PATH];
-    int  fan_rpm;
-    int  fan_max;
-    int  i;
+    TempSensor *s = &sensors[i];
 
-    if (!str_contains(entry->d_name, "fan") || !str_endswith(entry->d_name, "_input"))
+    if (s->fd >= 0)
     {
-      continue;
+      reads[n] = (UringRead) {
+          .fd = s->fd, .buffer = slots[n].buffer, .size = sizeof(slots[n].buffer)};
+      slots[n].owner  = i;
+      slots[n].is_fan = 0;
+      n++;
     }
 
-    if (sscanf(entry->d_name, "fan%7[^_]", fan_num) != 1)
+    if (s->has_fan && s->fan_fd >= 0)
     {
-      continue;
+      reads[n] = (UringRead) {
+          .fd = s->fan_fd, .buffer = slots[n].buffer, .size = sizeof(slots[n].buffer)};
+      slots[n].owner  = i;
+      slots[n].is_fan = 1;
+      n++;
     }
+  }
 
-    snprintf(fan_path, sizeof(fan_path), "%s/%s", hwmon_path, entry->d_name);
+  if (n > 0 && !uring_read_batch(reads, n))
+    return 0;
 
-    fan_rpm = read_fan_speed(fan_path);
-    if (fan_rpm < 0)
-      continue;
+  /* Temperatures first so a failed sensor skips its fan update */
+  for (int i = 0, r = 0; i < count; i++)
+  {
+    TempSensor *s = &sensors[i];
 
-    fan_max = read_fan_max(hwmon_path, fan_num);
+    if (r < n && slots[r].owner == i && !slots[r].is_fan)
+    {
+      if (reads[r].result > 0)
+        apply_temperature(s, snapshot, i, parse_temperature(reads[r].buffer));
+      else
+        apply_temperature(s, snapshot, i, read_sensor_temperature(s));
+      r++;
+    }
+    else
+    {
+      apply_temperature(s, snapshot, i, read_sensor_temperature(s));
+    }
 
-    for (i = 0; i < sensor_count; i++)
+    if (r < n && slots[r].owner == i && slots[r].is_fan)
     {
-      if (str_contains(sensors[i].path, hwmon_path) && !sensors[i].has_fan)
+      if (snapshot->active[i])
       {
-        sensors[i].has_fan = 1;
-        memset(sensors[i].fan_path, 0, sizeof(sensors[i].fan_path));
-        snprintf(sensors[i].fan_path, sizeof(sensors[i].fan_path), "%s", fan_path);
-        sensors[i].fan_max_rpm   = fan_max;
-        sensors[i].fan_speed_rpm = fan_rpm;
-        if (fan_max > 0)
+        if (reads[r].result > 0)
         {
-          sensors[i].fan_speed_percent = (fan_rpm * 100) / fan_max;
+          str_trim(reads[r].buffer);
+          apply_fan_speed(s, snapshot, i, parse_int(reads[r].buffer, -1));
+        }
+        else
+        {
+          update_fan_data(s, snapshot, i);
         }
-        fans_found++;
-        break;
       }
+      r++;
+    }
+    else if (snapshot->active[i] && s->has_fan && s->fan_path[0] != '\0')
+    {
+      update_fan_data(s, snapshot, i);
     }
   }
 
-  closedir(dir);
-  return fans_found;
+  return 1;
 }
 
-int scan_fan_sensors(TempSensor *sensors, int count)
+/**
+ * @brief Samples all sensors for one tick
+ *
+ * Uses the io_uring batch backend when selected, otherwise reads
+ * each sensor in turn through its cached descriptor. Sensors that
+ * failed earlier are retried so they come back once readable.
+ *
+ * @param sensors Array of sensors
+ * @param count Number of sensors
+ * @param snapshot Running state, at least count entries
+ */
+void update_all_sensors(TempSensor *sensors, int count, SensorSnapshot *snapshot)
 {
-  DIR *          dir;
-  struct dirent *entry;
-  int            total_fans = 0;
+  if (sampler_backend == SAMPLER_IO_URING)
+  {
+    if (update_all_sensors_uring(sensors, count, snapshot))
+      return;
 
-  dir = opendir(HWMON_PATH);
-  if (!dir)
+    /* Ring is in an unknown state; stay on the read path from now on */
+    uring_cleanup();
+    sampler_backend = SAMPLER_READ;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    update_sensor_data(&sensors[i], snapshot, i);
+  }
+}
+
+/**
+ * @brief Runs one sample pass and captures it as a snapshot
+ *
+ * All sysfs reads for the tick happen here, before any output is
+ * formatted. Values are written straight into the snapshot's
+ * arrays; consumers only look at the snapshot.
+ *
+ * @param sensors Array of sensors
+ * @param count Number of sensors
+ * @param snapshot Snapshot sized by snapshot_init() and carried over
+ *                 from the previous pass; tick is advanced by one
+ */
+void sample_sensors(TempSensor *sensors, int count, SensorSnapshot *snapshot)
+{
+  if (count > snapshot->capacity)
+    count = snapshot->capacity;
+
+  update_all_sensors(sensors, count, snapshot);
+
+  snapshot->tick++;
+  snapshot->timestamp_ms = get_time_ms();
+  snapshot->count        = count;
+}
+
+/**
+ * @brief Captures recorded readings as a snapshot
+ *
+ * The --replay counterpart of sample_sensors(): recorded values take
+ * the place of the sysfs reads and go through the same bookkeeping,
+ * so statistics, status and fan percentages come out as they would
+ * have live. The recorded tick is kept, so gaps in the recording show
+ * up as gaps in the history.
+ *
+ * @param sensors Sensor table the recording was made with
+ * @param count Number of sensors
+ * @param temps Recorded temperatures, TEMP_INVALID for failed reads
+ * @param fans Recorded fan speeds
+ * @param tick Recorded tick
+ * @param timestamp_ms Recorded wall clock
+ * @param snapshot Snapshot carried over from the previous frame
+ */
+void replay_sensors(const TempSensor *sensors, int count, const int32_t *temps,
+                    const int32_t *fans, unsigned long tick, long long timestamp_ms,
+                    SensorSnapshot *snapshot)
+{
+  if (count > snapshot->capacity)
+    count = snapshot->capacity;
+
+  for (int i = 0; i < count; i++)
+  {
+    if (apply_temperature(&sensors[i], snapshot, i, temps[i]) && sensors[i].has_fan)
+      apply_fan_speed(&sensors[i], snapshot, i, fans[i]);
+  }
+
+  snapshot->tick         = tick;
+  snapshot->timestamp_ms = timestamp_ms;
+  snapshot->count        = count;
+}
+
+/**
+ * @brief Allocates a snapshot with room for count sensors
+ *
+ * All arrays share one allocation, widest element type first so
+ * every array stays naturally aligned. Sensors start active with
+ * no readings.
+ *
+ * @param snapshot Snapshot to initialize
+ * @param count Number of sensors the snapshot must hold
+ * @return 1 on success, 0 if out of memory
+ */
+int snapshot_init(SensorSnapshot *snapshot, int count)
+{
+  size_t n = count > 0 ? (size_t) count : 0;
+  char * block;
+
+  memset(snapshot, 0, sizeof(*snapshot));
+
+  if (n == 0)
+    return 1;
+
+  /* Widest element type first so every array stays aligned */
+  block = calloc(n, 2 * sizeof(double) + sizeof(long) + 6 * sizeof(int32_t) + sizeof(int) + 3);
+  if (!block)
     return 0;
 
-  while ((entry = readdir(dir)) != NULL)
+  snapshot->temp_mean    = (double *) block;
+  snapshot->temp_m2      = snapshot->temp_mean + n;
+  snapshot->read_count   = (long *) (snapshot->temp_m2 + n);
+  snapshot->temp_current = (int32_t *) (snapshot->read_count + n);
+  snapshot->temp_min     = snapshot->temp_current + n;
+  snapshot->temp_max     = snapshot->temp_min + n;
+  snapshot->temp_p50     = snapshot->temp_max + n;
+  snapshot->temp_p95     = snapshot->temp_p50 + n;
+  snapshot->temp_p99     = snapshot->temp_p95 + n;
+  snapshot->fan_rpm      = (int *) (snapshot->temp_p99 + n);
+  snapshot->fan_percent  = (unsigned char *) (snapshot->fan_rpm + n);
+  snapshot->status       = snapshot->fan_percent + n;
+  snapshot->active       = snapshot->status + n;
+  snapshot->capacity     = count;
+
+  snapshot_reset_stats(snapshot);
+
+  for (size_t i = 0; i < n; i++)
+    snapshot->active[i] = 1;
+
+  return 1;
+}
+
+/**
+ * @brief Gives a snapshot per-sensor quantile histograms
+ *
+ * Only the sampler's running snapshot needs them; at roughly 660
+ * bytes per sensor they are deliberately left out of the arrays that
+ * snapshot_copy() publishes every tick.
+ *
+ * @param snapshot Snapshot initialized with snapshot_init()
+ * @return 1 on success, 0 if out of memory
+ */
+int snapshot_enable_histograms(SensorSnapshot *snapshot)
+{
+  if (snapshot->histograms || snapshot->capacity == 0)
+    return 1;
+
+  snapshot->histograms = calloc((size_t) snapshot->capacity, sizeof(TempHistogram));
+  return snapshot->histograms != NULL;
+}
+
+/**
+ * @brief Starts the per-sensor statistics over
+ *
+ * Clears read counts, min/max, Welford accumulators, quantiles and
+ * histograms. Current readings, status and fan data are kept.
+ *
+ * @param snapshot Snapshot to reset
+ */
+void snapshot_reset_stats(SensorSnapshot *snapshot)
+{
+  for (int i = 0; i < snapshot->capacity; i++)
   {
-    char hwmon_path[MAX_PATH];
+    snapshot->temp_mean[i]  = 0.0;
+    snapshot->temp_m2[i]    = 0.0;
+    snapshot->read_count[i] = 0;
+    snapshot->temp_min[i]   = INT32_MAX;
+    snapshot->temp_max[i]   = INT32_MIN;
+    snapshot->temp_p50[i]   = TEMP_INVALID;
+    snapshot->temp_p95[i]   = TEMP_INVALID;
+    snapshot->temp_p99[i]   = TEMP_INVALID;
+
+    if (snapshot->histograms)
+      histogram_reset(&snapshot->histograms[i]);
+  }
+}
 
-    if (entry->d_name[0] == '.')
+/**
+ * @brief Copies a snapshot into one of at least the same capacity
+ *
+ * Only the valid entries of each array are copied; histograms stay
+ * with the source.
+ */
+void snapshot_copy(SensorSnapshot *dest, const SensorSnapshot *src)
+{
+  size_t n = (size_t) (src->count < dest->capacity ? src->count : dest->capacity);
+
+  dest->tick         = src->tick;
+  dest->timestamp_ms = src->timestamp_ms;
+  dest->count        = (int) n;
+
+  memcpy(dest->temp_mean, src->temp_mean, n * sizeof(double));
+  memcpy(dest->temp_m2, src->temp_m2, n * sizeof(double));
+  memcpy(dest->read_count, src->read_count, n * sizeof(long));
+  memcpy(dest->temp_current, src->temp_current, n * sizeof(int32_t));
+  memcpy(dest->temp_min, src->temp_min, n * sizeof(int32_t));
+  memcpy(dest->temp_max, src->temp_max, n * sizeof(int32_t));
+  memcpy(dest->temp_p50, src->temp_p50, n * sizeof(int32_t));
+  memcpy(dest->temp_p95, src->temp_p95, n * sizeof(int32_t));
+  memcpy(dest->temp_p99, src->temp_p99, n * sizeof(int32_t));
+  memcpy(dest->fan_rpm, src->fan_rpm, n * sizeof(int));
+  memcpy(dest->fan_percent, src->fan_percent, n);
+  memcpy(dest->status, src->status, n);
+  memcpy(dest->active, src->active, n);
+}
+
+/**
+ * @brief Releases a snapshot's arrays and histograms
+ */
+void snapshot_free(SensorSnapshot *snapshot)
+{
+  free(snapshot->temp_mean);
+  free(snapshot->histograms);
+  memset(snapshot, 0, sizeof(*snapshot));
+}
+
+/**
+ * @brief Reads a fan's label, falling back to "Fan N"
+ *
+ * @param hwmon_fd Descriptor of the hwmon directory
+ * @param fan_num Fan number as a string (e.g., "1")
+ * @param label Output buffer for label
+ * @param size Size of output buffer
+ */
+static void get_fan_label(int hwmon_fd, const char *fan_num, char *label, size_t size)
+{
+  char attr[32];
+
+  snprintf(attr, sizeof(attr), "fan%s_label", fan_num);
+  if (!read_file_at(hwmon_fd, attr, label, size))
+  {
+    snprintf(label, size, "Fan %s", fan_num);
+    return;
+  }
+
+  str_trim(label);
+}
+
+/**
+ * @brief Fills a fan registry entry from a fanN_input attribute
+ *
+ * @param hwmon_fd Descriptor of the hwmon directory
+ * @param hwmon_path Absolute path of the hwmon directory
+ * @param chip_name Driver/chip name, already in the job's arena
+ * @param attr Fan input filename (e.g., fan1_input)
+ * @param registry Chip-local registry to add the fan to
+ */
+static void scan_fan_attr(int hwmon_fd, const char *hwmon_path, const char *chip_name,
+                          const char *attr, SensorRegistry *registry)
+{
+  char       buffer[MAX_NAME_LEN];
+  char       min_attr[32];
+  char       fan_num[8];
+  int        rpm;
+  FanSensor *fan;
+
+  if (sscanf(attr, "fan%7[^_]", fan_num) != 1)
+    return;
+
+  if (!read_file_at(hwmon_fd, attr, buffer, sizeof(buffer)))
+    return;
+
+  str_trim(buffer);
+  rpm = parse_int(buffer, -1);
+  if (rpm < 0)
+    return;
+
+  fan = registry_add_fan(registry);
+  if (!fan)
+    return;
+
+  fan->speed_rpm = rpm;
+  fan->name      = chip_name;
+
+  snprintf(buffer, sizeof(buffer), "%s/%s", hwmon_path, attr);
+  fan->path = registry_strdup(registry, buffer);
+
+  get_fan_label(hwmon_fd, fan_num, buffer, sizeof(buffer));
+  fan->label = registry_strdup(registry, buffer);
+
+  fan->max_rpm = read_fan_max(hwmon_fd, fan_num);
+  snprintf(min_attr, sizeof(min_attr), "fan%s_min", fan_num);
+  if (read_file_at(hwmon_fd, min_attr, buffer, sizeof(buffer)))
+  {
+    str_trim(buffer);
+    fan->min_rpm = parse_int(buffer, 0);
+  }
+
+  if (fan->max_rpm > 0)
+  {
+    fan->speed_percent = (fan->speed_rpm * 100) / fan->max_rpm;
+    if (fan->speed_percent > 100)
+      fan->speed_percent = 100;
+  }
+
+  fan->active = 1;
+}
+
+/**
+ * @brief Pairs a chip's fans with its temperature channels
+ *
+ * Both lists belong to the same chip and are sorted, so the Nth fan
+ * goes to the Nth temperature channel. Fans beyond the number of
+ * channels stay in the registry unpaired.
+ *
+ * @param job Scanned chip
+ * @param hwmon_fd Descriptor of the hwmon directory
+ */
+static void pair_chip_fans(HwmonScanJob *job, int hwmon_fd)
+{
+  SensorRegistry *found = &job->found;
+
+  for (int i = 0; i < found->fan_count && i < found->count; i++)
+  {
+    TempSensor *s     = &found->sensors[i];
+    FanSensor * fan   = &found->fans[i];
+    const char *slash = strrchr(fan->path, '/');
+
+    /* An empty path means the arena ran out while copying it */
+    if (!slash)
+      continue;
+
+    s->has_fan     = 1;
+    s->fan         = i;
+    s->fan_fd      = open_sensor_attr(hwmon_fd, slash + 1);
+    s->fan_max_rpm = fan->max_rpm;
+    s->fan_path    = fan->path;
+    fan->sensor    = i;
+  }
+}
+
+/**
+ * @brief Scans one hwmon chip directory into a private result list
+ *
+ * Runs on a scan worker thread; touches nothing but its own job.
+ * Channels and fans are sorted by attribute name (temp1, temp2, ...
+ * temp10) so the result does not depend on readdir() order. Fans are
+ * paired with channels of the same chip only.
+ *
+ * @param job Chip to scan; sensors and fans are filled in
+ */
+static void scan_hwmon_chip(HwmonScanJob *job)
+{
+  SensorRegistry *found = &job->found;
+  char            buffer[MAX_PATH];
+  const char *    sensor_name;
+  DIR *           hwmon_dir;
+  struct dirent * temp_entry;
+  int             hwmon_fd;
+
+  hwmon_fd = open_dir_at(job->class_fd, job->entry);
+  if (hwmon_fd < 0)
+  {
+    job->error = errno;
+    return;
+  }
+
+  hwmon_dir = fdopendir(hwmon_fd);
+  if (!hwmon_dir)
+  {
+    job->error = errno;
+    close(hwmon_fd);
+    return;
+  }
+
+  /* One copy of the chip name is shared by all of its channels */
+  get_sensor_name(hwmon_fd, buffer, MAX_NAME_LEN);
+  sensor_name = registry_strdup(found, buffer);
+
+  while ((temp_entry = readdir(hwmon_dir)) != NULL)
+  {
+    TempSensor *s;
+
+    if (!str_endswith(temp_entry->d_name, "_input"))
       continue;
 
-    snprintf(hwmon_path, sizeof(hwmon_path), "%s/%s", HWMON_PATH, entry->d_name);
+    if (str_startswith(temp_entry->d_name, "fan"))
+    {
+      scan_fan_attr(hwmon_fd, job->path, sensor_name, temp_entry->d_name, found);
+      continue;
+    }
 
-    if (!dir_exists(hwmon_path))
+    if (!str_contains(temp_entry->d_name, "temp"))
       continue;
 
-    total_fans += scan_fans_for_hwmon(hwmon_path, sensors, count);
+    s = registry_add_sensor(found);
+    if (!s)
+    {
+      job->error = ENOMEM;
+      break;
+    }
+
+    get_sensor_label(hwmon_fd, temp_entry->d_name, buffer, MAX_NAME_LEN);
+    s->label = registry_strdup(found, buffer);
+    s->name  = sensor_name;
+
+    snprintf(buffer, sizeof(buffer), "%s/%s", job->path, temp_entry->d_name);
+    s->path = registry_strdup(found, buffer);
+
+    s->type          = detect_sensor_type(sensor_name, s->label, s->path);
+    s->temp_critical = get_critical_temp(hwmon_fd, temp_entry->d_name);
+    s->fd            = open_sensor_attr(hwmon_fd, temp_entry->d_name);
   }
 
-  closedir(dir);
-  return total_fans;
+  if (found->count > 1)
+    qsort(found->sensors, found->count, sizeof(TempSensor), compare_sensor_path);
+  if (found->fan_count > 1)
+    qsort(found->fans, found->fan_count, sizeof(FanSensor), compare_fan_path);
+  pair_chip_fans(job, hwmon_fd);
+
+  closedir(hwmon_dir);
+}
+
+/**
+ * @brief Scan worker: pulls chip jobs until none are left
+ */
+static void *hwmon_scan_worker(void *arg)
+{
+  HwmonScanPool *pool = arg;
+  int            i;
+
+  while ((i = atomic_fetch_add(&pool->next, 1)) < pool->job_count)
+  {
+    scan_hwmon_chip(&pool->jobs[i]);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Sets the number of threads used to scan hwmon chips
+ *
+ * @param threads Worker count, 0 to size the pool automatically
+ */
+void set_scan_threads(int threads)
+{
+  scan_threads = threads < 0 ? 0 : threads;
 }
 
-int scan_hwmon_sensors(TempSensor *sensors, int *count)
+/**
+ * @brief Scans all hwmon chips for temperature sensors
+ *
+ * Each hwmon directory is scanned by a small worker pool so slow
+ * drivers overlap instead of adding up. Results are merged in
+ * natural hwmonN order, making the sensor table deterministic.
+ * Every fan is added to the fan registry, paired or not. A chip that
+ * cannot be scanned (e.g. out of descriptors) is reported on stderr
+ * and counted, so the incomplete table is not cached.
+ *
+ * @param registry Registry to append found sensors and fans to
+ * @return Number of sensors added
+ */
+int scan_hwmon_sensors(SensorRegistry *registry)
 {
   DIR *          dir;
   struct dirent *entry;
-  int            found = 0;
+  char           class_path[MAX_PATH];
+  int            class_fd;
+  HwmonScanPool  pool;
+  pthread_t      workers[MAX_SCAN_THREADS];
+  int            capacity = 0;
+  int            threads;
+  int            started = 0;
+  int            found   = 0;
+
+  scan_failures = 0;
+
+  class_fd = open_sysfs_class(HWMON_SUBDIR, class_path, sizeof(class_path));
+  if (class_fd < 0)
+    return 0;
 
-  dir = opendir(HWMON_PATH);
+  /* Keep class_fd for the workers' openat(); readdir uses a duplicate */
+  dir = fdopendir(dup(class_fd));
   if (!dir)
+  {
+    close(class_fd);
     return 0;
+  }
+
+  memset(&pool, 0, sizeof(pool));
 
-  while ((entry = readdir(dir)) != NULL && *count < MAX_SENSORS)
+  while ((entry = readdir(dir)) != NULL)
   {
-    char           hwmon_path[MAX_PATH];
-    char           sensor_name[MAX_NAME_LEN];
-    DIR *          hwmon_dir;
-    struct dirent *temp_entry;
+    HwmonScanJob *job;
 
     if (entry->d_name[0] == '.')
       continue;
 
-    snprintf(hwmon_path, sizeof(hwmon_path), "%s/%s", HWMON_PATH, entry->d_name);
+    if (pool.job_count == capacity)
+    {
+      HwmonScanJob *grown;
+      capacity = capacity ? capacity * 2 : 16;
+      grown    = realloc(pool.jobs, capacity * sizeof(HwmonScanJob));
+      if (!grown)
+      {
+        /* The chips left unlisted make this scan incomplete */
+        fprintf(stderr, COLOR_YELLOW "Warning: Stopped listing hwmon chips: %s\n" COLOR_RESET,
+                strerror(ENOMEM));
+        scan_failures++;
+        break;
+      }
+      pool.jobs = grown;
+    }
 
-    if (!dir_exists(hwmon_path))
+    if (!dir_exists_at(class_fd, entry->d_name))
       continue;
 
-    get_sensor_name(hwmon_path, sensor_name, sizeof(sensor_name));
+    job = &pool.jobs[pool.job_count];
+    memset(job, 0, sizeof(HwmonScanJob));
+    job->class_fd = class_fd;
+    snprintf(job->entry, sizeof(job->entry), "%s", entry->d_name);
+    snprintf(job->path, sizeof(job->path), "%s/%s", class_path, entry->d_name);
 
-    hwmon_dir = opendir(hwmon_path);
-    if (!hwmon_dir)
-      continue;
-
-    while ((temp_entry = readdir(hwmon_dir)) != NULL && *count < MAX_SENSORS)
-    {
-      TempSensor *s;
+    pool.job_count++;
+  }
+  closedir(dir);
 
-      if (!str_contains(temp_entry->d_name, "temp") || !str_endswith(temp_entry->d_name, "_input"))
-      {
-        continue;
-      }
+  if (pool.job_count == 0)
+  {
+    free(pool.jobs);
+    close(class_fd);
+    return 0;
+  }
 
-      s = &sensors[*count];
-      memset(s, 0, sizeof(TempSensor));
+  qsort(pool.jobs, pool.job_count, sizeof(HwmonScanJob), compare_job_path);
 
-      get_sensor_label(hwmon_path, temp_entry->d_name, s->label, sizeof(s->label));
+  /* Slow drivers block in the kernel, so overlap helps even on few cores */
+  threads = scan_threads > 0 ? scan_threads : MAX_SCAN_THREADS;
+  if (threads > MAX_SCAN_THREADS)
+    threads = MAX_SCAN_THREADS;
+  if (threads > pool.job_count)
+    threads = pool.job_count;
 
-      memset(s->name, 0, sizeof(s->name));
-      snprintf(s->name, sizeof(s->name), "%s", sensor_name);
+  atomic_init(&pool.next, 0);
 
-      snprintf(s->path, sizeof(s->path), "%s/%s", hwmon_path, temp_entry->d_name);
+  /* The calling thread is worker 0 */
+  for (int i = 1; i < threads; i++)
+  {
+    if (pthread_create(&workers[started], NULL, hwmon_scan_worker, &pool) != 0)
+      break;
+    started++;
+  }
+  hwmon_scan_worker(&pool);
+  for (int i = 0; i < started; i++)
+  {
+    pthread_join(workers[i], NULL);
+  }
 
-      s->type          = detect_sensor_type(sensor_name, s->label, s->path);
-      s->temp_critical = get_critical_temp(hwmon_path, temp_entry->d_name);
-      s->temp_max      = -999.0;
-      s->temp_min      = 999.0;
-      s->read_count    = 0;
-      s->active        = 1;
-      s->has_fan       = 0;
-      s->fan_path[0]   = '\0';
+  for (int j = 0; j < pool.job_count; j++)
+  {
+    HwmonScanJob *job = &pool.jobs[j];
+    int           n   = job->found.count;
 
-      (*count)++;
-      found++;
+    if (!job->error && registry_append(registry, &job->found))
+    {
+      found += n;
+      continue;
     }
-    closedir(hwmon_dir);
+
+    fprintf(stderr, COLOR_YELLOW "Warning: Skipped hwmon chip %s: %s\n" COLOR_RESET, job->path,
+            strerror(job->error ? job->error : ENOMEM));
+    registry_free(&job->found);
+    scan_failures++;
   }
-  closedir(dir);
+  free(pool.jobs);
+  close(class_fd);
 
   return found;
 }
 
-int scan_thermal_sensors(TempSensor *sensors, int *count)
+int scan_thermal_sensors(SensorRegistry *registry)
 {
   DIR *          dir;
   struct dirent *entry;
+  char           class_path[MAX_PATH];
+  char           buffer[MAX_PATH];
+  int            class_fd;
   int            found = 0;
 
-  dir = opendir(THERMAL_PATH);
+  class_fd = open_sysfs_class(THERMAL_SUBDIR, class_path, sizeof(class_path));
+  if (class_fd < 0)
+    return 0;
+
+  dir = fdopendir(class_fd);
   if (!dir)
+  {
+    close(class_fd);
     return 0;
+  }
 
-  while ((entry = readdir(dir)) != NULL && *count < MAX_SENSORS)
+  while ((entry = readdir(dir)) != NULL)
   {
-    char        zone_path[MAX_PATH];
-    char        temp_path[MAX_PATH];
-    char        type_path[MAX_PATH];
-    char        type_buf[MAX_NAME_LEN];
     TempSensor *s;
+    int         zone_fd;
 
     if (!str_startswith(entry->d_name, "thermal_zone"))
       continue;
 
-    if (strlen(entry->d_name) > SAFE_PATH_LEN)
+    zone_fd = open_dir_at(class_fd, entry->d_name);
+    if (zone_fd < 0)
       continue;
 
-    snprintf(zone_path, sizeof(zone_path), "%s/%s", THERMAL_PATH, entry->d_name);
-    snprintf(temp_path, sizeof(temp_path), "%s/temp", zone_path);
-
-    if (!file_exists(temp_path))
+    if (!file_exists_at(zone_fd, "temp"))
+    {
+      close(zone_fd);
       continue;
+    }
 
-    s = &sensors[*count];
-    memset(s, 0, sizeof(TempSensor));
-
-    snprintf(type_path, sizeof(type_path), "%s/type", zone_path);
+    s = registry_add_sensor(registry);
+    if (!s)
+    {
+      close(zone_fd);
+      break;
+    }
 
-    if (read_file(type_path, type_buf, sizeof(type_buf)))
+    if (read_file_at(zone_fd, "type", buffer, MAX_NAME_LEN))
     {
-      str_trim(type_buf);
-      memset(s->label, 0, sizeof(s->label));
-      snprintf(s->label, sizeof(s->label), "%s", type_buf);
+      str_trim(buffer);
     }
     else
     {
-      snprintf(s->label, sizeof(s->label), "Zone %s", entry->d_name + 12);
+      snprintf(buffer, MAX_NAME_LEN, "Zone %s", entry->d_name + 12);
     }
+    s->label = registry_strdup(registry, buffer);
+    s->name  = "thermal";
 
-    memset(s->name, 0, sizeof(s->name));
-    snprintf(s->name, sizeof(s->name), "thermal");
-
-    memset(s->path, 0, sizeof(s->path));
-    snprintf(s->path, sizeof(s->path), "%s", temp_path);
+    snprintf(buffer, sizeof(buffer), "%s/%s/temp", class_path, entry->d_name);
+    s->path = registry_strdup(registry, buffer);
 
     s->type          = SENSOR_CHIPSET;
-    s->temp_critical = 100.0;
-    s->temp_max      = -999.0;
-    s->temp_min      = 999.0;
-    s->read_count    = 0;
-    s->active        = 1;
-    s->has_fan       = 0;
+    s->temp_critical = 100000;
+    s->fd            = open_sensor_attr(zone_fd, "temp");
 
-    (*count)++;
+    close(zone_fd);
     found++;
   }
 
@@ -633,105 +1480,142 @@ int scan_thermal_sensors(TempSensor *sensors, int *count)
 /**
  * @brief Main function to scan all temperature sensors
  *
- * Scans hwmon subsystem first, falls back to thermal zones
- * if no hwmon sensors found. Also scans for associated fans.
+ * Restores the tables from the scan cache when the hwmon set is
+ * unchanged. Otherwise scans hwmon subsystem first and falls back
+ * to thermal zones if no hwmon sensors found; fans are collected
+ * into the registry either way. Fresh hwmon results are written
+ * back to the cache, unless a chip was skipped: the fingerprint only
+ * covers the set of chips, so a short table would be restored even
+ * after the cause went away. Finally the per-type index lists are built.
  *
- * @param sensors Array to populate with found sensors
+ * @param registry Empty registry to populate
  * @return Number of sensors found
  */
-int scan_temperature_sensors(TempSensor *sensors)
+int scan_temperature_sensors(SensorRegistry *registry)
 {
-  int count = 0;
-
-  scan_hwmon_sensors(sensors, &count);
-
-  if (count == 0)
+  if (!scan_cache_load(registry))
   {
-    scan_thermal_sensors(sensors, &count);
+    scan_hwmon_sensors(registry);
+
+    if (registry->count > 0 && scan_failures == 0)
+      scan_cache_save(registry);
+    else if (registry->count == 0)
+      scan_thermal_sensors(registry);
   }
 
-  if (count > 0)
+  registry_index_types(registry);
+  return registry->count;
+}
+
+/**
+ * @brief Sums the active temperatures of one sensor type
+ *
+ * @param registry Registry with per-type index lists
+ * @param snapshot Readings to aggregate
+ * @param type Sensor type
+ * @param min Output minimum (untouched if no sensor is active)
+ * @param max Output maximum (untouched if no sensor is active)
+ * @param count Output number of active sensors
+ * @return Sum of active temperatures in millidegrees
+ */
+static int64_t sum_type(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                        SensorType type, int32_t *min, int32_t *max, int *count)
+{
+  int64_t sum = 0;
+
+  for (int k = registry->type_start[type]; k < registry->type_start[type + 1]; k++)
   {
-    scan_fan_sensors(sensors, count);
+    int     i = registry->by_type[k];
+    int32_t t;
+
+    if (i >= snapshot->count || !snapshot->active[i])
+      continue;
+
+    t = snapshot->temp_current[i];
+
+    sum += t;
+    if (t > *max)
+      *max = t;
+    if (t < *min)
+      *min = t;
+    (*count)++;
   }
 
-  return count;
+  return sum;
 }
 
 /**
- * @brief Calculates system-wide statistics from all sensors
+ * @brief Calculates system-wide statistics from a snapshot
  *
- * Aggregates temperatures by sensor type and counts
- * warnings/critical alerts.
+ * Status counts and the worst per-sensor tail percentiles come from
+ * straight passes over the snapshot arrays, fan counts from the fan
+ * registry; per-type aggregates walk the registry's per-type index
+ * lists.
  *
- * @param sensors Array of sensors
- * @param count Number of sensors
+ * @param registry Sensor registry (metadata and type index)
+ * @param snapshot Readings to aggregate
  * @param stats Output structure for statistics
  */
-void calculate_system_stats(TempSensor *sensors, int count, SystemStats *stats)
+void calculate_system_stats(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                            SystemStats *stats)
 {
-  int i;
+  int32_t unused_min = INT32_MAX, unused_max = INT32_MIN;
+  int64_t cpu_sum, gpu_sum, nvme_sum;
+  int     chipset = 0;
 
   memset(stats, 0, sizeof(SystemStats));
-  stats->min_cpu_temp = 999.0;
-
-  for (i = 0; i < count; i++)
+  stats->min_cpu_temp = INT32_MAX;
+  stats->max_cpu_temp = INT32_MIN;
+  stats->max_gpu_temp = INT32_MIN;
+  stats->tail_p95     = TEMP_INVALID;
+  stats->tail_p99     = TEMP_INVALID;
+  stats->tail_sensor  = -1;
+
+  for (int i = 0; i < snapshot->count; i++)
   {
-    if (!sensors[i].active || sensors[i].temp_current < -500)
+    if (!snapshot->active[i])
       continue;
 
     stats->total_active_sensors++;
+    stats->warnings += snapshot->status[i] == STATUS_WARN;
+    stats->criticals += snapshot->status[i] == STATUS_CRITICAL;
 
-    if (sensors[i].has_fan && sensors[i].fan_speed_rpm > 0)
+    if (snapshot->temp_p95[i] > stats->tail_p95)
+      stats->tail_p95 = snapshot->temp_p95[i];
+    if (snapshot->temp_p99[i] > stats->tail_p99)
     {
-      stats->total_fans++;
+      stats->tail_p99    = snapshot->temp_p99[i];
+      stats->tail_sensor = i;
     }
+  }
 
-    if (sensors[i].status == STATUS_WARN)
-      stats->warnings++;
-    if (sensors[i].status == STATUS_CRITICAL)
-      stats->criticals++;
-
-    switch (sensors[i].type)
-    {
-      case SENSOR_CPU:
-        stats->avg_cpu_temp += sensors[i].temp_current;
-        if (sensors[i].temp_current > stats->max_cpu_temp)
-          stats->max_cpu_temp = sensors[i].temp_current;
-        if (sensors[i].temp_current < stats->min_cpu_temp)
-          stats->min_cpu_temp = sensors[i].temp_current;
-        stats->cpu_count++;
-        break;
-
-      case SENSOR_GPU:
-        stats->avg_gpu_temp += sensors[i].temp_current;
-        if (sensors[i].temp_current > stats->max_gpu_temp)
-          stats->max_gpu_temp = sensors[i].temp_current;
-        stats->gpu_count++;
-        break;
-
-      case SENSOR_NVME:
-        stats->avg_nvme_temp += sensors[i].temp_current;
-        stats->nvme_count++;
-        break;
-
-      case SENSOR_CHIPSET:
-        stats->chipset_count++;
-        break;
+  for (int f = 0; f < registry->fan_count; f++)
+  {
+    int i = registry->fans[f].sensor;
 
-      default:
-        break;
-    }
+    if (i >= 0 && i < snapshot->count && snapshot->active[i] && snapshot->fan_rpm[i] > 0)
+      stats->total_fans++;
   }
 
+  cpu_sum  = sum_type(registry, snapshot, SENSOR_CPU, &stats->min_cpu_temp, &stats->max_cpu_temp,
+                      &stats->cpu_count);
+  gpu_sum  = sum_type(registry, snapshot, SENSOR_GPU, &unused_min, &stats->max_gpu_temp,
+                      &stats->gpu_count);
+  nvme_sum = sum_type(registry, snapshot, SENSOR_NVME, &unused_min, &unused_max,
+                      &stats->nvme_count);
+  sum_type(registry, snapshot, SENSOR_CHIPSET, &unused_min, &unused_max, &chipset);
+  stats->chipset_count = chipset;
+
   if (stats->cpu_count > 0)
-    stats->avg_cpu_temp /= stats->cpu_count;
+    stats->avg_cpu_temp = (int32_t) (cpu_sum / stats->cpu_count);
+  else
+    stats->min_cpu_temp = stats->max_cpu_temp = 0;
   if (stats->gpu_count > 0)
-    stats->avg_gpu_temp /= stats->gpu_count;
+    stats->avg_gpu_temp = (int32_t) (gpu_sum / stats->gpu_count);
+  else
+    stats->max_gpu_temp = 0;
   if (stats->nvme_count > 0)
-    stats->avg_nvme_temp /= stats->nvme_count;
-  if (stats->min_cpu_temp > 900)
-    stats->min_cpu_temp = 0;
+    stats->avg_nvme_temp = (int32_t) (nvme_sum / stats->nvme_count);
 }
 
 /**
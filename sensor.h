@@ -16,21 +16,27 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* Maximum path length for sensor files */
 #define MAX_PATH 512
-/* Maximum number of sensors to track */
-#define MAX_SENSORS 200
 
 /* Maximum length for sensor names and labels */
 #define MAX_NAME_LEN 128
 
-/* Maximum number of fans to track */
-#define MAX_FANS 50
+/* Temperatures are int32 millidegrees Celsius; this marks a failed read */
+#define TEMP_INVALID INT32_MIN
+
+/* Default sysfs mount point, overridable at runtime */
+#define SYSFS_ROOT "/sys"
+/* Environment variable that overrides SYSFS_ROOT */
+#define SYSFS_ROOT_ENV "TEMP_SYSFS_ROOT"
 
-/* Linux sysfs paths for sensor data */
-#define HWMON_PATH "/sys/class/hwmon"
-#define THERMAL_PATH "/sys/class/thermal"
-#define DRM_PATH "/sys/class/drm"
+/* Sensor class directories, relative to the sysfs root */
+#define HWMON_SUBDIR "class/hwmon"
+#define THERMAL_SUBDIR "class/thermal"
+#define DRM_SUBDIR "class/drm"
 
 /**
  * @brief Sensor type enumeration
@@ -47,7 +53,8 @@ typedef enum
   SENSOR_MEMORY,  /* RAM modules */
   SENSOR_VRM,     /* Voltage regulators */
   SENSOR_DISK,    /* HDDs/SATA SSDs */
-  SENSOR_OTHER    /* Unclassified sensors */
+  SENSOR_OTHER,   /* Unclassified sensors */
+  SENSOR_TYPE_COUNT
 } SensorType;
 
 /**
@@ -65,69 +72,126 @@ typedef enum
 } SensorStatus;
 
 /**
- * @brief Temperature sensor data structure
+ * @brief Sampling backend enumeration
+ *
+ * Selects how update_all_sensors() reads sensor attributes.
+ */
+typedef enum
+{
+  SAMPLER_READ = 0, /* One pread() per attribute */
+  SAMPLER_IO_URING  /* One io_uring batch per tick */
+} SamplerBackend;
+
+/**
+ * @brief Temperature sensor metadata
  *
- * Stores all information about a single temperature sensor
- * including its identification, current readings, statistics,
- * and associated fan data.
+ * The cold, scan-time part of a sensor: identification, thresholds,
+ * descriptors and fan linkage. Per-tick values live in the
+ * structure-of-arrays SensorSnapshot, indexed the same way. Strings
+ * point into the string arena of the owning SensorRegistry and are
+ * never NULL.
  */
 typedef struct
 {
-  char         name[MAX_NAME_LEN];         /* Driver/chip name */
-  char         label[MAX_NAME_LEN];        /* Human-readable label */
-  char         path[MAX_PATH];             /* Sysfs path to temp file */
-  char         fan_path[MAX_PATH];         /* Sysfs path to fan file */
-  char         device_model[MAX_NAME_LEN]; /* Device model info */
-  SensorType   type;                       /* Sensor category */
-  SensorStatus status;                     /* Current status */
-
-  double temp_current;  /* Current temperature (Celsius) */
-  double temp_max;      /* Maximum recorded temperature */
-  double temp_min;      /* Minimum recorded temperature */
-  double temp_critical; /* Critical threshold temperature */
-  double temp_avg;      /* Running average temperature */
-
-  long read_count;  /* Number of readings taken */
-  int  active;      /* 1 if sensor is working */
-  int  alarm_state; /* 1 if alarm triggered */
-
-  int has_fan;           /* 1 if sensor has associated fan */
-  int fan_speed_rpm;     /* Current fan speed in RPM */
-  int fan_speed_percent; /* Fan speed as percentage */
-  int fan_max_rpm;       /* Maximum fan RPM */
+  const char *name;         /* Driver/chip name */
+  const char *label;        /* Human-readable label */
+  const char *path;         /* Sysfs path to temp file */
+  const char *fan_path;     /* Sysfs path to fan file */
+  const char *device_model; /* Device model info, NULL if unknown */
+  SensorType  type;         /* Sensor category */
+
+  int fd;     /* Cached descriptor for path, -1 if closed */
+  int fan_fd; /* Cached descriptor for fan_path, -1 if closed */
+
+  int32_t temp_critical; /* Critical threshold, millidegrees C */
+
+  int has_fan;     /* 1 if sensor has associated fan */
+  int fan;         /* Fan registry index, -1 if not registered */
+  int fan_max_rpm; /* Maximum fan RPM */
 } TempSensor;
 
 /**
- * @brief Standalone fan sensor data structure
+ * @brief Fan registry entry
  *
- * For fans not directly associated with a temperature sensor.
+ * Every fanN_input found during the scan gets one, including fans
+ * that could not be paired with a temperature channel.
  */
 typedef struct
 {
-  char name[MAX_NAME_LEN];  /* Fan name */
-  char label[MAX_NAME_LEN]; /* Human-readable label */
-  char path[MAX_PATH];      /* Sysfs path */
-  int  speed_rpm;           /* Current speed in RPM */
-  int  speed_percent;       /* Speed as percentage */
-  int  max_rpm;             /* Maximum RPM */
-  int  min_rpm;             /* Minimum RPM */
-  int  active;              /* 1 if fan is detected */
+  const char *name;          /* Fan name */
+  const char *label;         /* Human-readable label */
+  const char *path;          /* Sysfs path */
+  int         speed_rpm;     /* Current speed in RPM */
+  int         speed_percent; /* Speed as percentage */
+  int         max_rpm;       /* Maximum RPM */
+  int         min_rpm;       /* Minimum RPM */
+  int         active;        /* 1 if fan is detected */
+  int         sensor;        /* Paired temperature sensor index, -1 if none */
 } FanSensor;
 
+/* Growable sensor table + fan registry, defined in registry.h */
+typedef struct SensorRegistry SensorRegistry;
+
+/* Per-sensor quantile histogram, defined in stats.h */
+typedef struct TempHistogram TempHistogram;
+
+/**
+ * @brief Per-tick sensor values in structure-of-arrays form
+ *
+ * Each hot field is a contiguous array indexed like the sensor
+ * table, so a loop over one field touches only that field's cache
+ * lines. The sampler keeps a private snapshot as its running state
+ * (min/max/average accumulate in place) and publishes copies of it;
+ * every consumer of a frame sees values from the same instant.
+ * Arrays are carved from one allocation made by snapshot_init().
+ * Temperatures are millidegrees Celsius. Statistics (min/max, Welford
+ * mean/variance, quantiles) cover every sample since the last
+ * snapshot_reset_stats().
+ */
+typedef struct
+{
+  unsigned long tick;         /* Sample pass number, starts at 1 */
+  long long     timestamp_ms; /* Wall-clock time of the pass */
+  int           count;        /* Number of valid entries per array */
+  int           capacity;     /* Allocated entries per array */
+
+  double *       temp_mean;    /* Welford running mean */
+  double *       temp_m2;      /* Welford sum of squared deviations */
+  long *         read_count;   /* Number of successful reads */
+  int32_t *      temp_current; /* Temperature at sample time, TEMP_INVALID if inactive */
+  int32_t *      temp_min;     /* Minimum recorded temperature */
+  int32_t *      temp_max;     /* Maximum recorded temperature */
+  int32_t *      temp_p50;     /* Median, TEMP_INVALID without histograms */
+  int32_t *      temp_p95;     /* 95th percentile */
+  int32_t *      temp_p99;     /* 99th percentile */
+  int *          fan_rpm;      /* Fan speed in RPM */
+  unsigned char *fan_percent;  /* Fan speed as percentage */
+  unsigned char *status;       /* SensorStatus at sample time */
+  unsigned char *active;       /* 1 if the read succeeded */
+
+  /* Quantile state, one per sensor; only the sampler's running
+   * snapshot has it, copies keep their own pointer (usually NULL) */
+  TempHistogram *histograms;
+} SensorSnapshot;
+
 /**
  * @brief System-wide statistics structure
  *
  * Aggregated statistics across all sensors for
- * summary display and health monitoring.
+ * summary display and health monitoring. Temperatures are
+ * millidegrees Celsius.
  */
 typedef struct
 {
-  double avg_cpu_temp;  /* Average CPU temperature */
-  double max_cpu_temp;  /* Maximum CPU temperature */
-  double min_cpu_temp;  /* Minimum CPU temperature */
-  double avg_gpu_temp;  /* Average GPU temperature */
-  double max_gpu_temp;  /* Maximum GPU temperature */
-  double avg_nvme_temp; /* Average NVMe temperature */
+  int32_t avg_cpu_temp;  /* Average CPU temperature */
+  int32_t max_cpu_temp;  /* Maximum CPU temperature */
+  int32_t min_cpu_temp;  /* Minimum CPU temperature */
+  int32_t avg_gpu_temp;  /* Average GPU temperature */
+  int32_t max_gpu_temp;  /* Maximum GPU temperature */
+  int32_t avg_nvme_temp; /* Average NVMe temperature */
+  int32_t tail_p95;      /* Highest per-sensor 95th percentile */
+  int32_t tail_p99;      /* Highest per-sensor 99th percentile */
+  int     tail_sensor;   /* Sensor with the highest p99, -1 if none */
 
   int cpu_count;            /* Number of CPU sensors */
   int gpu_count;            /* Number of GPU sensors */
@@ -140,21 +204,41 @@ typedef struct
   int criticals; /* Number of critical alerts */
 } SystemStats;
 
-int scan_temperature_sensors(TempSensor *sensors);
-int scan_hwmon_sensors(TempSensor *sensors, int *count);
-int scan_thermal_sensors(TempSensor *sensors, int *count);
-int scan_gpu_sensors(TempSensor *sensors, int *count);
-int scan_fan_sensors(TempSensor *sensors, int count);
-
-double read_temperature(const char *path);
-int    read_fan_speed(const char *path);
-int    read_fan_max(const char *hwmon_path, const char *fan_num);
-void   update_sensor_data(TempSensor *sensor);
-void   update_fan_data(TempSensor *sensor);
-void   calculate_system_stats(TempSensor *sensors, int count, SystemStats *stats);
+void        set_sysfs_root(const char *root);
+const char *get_sysfs_root(void);
+int         open_sysfs_class(const char *subdir, char *path, size_t size);
+
+void set_scan_threads(int threads);
+
+int scan_temperature_sensors(SensorRegistry *registry);
+int scan_hwmon_sensors(SensorRegistry *registry);
+int scan_thermal_sensors(SensorRegistry *registry);
+int scan_gpu_sensors(SensorRegistry *registry);
+
+int32_t read_sensor_temperature(TempSensor *sensor);
+int     read_sensor_fan_speed(TempSensor *sensor);
+int     open_sensor_attr(int dirfd, const char *name);
+void    close_sensor_files(TempSensor *sensors, int count);
+int     read_fan_max(int hwmon_fd, const char *fan_num);
+void    update_sensor_data(TempSensor *sensor, SensorSnapshot *snapshot, int index);
+void    update_fan_data(TempSensor *sensor, SensorSnapshot *snapshot, int index);
+void    update_all_sensors(TempSensor *sensors, int count, SensorSnapshot *snapshot);
+void    sample_sensors(TempSensor *sensors, int count, SensorSnapshot *snapshot);
+void    replay_sensors(const TempSensor *sensors, int count, const int32_t *temps,
+                       const int32_t *fans, unsigned long tick, long long timestamp_ms,
+                       SensorSnapshot *snapshot);
+int     snapshot_init(SensorSnapshot *snapshot, int count);
+void    snapshot_copy(SensorSnapshot *dest, const SensorSnapshot *src);
+void    snapshot_free(SensorSnapshot *snapshot);
+int     snapshot_enable_histograms(SensorSnapshot *snapshot);
+void    snapshot_reset_stats(SensorSnapshot *snapshot);
+
+SamplerBackend set_sampler_backend(SamplerBackend backend);
+void   calculate_system_stats(const SensorRegistry *registry, const SensorSnapshot *snapshot,
+                              SystemStats *stats);
 
 SensorType   detect_sensor_type(const char *name, const char *label, const char *path);
-SensorStatus get_sensor_status(double temp, double critical);
+SensorStatus get_sensor_status(int32_t temp, int32_t critical);
 const char * get_type_name(SensorType type);
 const char * get_type_icon(SensorType type);
 const char * get_status_color(SensorStatus status);
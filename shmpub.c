@@ -0,0 +1,223 @@
+/**
+ * @file shmpub.c
+ * @brief Temp Monitor - Shared-memory snapshot publisher implementation
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "shmpub.h"
+
+#include "registry.h"
+#include "tempshm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Table and readings start on their own cache lines */
+#define SHM_ALIGN 64
+
+/* Segment being published, NULL header when --shm is off */
+static struct
+{
+  TempShmHeader * header;
+  TempShmReading *readings;
+  size_t          size;
+  int             count;
+  char            path[NAME_MAX + 1]; /* Object name with its leading '/' */
+} publisher;
+
+static size_t align_up(size_t size)
+{
+  return (size + SHM_ALIGN - 1) & ~(size_t) (SHM_ALIGN - 1);
+}
+
+/**
+ * @brief Tells whether a live monitor already publishes under path
+ *
+ * A segment left by a monitor that was killed is not in use: its
+ * publisher is gone, and it is replaced like a stale socket.
+ */
+static int segment_in_use(const char *path)
+{
+  TempShm shm;
+  int     used;
+
+  if (!tempshm_open(&shm, path))
+    return 0;
+
+  used = !tempshm_closed(&shm) &&
+         (kill((pid_t) shm.header->pid, 0) == 0 || errno == EPERM);
+  tempshm_close(&shm);
+  return used;
+}
+
+/**
+ * @brief Copies a string into a fixed-size table field, cutting it if needed
+ */
+static void copy_field(char *dest, size_t size, const char *src)
+{
+  size_t len = strlen(src);
+
+  if (len >= size)
+    len = size - 1;
+  memcpy(dest, src, len);
+  dest[len] = '\0';
+}
+
+/**
+ * @brief Creates the segment and writes its header and sensor table
+ *
+ * Readers that open the segment before the header is complete find no
+ * magic yet and get EAGAIN from tempshm_open().
+ *
+ * @param name Object name, with or without the leading '/'
+ * @param registry Sensor table being sampled
+ * @param interval_ms Sampling interval, stored for readers
+ * @return 1 on success, 0 on failure (errno is set; EADDRINUSE if
+ *         another monitor publishes under name)
+ */
+int shmpub_open(const char *name, const SensorRegistry *registry, int interval_ms)
+{
+  TempShmHeader *h;
+  size_t         sensors_offset, readings_offset;
+  void *         map;
+  int            fd, saved;
+
+  if ((size_t) snprintf(publisher.path, sizeof(publisher.path), "%s%s",
+                        name[0] == '/' ? "" : "/", name) >= sizeof(publisher.path) ||
+      strchr(publisher.path + 1, '/'))
+  {
+    errno = EINVAL;
+    return 0;
+  }
+
+  if (segment_in_use(publisher.path))
+  {
+    errno = EADDRINUSE;
+    return 0;
+  }
+
+  /* Unlinking first leaves readers of an old segment on the old one */
+  shm_unlink(publisher.path);
+  fd = shm_open(publisher.path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return 0;
+
+  sensors_offset  = align_up(sizeof(TempShmHeader));
+  readings_offset = align_up(sensors_offset + (size_t) registry->count * sizeof(TempShmSensor));
+  publisher.size  = readings_offset + (size_t) registry->count * sizeof(TempShmReading);
+
+  map = MAP_FAILED;
+  if (ftruncate(fd, (off_t) publisher.size) == 0)
+    map = mmap(NULL, publisher.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  saved = errno;
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    shm_unlink(publisher.path);
+    errno = saved;
+    return 0;
+  }
+
+  /* ftruncate() zero-fills: only non-zero fields need writing */
+  h                  = map;
+  h->version         = TEMPSHM_VERSION;
+  h->header_size     = sizeof(TempShmHeader);
+  h->sensor_size     = sizeof(TempShmSensor);
+  h->reading_size    = sizeof(TempShmReading);
+  h->sensor_count    = (uint32_t) registry->count;
+  h->interval_ms     = (uint32_t) interval_ms;
+  h->sensors_offset  = (uint32_t) sensors_offset;
+  h->readings_offset = (uint32_t) readings_offset;
+  h->size            = publisher.size;
+  h->pid             = (int64_t) getpid();
+
+  TempShmSensor *table = (TempShmSensor *) ((char *) map + sensors_offset);
+  for (int i = 0; i < registry->count; i++)
+  {
+    const TempSensor *s = &registry->sensors[i];
+
+    copy_field(table[i].name, sizeof(table[i].name), s->name);
+    copy_field(table[i].label, sizeof(table[i].label), s->label);
+    table[i].type        = (int32_t) s->type;
+    table[i].crit_mc     = s->temp_critical;
+    table[i].has_fan     = s->has_fan;
+    table[i].fan_max_rpm = s->fan_max_rpm;
+  }
+
+  publisher.readings = (TempShmReading *) ((char *) map + readings_offset);
+  for (int i = 0; i < registry->count; i++)
+  {
+    publisher.readings[i].temp_mc = TEMPSHM_INVALID;
+    publisher.readings[i].max_mc  = TEMPSHM_INVALID;
+    publisher.readings[i].status  = STATUS_ERROR;
+  }
+
+  /* The magic goes last: a reader that sees it sees everything above */
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(h->magic, TEMPSHM_MAGIC, sizeof(h->magic));
+
+  publisher.header = h;
+  publisher.count  = registry->count;
+  return 1;
+}
+
+/**
+ * @brief Publishes a snapshot's current readings
+ *
+ * Writer side of the sequence lock in tempshm_read(); the only writer
+ * is the thread calling this.
+ */
+void shmpub_write(const SensorSnapshot *snapshot)
+{
+  TempShmHeader *h = publisher.header;
+  uint32_t       seq;
+
+  if (!h)
+    return;
+
+  seq = __atomic_load_n(&h->seq, __ATOMIC_RELAXED);
+  __atomic_store_n(&h->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  for (int i = 0; i < publisher.count; i++)
+  {
+    TempShmReading *r = &publisher.readings[i];
+
+    r->temp_mc = snapshot->temp_current[i];
+    r->max_mc  = snapshot->temp_max[i];
+    r->fan_rpm = snapshot->fan_rpm[i];
+    r->status  = snapshot->status[i];
+  }
+  h->tick         = snapshot->tick;
+  h->timestamp_ms = snapshot->timestamp_ms;
+
+  __atomic_store_n(&h->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Marks the segment closed, unmaps and removes it
+ *
+ * Readers that still have it mapped keep the last sample and see
+ * tempshm_closed().
+ */
+void shmpub_close(void)
+{
+  if (!publisher.header)
+    return;
+
+  __atomic_store_n(&publisher.header->closed, 1, __ATOMIC_RELEASE);
+  munmap(publisher.header, publisher.size);
+  shm_unlink(publisher.path);
+  memset(&publisher, 0, sizeof(publisher));
+}
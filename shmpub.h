@@ -0,0 +1,28 @@
+/**
+ * @file shmpub.h
+ * @brief Temp Monitor - Shared-memory snapshot publisher
+ *
+ * --shm NAME writes every sample into the shared memory segment
+ * described in tempshm.h, for local programs that need the current
+ * temperatures without a system call (e.g. a scheduler checking thermal
+ * headroom before placing work). The segment is created with the
+ * sensor table once; each sample only rewrites the readings under the
+ * sequence lock.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef SHMPUB_H
+#define SHMPUB_H
+
+#include "sensor.h"
+
+int  shmpub_open(const char *name, const SensorRegistry *registry, int interval_ms);
+void shmpub_write(const SensorSnapshot *snapshot);
+void shmpub_close(void);
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file stats.c
+ * @brief Temp Monitor - Streaming per-sensor statistics
+ *
+ * Welford's online mean/variance and a fixed-bin millidegree histogram
+ * with incremental p50/p95/p99 cursors. Both use constant memory per
+ * sensor regardless of session length.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "stats.h"
+
+#include <math.h>
+#include <string.h>
+
+/* Quantile of each cursor, in permille */
+static const uint32_t quantile_permille[QUANTILE_COUNT] = {500, 950, 990};
+
+/**
+ * @brief Zero-based rank of a quantile among total samples
+ */
+static uint32_t quantile_rank(uint32_t total, Quantile q)
+{
+  return (uint32_t) ((uint64_t) (total - 1) * quantile_permille[q] / 1000);
+}
+
+/**
+ * @brief Clears all samples and cursors
+ *
+ * @param hist Histogram to reset
+ */
+void histogram_reset(TempHistogram *hist)
+{
+  memset(hist, 0, sizeof(*hist));
+}
+
+/**
+ * @brief Adds one sample and advances the quantile cursors
+ *
+ * Invariant per cursor: below <= rank < below + bins[bin]. A new
+ * sample below the cursor's bin raises below by one; the rank itself
+ * grows by at most one. The cursor then walks to the bin that holds
+ * the new rank, skipping empty bins.
+ *
+ * @param hist Histogram to update
+ * @param temp Sample in millidegrees Celsius
+ */
+void histogram_add(TempHistogram *hist, int32_t temp)
+{
+  int bin;
+
+  if (temp < STATS_HIST_MIN)
+    bin = 0;
+  else if (temp >= STATS_HIST_MIN + STATS_HIST_BINS * STATS_HIST_STEP)
+    bin = STATS_HIST_BINS - 1;
+  else
+    bin = (temp - STATS_HIST_MIN) / STATS_HIST_STEP;
+
+  hist->bins[bin]++;
+  hist->total++;
+
+  for (int q = 0; q < QUANTILE_COUNT; q++)
+  {
+    uint32_t rank = quantile_rank(hist->total, (Quantile) q);
+
+    if (bin < hist->bin[q])
+      hist->below[q]++;
+
+    while (rank < hist->below[q])
+    {
+      hist->bin[q]--;
+      hist->below[q] -= hist->bins[hist->bin[q]];
+    }
+
+    while (rank >= hist->below[q] + hist->bins[hist->bin[q]])
+    {
+      hist->below[q] += hist->bins[hist->bin[q]];
+      hist->bin[q]++;
+    }
+  }
+}
+
+/**
+ * @brief Reads a tracked quantile
+ *
+ * Returns the centre of the cursor's bin. Bins are centred on whole
+ * degrees, so sensors with 1 C resolution (most of them) get exact
+ * percentiles; finer sensors are within half a degree. Callers clamp
+ * the result to the observed min/max.
+ *
+ * @param hist Histogram to query
+ * @param q Quantile to read
+ * @return Quantile in millidegrees, or TEMP_INVALID if empty
+ */
+int32_t histogram_quantile(const TempHistogram *hist, Quantile q)
+{
+  if (hist->total == 0)
+    return TEMP_INVALID;
+
+  return STATS_HIST_MIN + hist->bin[q] * STATS_HIST_STEP + STATS_HIST_STEP / 2;
+}
+
+/**
+ * @brief Adds one sample to a Welford mean/variance accumulator
+ *
+ * Numerically stable for arbitrarily long sessions, unlike
+ * re-deriving the mean from (avg * (n - 1) + t) / n.
+ *
+ * @param mean Running mean in millidegrees
+ * @param m2 Running sum of squared deviations
+ * @param n Sample count including this sample
+ * @param temp Sample in millidegrees Celsius
+ */
+void welford_add(double *mean, double *m2, long n, int32_t temp)
+{
+  double delta = temp - *mean;
+
+  *mean += delta / n;
+  *m2 += delta * (temp - *mean);
+}
+
+/**
+ * @brief Sample standard deviation of a Welford accumulator
+ *
+ * @param m2 Running sum of squared deviations
+ * @param n Sample count
+ * @return Standard deviation in millidegrees, 0 for fewer than 2 samples
+ */
+int32_t welford_stddev(double m2, long n)
+{
+  if (n < 2 || m2 <= 0)
+    return 0;
+
+  return (int32_t) lround(sqrt(m2 / (n - 1)));
+}
@@ -0,0 +1,63 @@
+/**
+ * @file stats.h
+ * @brief Temp Monitor - Streaming per-sensor statistics
+ *
+ * Constant-memory building blocks for the sampler's running state:
+ * Welford mean/variance and a fixed-bin millidegree histogram that
+ * tracks p50/p95/p99 incrementally, so each sample costs O(1).
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "sensor.h"
+
+#include <stdint.h>
+
+/* Histogram range: 1 C bins centred on whole degrees from -20 C to 139 C;
+ * outliers land in the edge bins */
+#define STATS_HIST_MIN -20500
+#define STATS_HIST_STEP 1000
+#define STATS_HIST_BINS 160
+
+/**
+ * @brief Quantiles tracked by every histogram
+ */
+typedef enum
+{
+  QUANTILE_P50 = 0,
+  QUANTILE_P95,
+  QUANTILE_P99,
+  QUANTILE_COUNT
+} Quantile;
+
+/**
+ * @brief Millidegree histogram with incremental quantile cursors
+ *
+ * For each tracked quantile the histogram remembers the bin holding
+ * it and how many samples lie below that bin. Adding a sample moves
+ * each cursor by at most a few bins instead of rescanning the
+ * histogram, so quantiles are always current.
+ */
+struct TempHistogram
+{
+  uint32_t bins[STATS_HIST_BINS]; /* Sample count per bin */
+  uint32_t total;                 /* Samples since the last reset */
+  uint16_t bin[QUANTILE_COUNT];   /* Bin holding each quantile */
+  uint32_t below[QUANTILE_COUNT]; /* Samples in bins below it */
+};
+
+void    histogram_reset(TempHistogram *hist);
+void    histogram_add(TempHistogram *hist, int32_t temp);
+int32_t histogram_quantile(const TempHistogram *hist, Quantile q);
+
+void    welford_add(double *mean, double *m2, long n, int32_t temp);
+int32_t welford_stddev(double m2, long n);
+
+#endif
@@ -0,0 +1,219 @@
+/**
+ * @file tempshm.c
+ * @brief Temp Monitor - Shared-memory snapshot reader library
+ *
+ * Only tempshm_open() and tempshm_close() make system calls. The
+ * sequence is accessed with the GCC/Clang __atomic builtins rather than
+ * C11 atomics so the layout in tempshm.h stays plain integers that C++
+ * and other languages can map too.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "tempshm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Checks that a mapped header describes a segment we can read
+ *
+ * @return 1 if valid, 0 otherwise (errno is EAGAIN while the publisher
+ *         is still creating the segment, EPROTO for another version or
+ *         a damaged header)
+ */
+static int header_valid(const TempShmHeader *h, size_t size)
+{
+  uint64_t table_end, readings_end;
+
+  if (size < sizeof(*h) || memcmp(h->magic, TEMPSHM_MAGIC, sizeof(h->magic)) != 0)
+  {
+    errno = EAGAIN;
+    return 0;
+  }
+
+  /* Everything else was written before the magic */
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+  table_end    = h->sensors_offset + (uint64_t) h->sensor_count * sizeof(TempShmSensor);
+  readings_end = h->readings_offset + (uint64_t) h->sensor_count * sizeof(TempShmReading);
+  if (h->version != TEMPSHM_VERSION || h->header_size != sizeof(TempShmHeader) ||
+      h->sensor_size != sizeof(TempShmSensor) || h->reading_size != sizeof(TempShmReading) ||
+      h->sensor_count > INT_MAX / sizeof(TempShmSensor) || h->size > size ||
+      h->sensors_offset < sizeof(*h) || table_end > h->size ||
+      h->readings_offset < table_end || readings_end > h->size)
+  {
+    errno = EPROTO;
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Maps a segment published with --shm
+ *
+ * @param shm Mapping to fill
+ * @param name Object name, with or without the leading '/'; NULL for
+ *             TEMPSHM_DEFAULT_NAME
+ * @return 1 on success, 0 on failure (errno is set, see header_valid())
+ */
+int tempshm_open(TempShm *shm, const char *name)
+{
+  char        path[NAME_MAX + 1];
+  struct stat st;
+  void *      map;
+  int         fd, saved;
+
+  memset(shm, 0, sizeof(*shm));
+
+  if (!name)
+    name = TEMPSHM_DEFAULT_NAME;
+  if ((size_t) snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name) >=
+      sizeof(path))
+  {
+    errno = ENAMETOOLONG;
+    return 0;
+  }
+
+  fd = shm_open(path, O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0)
+    return 0;
+
+  if (fstat(fd, &st) != 0)
+  {
+    saved = errno;
+    close(fd);
+    errno = saved;
+    return 0;
+  }
+  if (st.st_size < (off_t) sizeof(TempShmHeader))
+  {
+    close(fd);
+    errno = EAGAIN; /* Not sized yet */
+    return 0;
+  }
+
+  map   = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  saved = errno;
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    errno = saved;
+    return 0;
+  }
+
+  if (!header_valid(map, (size_t) st.st_size))
+  {
+    saved = errno;
+    munmap(map, (size_t) st.st_size);
+    errno = saved;
+    return 0;
+  }
+
+  shm->header   = map;
+  shm->size     = (size_t) st.st_size;
+  shm->count    = (int) shm->header->sensor_count;
+  shm->sensors  = (const TempShmSensor *) ((const char *) map + shm->header->sensors_offset);
+  shm->readings = (const TempShmReading *) ((const char *) map + shm->header->readings_offset);
+  return 1;
+}
+
+/**
+ * @brief Looks up a sensor by name and label
+ *
+ * @param label Label to match, or NULL for the first sensor of name
+ * @return Sensor index, or -1 if there is none
+ */
+int tempshm_find(const TempShm *shm, const char *name, const char *label)
+{
+  for (int i = 0; i < shm->count; i++)
+  {
+    const TempShmSensor *s = &shm->sensors[i];
+
+    if (strncmp(s->name, name, sizeof(s->name)) == 0 &&
+        (!label || strncmp(s->label, label, sizeof(s->label)) == 0))
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Copies a consistent set of current readings
+ *
+ * Retries while the publisher is writing, which takes microseconds;
+ * never blocks otherwise.
+ *
+ * @param shm Mapped segment
+ * @param first Index of the first sensor to copy
+ * @param count Number of sensors to copy
+ * @param out Receives count readings
+ * @param tick Receives the sample number (0 before the first sample), or NULL
+ * @param timestamp_ms Receives the sample's wall-clock time, or NULL
+ * @return 1 on success, 0 if the range is out of bounds (errno EINVAL)
+ */
+int tempshm_read(const TempShm *shm, int first, int count, TempShmReading *out, uint64_t *tick,
+                 int64_t *timestamp_ms)
+{
+  const TempShmHeader *h = shm->header;
+  uint32_t             before, after;
+  uint64_t             t;
+  int64_t              ts;
+
+  if (first < 0 || count < 0 || count > shm->count - first)
+  {
+    errno = EINVAL;
+    return 0;
+  }
+
+  do
+  {
+    before = __atomic_load_n(&h->seq, __ATOMIC_ACQUIRE);
+    if (before & 1)
+      continue;
+
+    t  = h->tick;
+    ts = h->timestamp_ms;
+    memcpy(out, shm->readings + first, (size_t) count * sizeof(*out));
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    after = __atomic_load_n(&h->seq, __ATOMIC_RELAXED);
+  } while ((before & 1) || before != after);
+
+  if (tick)
+    *tick = t;
+  if (timestamp_ms)
+    *timestamp_ms = ts;
+  return 1;
+}
+
+/**
+ * @brief Tells whether the publisher has stopped
+ *
+ * The readings stay those of its last sample. A new monitor publishing
+ * under the same name creates a new segment; reopen to follow it.
+ */
+int tempshm_closed(const TempShm *shm)
+{
+  return (int) __atomic_load_n(&shm->header->closed, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Unmaps a segment
+ */
+void tempshm_close(TempShm *shm)
+{
+  if (shm->header)
+    munmap((void *) shm->header, shm->size);
+  memset(shm, 0, sizeof(*shm));
+}
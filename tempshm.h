@@ -0,0 +1,131 @@
+/**
+ * @file tempshm.h
+ * @brief Temp Monitor - Shared-memory snapshot layout and reader library
+ *
+ * --shm NAME publishes every sample in the POSIX shared memory object
+ * NAME (/dev/shm/NAME on Linux): a versioned header, the sensor table,
+ * and the current readings guarded by a sequence lock. Once mapped with
+ * tempshm_open(), tempshm_read() costs a few loads and a memcpy: no
+ * system call, no socket round-trip, no wait for the monitor.
+ *
+ * This header and tempshm.c depend on nothing else in Temp Monitor, so
+ * other programs can copy both or link bin/libtempshm.a (make lib).
+ *
+ * Layout (all offsets from the start of the segment, host byte order):
+ *
+ *   0                TempShmHeader, sequence on its own cache line
+ *   sensors_offset   TempShmSensor[sensor_count], fixed after creation
+ *   readings_offset  TempShmReading[sensor_count], rewritten every sample
+ *
+ * Sequence lock: the publisher makes seq odd, writes tick, timestamp and
+ * readings, then makes seq even again. A reader copies what it needs
+ * between two loads of seq and retries if they differ or are odd.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef TEMPSHM_H
+#define TEMPSHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Segment identification, written last when the segment is created */
+#define TEMPSHM_MAGIC "TMPSHM\r\n"
+#define TEMPSHM_VERSION 1
+
+/* Object name used by --shm without a name */
+#define TEMPSHM_DEFAULT_NAME "/temp-monitor"
+
+/* Temperature of a failed or inactive sensor */
+#define TEMPSHM_INVALID INT32_MIN
+
+/* Longest name and label kept in the table, NUL included; longer ones are cut */
+#define TEMPSHM_NAME_MAX 32
+#define TEMPSHM_LABEL_MAX 48
+
+/**
+ * @brief Segment header
+ *
+ * The first cache line is written once, at creation, apart from
+ * closed; the second holds the sequence and the sample it guards.
+ */
+typedef struct
+{
+  char     magic[8];        /* TEMPSHM_MAGIC */
+  uint32_t version;         /* TEMPSHM_VERSION */
+  uint32_t header_size;     /* sizeof(TempShmHeader) */
+  uint32_t sensor_size;     /* sizeof(TempShmSensor) */
+  uint32_t reading_size;    /* sizeof(TempShmReading) */
+  uint32_t sensor_count;    /* Entries in the table and the readings */
+  uint32_t interval_ms;     /* Sampling interval */
+  uint32_t sensors_offset;  /* Offset of the sensor table */
+  uint32_t readings_offset; /* Offset of the readings */
+  uint64_t size;            /* Bytes in the segment */
+  int64_t  pid;             /* Publishing process */
+  uint32_t closed;          /* 1 once the publisher has stopped */
+  uint32_t reserved;        /* 0 */
+
+  uint32_t seq;          /* Odd while a sample is being written */
+  uint32_t reserved2;    /* 0 */
+  uint64_t tick;         /* Sample number, 0 before the first one */
+  int64_t  timestamp_ms; /* Wall clock (CLOCK_REALTIME) of the sample */
+} TempShmHeader;
+
+/**
+ * @brief Sensor table entry, in the monitor's sensor order
+ */
+typedef struct
+{
+  char    name[TEMPSHM_NAME_MAX];   /* Driver/chip name */
+  char    label[TEMPSHM_LABEL_MAX]; /* Human-readable label */
+  int32_t type;                     /* 0 CPU, 1 GPU, 2 NVMe, 3 chipset, 4 memory, 5 VRM,
+                                       6 disk, 7 other */
+  int32_t crit_mc;                  /* Critical threshold, millidegrees C */
+  int32_t has_fan;                  /* 1 if fan_rpm is meaningful */
+  int32_t fan_max_rpm;              /* Fan's maximum RPM, 0 if unknown */
+} TempShmSensor;
+
+/**
+ * @brief Current reading of one sensor
+ */
+typedef struct
+{
+  int32_t temp_mc; /* Millidegrees C, TEMPSHM_INVALID if the read failed */
+  int32_t max_mc;  /* Highest since start or the last SIGUSR1 reset */
+  int32_t fan_rpm; /* Paired fan's speed, 0 without a fan, -1 if its read failed */
+  int32_t status;  /* 0 ok, 1 warning, 2 critical, 3 read error */
+} TempShmReading;
+
+/**
+ * @brief A mapped segment
+ */
+typedef struct
+{
+  const TempShmHeader * header;   /* Start of the mapping */
+  const TempShmSensor * sensors;  /* header->sensor_count entries */
+  const TempShmReading *readings; /* Only read through tempshm_read() */
+  int                   count;    /* Number of sensors */
+  size_t                size;     /* Bytes mapped */
+} TempShm;
+
+int  tempshm_open(TempShm *shm, const char *name);
+int  tempshm_find(const TempShm *shm, const char *name, const char *label);
+int  tempshm_read(const TempShm *shm, int first, int count, TempShmReading *out, uint64_t *tick,
+                  int64_t *timestamp_ms);
+int  tempshm_closed(const TempShm *shm);
+void tempshm_close(TempShm *shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file textfile.c
+ * @brief Temp Monitor - Prometheus textfile collector output
+ *
+ * Every update formats the exposition into the exporter's buffer,
+ * writes it to TEXTFILE_TEMP_NAME with one write() and renames that
+ * over TEXTFILE_NAME. Both live in the same directory, opened once,
+ * so the rename is atomic and immune to the directory being renamed
+ * or remounted under a different path. With --textfile-fsync the file
+ * is synced before the rename and the directory after it, so the new
+ * contents survive a power loss; without it an update never waits on
+ * the disk.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "textfile.h"
+
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Opens the output directory and prepares the formatter
+ *
+ * A temporary file left behind by a crash is removed. The final file
+ * is not touched until the first update.
+ *
+ * @param textfile Writer to initialize
+ * @param dir Existing, writable directory
+ * @param registry Sensor table; must stay valid until textfile_close()
+ * @param sync 1 to fsync every update
+ * @return 1 on success, 0 on failure (errno is set)
+ */
+int textfile_open(Textfile *textfile, const char *dir, const SensorRegistry *registry, int sync)
+{
+  memset(textfile, 0, sizeof(*textfile));
+  textfile->dir_fd = -1;
+  textfile->sync   = sync;
+
+  if (!export_init(&textfile->exporter, registry, EXPORT_PROMETHEUS, 0))
+  {
+    errno = ENOMEM;
+    return 0;
+  }
+
+  textfile->dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (textfile->dir_fd < 0)
+    return 0;
+
+  /* Fail now rather than on the first update */
+  if (faccessat(textfile->dir_fd, ".", W_OK, 0) != 0)
+    return 0;
+
+  unlinkat(textfile->dir_fd, TEXTFILE_TEMP_NAME, 0);
+  return 1;
+}
+
+/**
+ * @brief Replaces the textfile with one snapshot
+ *
+ * @param textfile Writer opened with textfile_open()
+ * @param snapshot Readings to expose
+ * @return 1 on success, 0 on failure (errno is set); the previous file
+ *         is left in place on failure
+ */
+int textfile_write(Textfile *textfile, const SensorSnapshot *snapshot)
+{
+  Exporter *  ex = &textfile->exporter;
+  SystemStats stats;
+  size_t      size;
+  int         fd, ok, saved;
+
+  calculate_system_stats(ex->registry, snapshot, &stats);
+  size = export_metrics(ex, snapshot, &stats, ex->buffer);
+
+  fd = openat(textfile->dir_fd, TEXTFILE_TEMP_NAME, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+              0644);
+  if (fd < 0)
+    return 0;
+
+  ok    = write_fd(fd, ex->buffer, size) && (!textfile->sync || fsync(fd) == 0);
+  saved = errno;
+  if (close(fd) != 0 && ok)
+  {
+    ok    = 0;
+    saved = errno;
+  }
+
+  if (ok && renameat(textfile->dir_fd, TEXTFILE_TEMP_NAME, textfile->dir_fd, TEXTFILE_NAME) != 0)
+  {
+    ok    = 0;
+    saved = errno;
+  }
+
+  if (!ok)
+  {
+    unlinkat(textfile->dir_fd, TEXTFILE_TEMP_NAME, 0);
+    errno = saved;
+    return 0;
+  }
+
+  /* Makes the rename itself durable */
+  if (textfile->sync && fsync(textfile->dir_fd) != 0)
+    return 0;
+
+  return 1;
+}
+
+/**
+ * @brief Closes the output directory and frees the formatter
+ *
+ * The last file written stays in place; node_exporter reports its
+ * age as node_textfile_mtime_seconds.
+ */
+void textfile_close(Textfile *textfile)
+{
+  if (textfile->dir_fd >= 0)
+    close(textfile->dir_fd);
+  export_free(&textfile->exporter);
+  textfile->dir_fd = -1;
+}
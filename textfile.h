@@ -0,0 +1,44 @@
+/**
+ * @file textfile.h
+ * @brief Temp Monitor - Prometheus textfile collector output
+ *
+ * --textfile DIR writes the same exposition as --listen to
+ * DIR/temp_monitor.prom, for node_exporter's textfile collector on
+ * hosts where opening a port is not an option. Each update is written
+ * to a temporary file in DIR and renamed over the previous one, so
+ * the collector only ever sees a complete file. Series are formatted
+ * through the exporter's line cache, so a steady update costs one
+ * write() and one rename().
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef TEXTFILE_H
+#define TEXTFILE_H
+
+#include "export.h"
+#include "sensor.h"
+
+/* File read by node_exporter, and the temporary file renamed over it */
+#define TEXTFILE_NAME "temp_monitor.prom"
+#define TEXTFILE_TEMP_NAME "temp_monitor.prom.tmp"
+
+/**
+ * @brief Writer state for one output directory
+ */
+typedef struct
+{
+  int      dir_fd;   /* Output directory, -1 when closed */
+  int      sync;     /* 1 to fsync the file and directory on every update */
+  Exporter exporter; /* Prometheus formatter and its line cache */
+} Textfile;
+
+int  textfile_open(Textfile *textfile, const char *dir, const SensorRegistry *registry, int sync);
+int  textfile_write(Textfile *textfile, const SensorSnapshot *snapshot);
+void textfile_close(Textfile *textfile);
+
+#endif
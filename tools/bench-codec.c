@@ -0,0 +1,142 @@
+/**
+ * @file bench-codec.c
+ * @brief Temp Monitor - Compression benchmark for --record-compress
+ *
+ * Simulates a burn-in rack (load switching on and off every half hour,
+ * sensors with 1, 0.5 and 0.125 C resolution, tach jitter on fans),
+ * encodes it in RECORD_BLOCK_FRAMES blocks exactly like the recorder,
+ * decodes every block back and checks it. Reports the size against
+ * raw frames and the encode/decode throughput. Build with `make bench`.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "codec.h"
+#include "record.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * @brief xorshift64 in [0, 1)
+ */
+static double next_random(uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return (double) (*state >> 11) / 9007199254740992.0;
+}
+
+int main(int argc, char *argv[])
+{
+  int      sensors = argc > 1 ? parse_int(argv[1], 200) : 200;
+  long     seconds = argc > 2 ? parse_duration(argv[2], 86400) : 86400;
+  int      columns, frames = RECORD_BLOCK_FRAMES;
+  uint64_t rng = 0x9e3779b97f4a7c15ull;
+  double * level;
+  int32_t *values, *decoded;
+  uint64_t ticks[RECORD_BLOCK_FRAMES], ticks_out[RECORD_BLOCK_FRAMES];
+  int64_t  stamps[RECORD_BLOCK_FRAMES], stamps_out[RECORD_BLOCK_FRAMES];
+  unsigned char *block;
+  double         encode_us = 0, decode_us = 0, t0;
+  size_t         packed = 0, raw = 0;
+  long           mismatches = 0;
+
+  if (sensors < 1 || seconds < 1)
+  {
+    fprintf(stderr, "Usage: %s [SENSORS] [DURATION]\n", argv[0]);
+    return 1;
+  }
+
+  columns = sensors * 2;
+  level   = calloc((size_t) sensors, sizeof(double));
+  values  = malloc((size_t) frames * columns * sizeof(int32_t));
+  decoded = malloc((size_t) frames * columns * sizeof(int32_t));
+  block   = malloc(codec_bound(frames, columns));
+  if (!level || !values || !decoded || !block)
+    return 1;
+
+  for (int s = 0; s < sensors; s++)
+    level[s] = 35000 + 10000 * next_random(&rng);
+
+  for (long start = 0; start < seconds; start += frames)
+  {
+    int n = seconds - start < frames ? (int) (seconds - start) : frames;
+
+    for (int f = 0; f < n; f++)
+    {
+      long     t    = start + f;
+      int      load = (t / 1800) % 2;
+      int32_t *row  = values + (size_t) f * columns;
+
+      ticks[f]  = (uint64_t) t + 1;
+      stamps[f] = 1733356800000LL + t * 1000 + (int64_t) (next_random(&rng) * 4);
+
+      for (int s = 0; s < sensors; s++)
+      {
+        /* 60% 1 C, 20% 0.125 C, 10% 0.5 C, 10% slow 1 C (NVMe) */
+        int    kind   = s % 10;
+        int    step   = kind < 6 ? 1000 : kind < 8 ? 125 : kind == 8 ? 1000 : 500;
+        double target = 38000 + load * (kind == 8 ? 8000 : 30000) + (s % 7) * 1000;
+        double alpha  = kind == 8 ? 0.002 : 0.02;
+
+        level[s] += (target - level[s]) * alpha + (next_random(&rng) - 0.5) * 300;
+        row[s] = (int32_t) ((long) (level[s] / step + 0.5) * step);
+
+        /* Every tenth sensor has a fan with a few RPM of tach jitter */
+        row[sensors + s] = s % 10 == 0
+                               ? 1200 + load * 800 + (int32_t) (next_random(&rng) * 20)
+                               : 0;
+      }
+    }
+
+    t0 = now_us();
+    size_t size = codec_encode(ticks, stamps, values, n, columns, block);
+    encode_us += now_us() - t0;
+
+    t0 = now_us();
+    if (!codec_decode(block, size, n, columns, ticks_out, stamps_out, decoded))
+      mismatches++;
+    decode_us += now_us() - t0;
+
+    if (memcmp(values, decoded, (size_t) n * columns * sizeof(int32_t)) != 0 ||
+        memcmp(ticks, ticks_out, (size_t) n * sizeof(uint64_t)) != 0 ||
+        memcmp(stamps, stamps_out, (size_t) n * sizeof(int64_t)) != 0)
+      mismatches++;
+
+    packed += sizeof(RecordBlockHeader) + size;
+    raw += (size_t) n * record_frame_size(sensors);
+  }
+
+  printf("%d sensors, %ld s at 1 Hz: raw %.1f MB, packed %.2f MB (%.1fx, %.2f bits/value)\n",
+         sensors, seconds, raw / 1e6, packed / 1e6, (double) raw / packed,
+         packed * 8.0 / ((double) seconds * columns));
+  printf("  30 days: raw %.1f GB, packed %.2f GB\n", raw * (2592000.0 / seconds) / 1e9,
+         packed * (2592000.0 / seconds) / 1e9);
+  printf("  encode %7.1f MB/s  %6.1f Mvalues/s\n", raw / encode_us,
+         (double) seconds * columns / encode_us);
+  printf("  decode %7.1f MB/s  %6.1f Mvalues/s\n", raw / decode_us,
+         (double) seconds * columns / decode_us);
+  printf("  round trip: %s\n", mismatches ? "MISMATCH" : "ok");
+
+  free(level);
+  free(values);
+  free(decoded);
+  free(block);
+  return mismatches ? 1 : 0;
+}
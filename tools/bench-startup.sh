@@ -0,0 +1,48 @@
+#!/bin/bash
+#
+# bench-startup.sh - Measure sensor discovery time on a synthetic tree
+#
+# Generates a hwmon tree with tools/gen-hwmon.sh (unless one exists)
+# and times `temp --list` with a single scan thread, with the
+# automatically sized worker pool, and from a warm scan cache.
+#
+# MIT License
+# Copyright (c) 2024 Danko
+
+set -e
+
+BIN="${BIN:-./bin/temp}"
+ROOT="${1:-/tmp/temp-bench-sysfs}"
+CHIPS="${CHIPS:-1250}"
+TEMPS="${TEMPS:-8}"
+RUNS="${RUNS:-10}"
+
+cd "$(dirname "$0")/.."
+
+if [ ! -x "$BIN" ]; then
+    echo "Build first: make"
+    exit 1
+fi
+
+if [ ! -d "$ROOT/class/hwmon" ]; then
+    tools/gen-hwmon.sh -c "$CHIPS" -t "$TEMPS" -f 1 "$ROOT"
+fi
+
+# Runs the binary RUNS times and prints the mean wall time in ms
+bench() {
+    local start end
+    start=$(date +%s%N)
+    for ((i = 0; i < RUNS; i++)); do
+        "$BIN" --sysfs-root "$ROOT" "$@" --list > /dev/null
+    done
+    end=$(date +%s%N)
+    echo $(((end - start) / RUNS / 1000000))
+}
+
+echo "Startup benchmark: $(ls "$ROOT/class/hwmon" | wc -l) chips, $RUNS runs each"
+printf "  %-22s %6s ms\n" "1 scan thread" "$(bench --no-cache --scan-threads 1)"
+printf "  %-22s %6s ms\n" "4 scan threads" "$(bench --no-cache --scan-threads 4)"
+printf "  %-22s %6s ms\n" "auto scan threads" "$(bench --no-cache --scan-threads 0)"
+
+"$BIN" --sysfs-root "$ROOT" --rescan --list > /dev/null
+printf "  %-22s %6s ms\n" "warm scan cache" "$(bench)"
@@ -0,0 +1,102 @@
+/**
+ * @file bench-tick.c
+ * @brief Temp Monitor - Per-tick cost benchmark
+ *
+ * Scans a (synthetic) sysfs tree once, then times the stages of a
+ * monitoring tick separately: the sample pass, the statistics pass,
+ * rendering (to /dev/null) and the Prometheus body of --listen and
+ * --textfile. Build with `make bench`.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "display.h"
+#include "export.h"
+#include "registry.h"
+#include "scancache.h"
+#include "sensor.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char *argv[])
+{
+  SensorRegistry registry = {0};
+  SensorSnapshot snapshot;
+  SystemStats    stats;
+  DisplayConfig  config = {.use_celsius = 1, .show_stats = 1, .show_fans = 1};
+  Exporter       exporter;
+  double         t0, sample_us = 0, stats_us = 0, render_us = 0, metrics_us = 0;
+  size_t         metrics_size = 0;
+  int            ticks, saved_stdout;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage: %s SYSFS_ROOT [TICKS]\n", argv[0]);
+    return 1;
+  }
+
+  ticks = argc > 2 ? parse_int(argv[2], 100) : 100;
+
+  raise_fd_limit();
+  set_sysfs_root(argv[1]);
+  scan_cache_set_enabled(0);
+  if (scan_temperature_sensors(&registry) == 0 || !snapshot_init(&snapshot, registry.count) ||
+      !snapshot_enable_histograms(&snapshot) ||
+      !export_init(&exporter, &registry, EXPORT_PROMETHEUS, 0))
+  {
+    fprintf(stderr, "No sensors under %s\n", argv[1]);
+    return 1;
+  }
+
+  /* Rendering goes to /dev/null; results go to stderr */
+  saved_stdout = dup(STDOUT_FILENO);
+  if (!freopen("/dev/null", "w", stdout))
+    return 1;
+
+  for (int i = 0; i < ticks; i++)
+  {
+    t0 = now_us();
+    sample_sensors(registry.sensors, registry.count, &snapshot);
+    sample_us += now_us() - t0;
+
+    t0 = now_us();
+    calculate_system_stats(&registry, &snapshot, &stats);
+    stats_us += now_us() - t0;
+
+    t0 = now_us();
+    display_all_sensors(&registry, &snapshot, NULL, &config);
+    fflush(stdout);
+    render_us += now_us() - t0;
+
+    t0           = now_us();
+    metrics_size = export_metrics(&exporter, &snapshot, &stats, exporter.buffer);
+    metrics_us += now_us() - t0;
+  }
+
+  fprintf(stderr,
+          "%6d sensors  sample %9.1f us  stats %7.1f us  render %8.1f us  metrics %7.1f us"
+          " (%zu KB)  (per tick)\n",
+          registry.count, sample_us / ticks, stats_us / ticks, render_us / ticks,
+          metrics_us / ticks, metrics_size / 1024);
+
+  close(saved_stdout);
+  export_free(&exporter);
+  snapshot_free(&snapshot);
+  registry_free(&registry);
+  return 0;
+}
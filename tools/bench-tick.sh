@@ -0,0 +1,32 @@
+#!/bin/bash
+#
+# bench-tick.sh - Measure the cost of one monitoring tick
+#
+# Generates synthetic hwmon trees with 1k, 5k and 10k temperature
+# channels (unless they exist) and runs bin/bench-tick on each, which
+# reports the sample, statistics, render and metrics stages separately.
+#
+# MIT License
+# Copyright (c) 2024 Danko
+
+set -e
+
+BIN="${1:-./bin/bench-tick}"
+BASE="${BASE:-/tmp/temp-bench-tick}"
+TEMPS="${TEMPS:-8}"
+TICKS="${TICKS:-50}"
+
+cd "$(dirname "$0")/.."
+
+if [ ! -x "$BIN" ]; then
+    echo "Build first: make bench"
+    exit 1
+fi
+
+for chips in 125 625 1250; do
+    root="$BASE-$chips"
+    if [ ! -d "$root/class/hwmon" ]; then
+        tools/gen-hwmon.sh -c "$chips" -t "$TEMPS" -f 1 "$root" > /dev/null
+    fi
+    "$BIN" "$root" "$TICKS"
+done
@@ -0,0 +1,85 @@
+#!/bin/bash
+#
+# gen-hwmon.sh - Build a synthetic sysfs tree for Temp Monitor
+#
+# Creates OUTDIR/class/hwmon/hwmonN entries laid out like the kernel
+# does (class symlink -> devices/.../hwmon/hwmonN, plus a 'device'
+# link), each with M tempK_input/_label/_crit files and optional
+# fans. Point the monitor at it with:
+#
+#   temp --sysfs-root OUTDIR --list
+#   TEMP_SYSFS_ROOT=OUTDIR temp -s 1
+#
+# MIT License
+# Copyright (c) 2024 Danko
+
+set -e
+
+CHIPS=4
+TEMPS=8
+FANS=2
+ZONES=0
+
+usage() {
+    echo "Usage: $0 [-c CHIPS] [-t TEMPS_PER_CHIP] [-f FANS_PER_CHIP] [-z THERMAL_ZONES] OUTDIR"
+    echo ""
+    echo "  -c CHIPS   Number of hwmon chips (default: $CHIPS)"
+    echo "  -t TEMPS   Temperature channels per chip (default: $TEMPS)"
+    echo "  -f FANS    Fan channels per chip (default: $FANS)"
+    echo "  -z ZONES   Number of thermal zones (default: $ZONES)"
+    echo ""
+    echo "Example: $0 -c 1250 -t 8 /tmp/fake-sysfs   # 10k channels"
+    exit 1
+}
+
+while getopts "c:t:f:z:h" opt; do
+    case "$opt" in
+        c) CHIPS="$OPTARG" ;;
+        t) TEMPS="$OPTARG" ;;
+        f) FANS="$OPTARG" ;;
+        z) ZONES="$OPTARG" ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+[ $# -eq 1 ] || usage
+OUT="$1"
+
+# Chip names cycle through common drivers so every sensor type shows up
+NAMES=(coretemp k10temp nvme amdgpu nct6775 drivetemp jc42 acpitz)
+LABELS=("Core" "Tctl" "Composite" "edge" "SYSTIN" "Disk" "DIMM" "Zone")
+
+rm -rf "$OUT/class/hwmon" "$OUT/class/thermal" "$OUT/devices/platform"
+mkdir -p "$OUT/class/hwmon" "$OUT/class/thermal"
+
+for ((c = 0; c < CHIPS; c++)); do
+    kind=$((c % ${#NAMES[@]}))
+    dev="$OUT/devices/platform/fake-${NAMES[$kind]}.$c"
+    chip="$dev/hwmon/hwmon$c"
+
+    mkdir -p "$chip"
+    echo "${NAMES[$kind]}" > "$chip/name"
+    ln -s "../.." "$chip/device"
+    ln -s "../../devices/platform/fake-${NAMES[$kind]}.$c/hwmon/hwmon$c" "$OUT/class/hwmon/hwmon$c"
+
+    for ((t = 1; t <= TEMPS; t++)); do
+        echo $((30000 + (c * 7919 + t * 1237) % 50000)) > "$chip/temp${t}_input"
+        echo "${LABELS[$kind]} $((t - 1))" > "$chip/temp${t}_label"
+        echo 100000 > "$chip/temp${t}_crit"
+    done
+
+    for ((f = 1; f <= FANS; f++)); do
+        echo $((800 + (c * 131 + f * 577) % 2400)) > "$chip/fan${f}_input"
+        echo 4000 > "$chip/fan${f}_max"
+    done
+done
+
+for ((z = 0; z < ZONES; z++)); do
+    zone="$OUT/class/thermal/thermal_zone$z"
+    mkdir -p "$zone"
+    echo "acpitz" > "$zone/type"
+    echo $((40000 + z * 1000)) > "$zone/temp"
+done
+
+echo "Generated $CHIPS chips x $TEMPS temps ($((CHIPS * TEMPS)) channels), $FANS fans/chip, $ZONES zones in $OUT"
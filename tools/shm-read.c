@@ -0,0 +1,91 @@
+/**
+ * @file shm-read.c
+ * @brief Temp Monitor - Example reader for the --shm segment
+ *
+ * Prints every sensor's temperature and headroom to its critical
+ * threshold, read through libtempshm, then times tempshm_read() for one
+ * sensor and for the whole table. Uses nothing but tempshm.h, like an
+ * outside program would. Build with `make lib`; run next to a monitor
+ * started with --shm:
+ *
+ *   ./bin/temp --daemon --shm temp-monitor &
+ *   ./bin/shm-read temp-monitor
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#include "tempshm.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_READS 1000000
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *    name = argc > 1 ? argv[1] : TEMPSHM_DEFAULT_NAME;
+  TempShm         shm;
+  TempShmReading *readings;
+  uint64_t        tick;
+  int64_t         timestamp_ms;
+  double          t0, one_ns, all_ns;
+
+  if (!tempshm_open(&shm, name))
+  {
+    fprintf(stderr, "Cannot open %s: %s\n", name,
+            errno == EPROTO ? "not a compatible Temp Monitor segment" : strerror(errno));
+    return 1;
+  }
+
+  readings = calloc((size_t) (shm.count ? shm.count : 1), sizeof(*readings));
+  if (!readings)
+  {
+    tempshm_close(&shm);
+    return 1;
+  }
+
+  tempshm_read(&shm, 0, shm.count, readings, &tick, &timestamp_ms);
+  printf("%d sensors, tick %llu, every %u ms%s\n", shm.count, (unsigned long long) tick,
+         shm.header->interval_ms, tempshm_closed(&shm) ? " (publisher stopped)" : "");
+
+  for (int i = 0; i < shm.count; i++)
+  {
+    const TempShmSensor *s = &shm.sensors[i];
+
+    if (readings[i].temp_mc == TEMPSHM_INVALID)
+      printf("  %-16s %-24s      n/a\n", s->name, s->label);
+    else
+      printf("  %-16s %-24s %6.1f C  headroom %5.1f C\n", s->name, s->label,
+             readings[i].temp_mc / 1000.0, (s->crit_mc - readings[i].temp_mc) / 1000.0);
+  }
+
+  t0 = now_ns();
+  for (int i = 0; i < BENCH_READS; i++)
+    tempshm_read(&shm, i % (shm.count ? shm.count : 1), shm.count ? 1 : 0, readings, NULL, NULL);
+  one_ns = (now_ns() - t0) / BENCH_READS;
+
+  t0 = now_ns();
+  for (int i = 0; i < BENCH_READS / 10; i++)
+    tempshm_read(&shm, 0, shm.count, readings, NULL, NULL);
+  all_ns = (now_ns() - t0) / (BENCH_READS / 10);
+
+  printf("tempshm_read: %.1f ns for one sensor, %.1f ns for all %d\n", one_ns, all_ns, shm.count);
+
+  free(readings);
+  tempshm_close(&shm);
+  return 0;
+}
@@ -0,0 +1,295 @@
+/**
+ * @file uring.c
+ * @brief Temp Monitor - Batched io_uring reads implementation
+ *
+ * Sets up a single io_uring instance and submits IORING_OP_READ
+ * requests in batches. When the kernel headers or the syscall are
+ * unavailable every function reports failure and the caller falls
+ * back to plain pread() sampling.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#define _GNU_SOURCE
+
+#include "uring.h"
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Submission/completion ring state mapped from the kernel */
+static struct
+{
+  int      fd;
+  unsigned entries;
+
+  void * sq_ptr;
+  size_t sq_len;
+  void * cq_ptr;
+  size_t cq_len;
+
+  struct io_uring_sqe *sqes;
+  size_t               sqes_len;
+
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+
+  unsigned *           cq_head;
+  unsigned *           cq_tail;
+  unsigned *           cq_mask;
+  struct io_uring_cqe *cqes;
+} ring = {.fd = -1};
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+  return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/**
+ * @brief Creates the io_uring instance and maps its rings
+ *
+ * @param entries Requested submission queue depth
+ * @return 1 if io_uring is usable, 0 otherwise
+ */
+int uring_init(unsigned entries)
+{
+  struct io_uring_params p;
+
+  if (ring.fd >= 0)
+    return 1;
+
+  memset(&p, 0, sizeof(p));
+  ring.fd = sys_io_uring_setup(entries, &p);
+  if (ring.fd < 0)
+  {
+    ring.fd = -1;
+    return 0;
+  }
+
+  ring.entries = p.sq_entries;
+  ring.sq_len  = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  ring.cq_len  = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    if (ring.cq_len > ring.sq_len)
+      ring.sq_len = ring.cq_len;
+    ring.cq_len = ring.sq_len;
+  }
+
+  ring.sq_ptr = mmap(NULL, ring.sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                     IORING_OFF_SQ_RING);
+  if (ring.sq_ptr == MAP_FAILED)
+    goto fail_sq;
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    ring.cq_ptr = ring.sq_ptr;
+  }
+  else
+  {
+    ring.cq_ptr = mmap(NULL, ring.cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring.fd, IORING_OFF_CQ_RING);
+    if (ring.cq_ptr == MAP_FAILED)
+      goto fail_cq;
+  }
+
+  ring.sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+  ring.sqes     = mmap(NULL, ring.sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring.fd, IORING_OFF_SQES);
+  if (ring.sqes == MAP_FAILED)
+    goto fail_sqes;
+
+  ring.sq_head  = (unsigned *) ((char *) ring.sq_ptr + p.sq_off.head);
+  ring.sq_tail  = (unsigned *) ((char *) ring.sq_ptr + p.sq_off.tail);
+  ring.sq_mask  = (unsigned *) ((char *) ring.sq_ptr + p.sq_off.ring_mask);
+  ring.sq_array = (unsigned *) ((char *) ring.sq_ptr + p.sq_off.array);
+
+  ring.cq_head = (unsigned *) ((char *) ring.cq_ptr + p.cq_off.head);
+  ring.cq_tail = (unsigned *) ((char *) ring.cq_ptr + p.cq_off.tail);
+  ring.cq_mask = (unsigned *) ((char *) ring.cq_ptr + p.cq_off.ring_mask);
+  ring.cqes    = (struct io_uring_cqe *) ((char *) ring.cq_ptr + p.cq_off.cqes);
+
+  return 1;
+
+fail_sqes:
+  if (ring.cq_ptr != ring.sq_ptr)
+    munmap(ring.cq_ptr, ring.cq_len);
+fail_cq:
+  munmap(ring.sq_ptr, ring.sq_len);
+fail_sq:
+  close(ring.fd);
+  ring.fd = -1;
+  return 0;
+}
+
+/**
+ * @brief Reports whether uring_init() succeeded
+ */
+int uring_available(void)
+{
+  return ring.fd >= 0;
+}
+
+/**
+ * @brief Submits and reaps one chunk that fits in the ring
+ */
+static int uring_read_chunk(UringRead *reads, int count)
+{
+  unsigned tail      = *ring.sq_tail;
+  unsigned mask      = *ring.sq_mask;
+  unsigned to_submit = (unsigned) count;
+  int      done      = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    unsigned             idx = tail & mask;
+    struct io_uring_sqe *sqe = &ring.sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = reads[i].fd;
+    sqe->addr      = (unsigned long) reads[i].buffer;
+    sqe->len       = (unsigned) (reads[i].size - 1);
+    sqe->off       = 0;
+    sqe->user_data = (unsigned long) i;
+
+    ring.sq_array[idx] = idx;
+    reads[i].result    = -ECANCELED;
+    tail++;
+  }
+
+  atomic_store_explicit((_Atomic unsigned *) ring.sq_tail, tail, memory_order_release);
+
+  while (done < count)
+  {
+    int ret =
+        sys_io_uring_enter(ring.fd, to_submit, (unsigned) (count - done), IORING_ENTER_GETEVENTS);
+    if (ret < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return 0;
+    }
+    to_submit -= (unsigned) ret;
+
+    unsigned head = *ring.cq_head;
+    unsigned ctail =
+        atomic_load_explicit((_Atomic unsigned *) ring.cq_tail, memory_order_acquire);
+
+    while (head != ctail)
+    {
+      struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+      UringRead *          r   = &reads[cqe->user_data];
+
+      r->result = cqe->res;
+      if (cqe->res > 0)
+        r->buffer[cqe->res] = '\0';
+      else
+        r->buffer[0] = '\0';
+
+      head++;
+      done++;
+    }
+
+    atomic_store_explicit((_Atomic unsigned *) ring.cq_head, head, memory_order_release);
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Reads a batch of descriptors with as few submissions as possible
+ *
+ * Requests larger than the ring are split into ring-sized chunks.
+ * Every entry must carry an open descriptor.
+ *
+ * @param reads Array of read requests, results are filled in place
+ * @param count Number of requests
+ * @return 1 if all chunks were submitted, 0 if the caller must fall back
+ */
+int uring_read_batch(UringRead *reads, int count)
+{
+  int offset = 0;
+
+  if (ring.fd < 0)
+    return 0;
+
+  while (offset < count)
+  {
+    int chunk = count - offset;
+    if (chunk > (int) ring.entries)
+      chunk = (int) ring.entries;
+
+    if (!uring_read_chunk(reads + offset, chunk))
+      return 0;
+
+    offset += chunk;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Unmaps the rings and closes the io_uring descriptor
+ */
+void uring_cleanup(void)
+{
+  if (ring.fd < 0)
+    return;
+
+  munmap(ring.sqes, ring.sqes_len);
+  if (ring.cq_ptr != ring.sq_ptr)
+    munmap(ring.cq_ptr, ring.cq_len);
+  munmap(ring.sq_ptr, ring.sq_len);
+  close(ring.fd);
+  ring.fd = -1;
+}
+
+#else /* !HAVE_IO_URING */
+
+int uring_init(unsigned entries)
+{
+  (void) entries;
+  return 0;
+}
+
+int uring_available(void)
+{
+  return 0;
+}
+
+int uring_read_batch(UringRead *reads, int count)
+{
+  (void) reads;
+  (void) count;
+  return 0;
+}
+
+void uring_cleanup(void) {}
+
+#endif
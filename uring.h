@@ -0,0 +1,41 @@
+/**
+ * @file uring.h
+ * @brief Temp Monitor - Batched io_uring reads
+ *
+ * Minimal io_uring wrapper used by the sampling engine to submit
+ * the reads for every sensor attribute as a single batch per tick.
+ * Talks to the kernel through raw syscalls so no liburing is needed.
+ *
+ * @version 0.0.2
+ * @date 2024-12-05
+ *
+ * MIT License
+ * Copyright (c) 2024 Danko
+ */
+
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+
+/**
+ * @brief One read request in a batch
+ *
+ * Each request reads up to size - 1 bytes from offset 0 of fd.
+ * On completion result holds the byte count or a negative errno
+ * and buffer is NUL-terminated.
+ */
+typedef struct
+{
+  int    fd;     /* Descriptor to read */
+  char * buffer; /* Destination buffer */
+  size_t size;   /* Size of destination buffer */
+  int    result; /* Bytes read, or -errno on failure */
+} UringRead;
+
+int  uring_init(unsigned entries);
+int  uring_available(void);
+int  uring_read_batch(UringRead *reads, int count);
+void uring_cleanup(void);
+
+#endif
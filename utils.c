@@ -16,10 +16,16 @@
 #include "utils.h"
 
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 /**
@@ -43,6 +49,88 @@ int read_file(const char *path, char *buffer, size_t size)
   return bytes_read > 0;
 }
 
+/**
+ * @brief Reads a small file from offset 0 through an open descriptor
+ *
+ * sysfs attributes regenerate their contents on every read at
+ * offset 0, so a cached descriptor can be re-read with pread()
+ * without seeking or reopening. errno is left set on failure.
+ *
+ * @param fd Open file descriptor
+ * @param buffer Output buffer
+ * @param size Size of buffer
+ * @return 1 on success, 0 on failure
+ */
+int read_fd(int fd, char *buffer, size_t size)
+{
+  ssize_t bytes_read;
+
+  errno = 0;
+  do
+  {
+    bytes_read = pread(fd, buffer, size - 1, 0);
+  } while (bytes_read < 0 && errno == EINTR);
+
+  if (bytes_read <= 0)
+  {
+    buffer[0] = '\0';
+    return 0;
+  }
+
+  buffer[bytes_read] = '\0';
+  return 1;
+}
+
+/**
+ * @brief Opens a file relative to a directory descriptor, read-only
+ *
+ * @param dirfd Directory descriptor (or AT_FDCWD)
+ * @param name Path relative to dirfd
+ * @return File descriptor, or -1 on failure
+ */
+int open_readonly_at(int dirfd, const char *name)
+{
+  return openat(dirfd, name, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * @brief Opens a directory relative to a directory descriptor
+ *
+ * Follows symlinks, so class entries like hwmon0 resolve to the
+ * device directory they point to.
+ *
+ * @param dirfd Directory descriptor (or AT_FDCWD)
+ * @param name Path relative to dirfd
+ * @return Directory descriptor, or -1 on failure
+ */
+int open_dir_at(int dirfd, const char *name)
+{
+  return openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+/**
+ * @brief Reads a small file relative to a directory descriptor
+ *
+ * @param dirfd Directory descriptor
+ * @param name Path relative to dirfd
+ * @param buffer Output buffer
+ * @param size Size of buffer
+ * @return 1 on success, 0 on failure
+ */
+int read_file_at(int dirfd, const char *name, char *buffer, size_t size)
+{
+  int fd = open_readonly_at(dirfd, name);
+  int ok;
+
+  if (fd < 0)
+    return 0;
+
+  ok = read_fd(fd, buffer, size);
+  close(fd);
+
+  return ok;
+}
+
 /**
  * @brief Writes data to a file
  *
@@ -63,6 +151,37 @@ int write_file(const char *path, const char *data)
   return written == len;
 }
 
+/**
+ * @brief Writes a whole buffer to a descriptor
+ *
+ * Retries short writes and EINTR, so a buffer assembled for one
+ * write() goes out complete. errno is left set on failure.
+ *
+ * @param fd Open file descriptor
+ * @param data Data to write
+ * @param size Bytes in data
+ * @return 1 on success, 0 on failure
+ */
+int write_fd(int fd, const void *data, size_t size)
+{
+  const char *p = data;
+
+  while (size > 0)
+  {
+    ssize_t n = write(fd, p, size);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return 0;
+    }
+    p += n;
+    size -= (size_t) n;
+  }
+
+  return 1;
+}
+
 /**
  * @brief Checks if a file exists
  */
@@ -82,6 +201,43 @@ int dir_exists(const char *path)
   return S_ISDIR(st.st_mode);
 }
 
+/**
+ * @brief Checks if a file exists relative to a directory descriptor
+ */
+int file_exists_at(int dirfd, const char *name)
+{
+  return faccessat(dirfd, name, F_OK, 0) == 0;
+}
+
+/**
+ * @brief Checks if a directory exists relative to a directory descriptor
+ */
+int dir_exists_at(int dirfd, const char *name)
+{
+  struct stat st;
+  if (fstatat(dirfd, name, &st, 0) != 0)
+    return 0;
+  return S_ISDIR(st.st_mode);
+}
+
+/**
+ * @brief Raises the open-file soft limit to the hard limit
+ *
+ * Sensors keep one descriptor per temperature and fan attribute, so
+ * large machines (or synthetic trees) pass the usual soft limit of
+ * 1024 long before the hard limit. Failure leaves the limit as is.
+ */
+void raise_fd_limit(void)
+{
+  struct rlimit rl;
+
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+  {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+}
+
 /**
  * @brief Converts string to lowercase in-place
  */
@@ -171,6 +327,50 @@ int str_contains(const char *str, const char *substr)
   return strstr(str, substr) != NULL;
 }
 
+/**
+ * @brief Compares strings treating digit runs as numbers
+ *
+ * Orders "hwmon2" before "hwmon10" and "temp9_input" before
+ * "temp10_input". Returns <0, 0 or >0 like strcmp().
+ */
+int str_natcmp(const char *a, const char *b)
+{
+  while (*a && *b)
+  {
+    if (isdigit((unsigned char) *a) && isdigit((unsigned char) *b))
+    {
+      const char *na = a, *nb = b;
+      size_t      la, lb;
+
+      while (*na == '0')
+        na++;
+      while (*nb == '0')
+        nb++;
+      for (a = na; isdigit((unsigned char) *a); a++)
+        ;
+      for (b = nb; isdigit((unsigned char) *b); b++)
+        ;
+
+      la = (size_t) (a - na);
+      lb = (size_t) (b - nb);
+      if (la != lb)
+        return la < lb ? -1 : 1;
+
+      int cmp = strncmp(na, nb, la);
+      if (cmp != 0)
+        return cmp;
+      continue;
+    }
+
+    if (*a != *b)
+      return (unsigned char) *a - (unsigned char) *b;
+    a++;
+    b++;
+  }
+
+  return (unsigned char) *a - (unsigned char) *b;
+}
+
 /**
  * @brief Joins two path components
  */
@@ -188,6 +388,38 @@ void path_join(char *dest, size_t size, const char *path1, const char *path2)
   }
 }
 
+/**
+ * @brief Splits "HOST:PORT", "[HOST]:PORT" or ":PORT" into its parts
+ *
+ * @param address Address to split
+ * @param host Receives the host without brackets, empty for ":PORT"
+ * @param size Size of host
+ * @param port Receives a pointer to the port inside address
+ * @return 1 on success, 0 if there is no port or the host is too long
+ */
+int split_host_port(const char *address, char *host, size_t size, const char **port)
+{
+  const char *colon = strrchr(address, ':');
+  size_t      len;
+
+  if (!colon || colon[1] == '\0')
+    return 0;
+
+  len = (size_t) (colon - address);
+  if (len >= 2 && address[0] == '[' && address[len - 1] == ']')
+  {
+    address++;
+    len -= 2;
+  }
+  if (len >= size)
+    return 0;
+
+  memcpy(host, address, len);
+  host[len] = '\0';
+  *port     = colon + 1;
+  return 1;
+}
+
 /**
  * @brief Parses string to integer with default value
  */
@@ -236,6 +468,168 @@ void format_number(double value, char *buffer, size_t size, int decimals)
   snprintf(buffer, size, format, value);
 }
 
+/**
+ * @brief Parses a sysfs millidegree value
+ *
+ * Accepts an optional minus sign followed by up to ten decimal digits,
+ * terminated by NUL, newline or space. Unlike strtol() this reports
+ * garbage and empty buffers as errors instead of a silent 0, so a
+ * genuine "0" reading stays valid.
+ *
+ * @param str Raw attribute contents
+ * @param value Output value in millidegrees
+ * @return 1 on success, 0 if the buffer is not a number or overflows
+ */
+int parse_millidegrees(const char *str, int32_t *value)
+{
+  const unsigned char *p        = (const unsigned char *) str;
+  int                  negative = (*p == '-');
+  uint64_t             v        = 0;
+  int                  digits   = 0;
+
+  p += negative;
+  while ((unsigned) (*p - '0') < 10 && digits < 10)
+  {
+    v = v * 10 + (unsigned) (*p - '0');
+    p++;
+    digits++;
+  }
+
+  if (digits == 0 || (*p != '\0' && *p != '\n' && *p != ' ') || v > INT32_MAX)
+    return 0;
+
+  *value = negative ? -(int32_t) v : (int32_t) v;
+  return 1;
+}
+
+/**
+ * @brief Formats a millidegree value as a decimal string
+ *
+ * Integer-only replacement for printf("%.Nf", milli / 1000.0): the
+ * value is rounded half away from zero to 0-3 decimals. The output is
+ * not padded; at most MILLI_STR_MAX bytes are written.
+ *
+ * @param buffer Output buffer of at least MILLI_STR_MAX bytes
+ * @param milli Value in thousandths
+ * @param decimals Number of decimals (clamped to 0..3)
+ * @return Length of the string written
+ */
+size_t format_millidegrees(char *buffer, int32_t milli, int decimals)
+{
+  static const uint32_t scale[] = {1000, 100, 10, 1};
+  char                  digits[12];
+  char *                out = buffer;
+  uint32_t              v   = milli < 0 ? 0u - (uint32_t) milli : (uint32_t) milli;
+  uint32_t              step;
+  int                   n = 0;
+
+  if (decimals < 0)
+    decimals = 0;
+  if (decimals > 3)
+    decimals = 3;
+
+  step = scale[decimals];
+  v    = (uint32_t) (((uint64_t) v + step / 2) / step);
+
+  if (milli < 0 && v > 0)
+    *out++ = '-';
+
+  do
+  {
+    digits[n++] = (char) ('0' + v % 10);
+    v /= 10;
+  } while (v > 0 || n <= decimals);
+
+  while (n > decimals)
+    *out++ = digits[--n];
+
+  if (decimals > 0)
+  {
+    *out++ = '.';
+    while (n > 0)
+      *out++ = digits[--n];
+  }
+
+  *out = '\0';
+  return (size_t) (out - buffer);
+}
+
+/**
+ * @brief Parses a duration such as "90", "90s", "15m", "6h" or "7d"
+ *
+ * @param str Positive number with an optional s/m/h/d suffix
+ * @param default_val Value returned if str is not a valid duration
+ * @return Duration in seconds
+ */
+long parse_duration(const char *str, long default_val)
+{
+  if (!str)
+    return default_val;
+
+  char *endptr;
+  long  val = strtol(str, &endptr, 10);
+  long  unit;
+
+  if (endptr == str || val <= 0)
+    return default_val;
+
+  if (*endptr == '\0' || *endptr == 's')
+    unit = 1;
+  else if (*endptr == 'm')
+    unit = 60;
+  else if (*endptr == 'h')
+    unit = 3600;
+  else if (*endptr == 'd')
+    unit = 86400;
+  else
+    return default_val;
+
+  if ((*endptr != '\0' && endptr[1] != '\0') || val > LONG_MAX / unit)
+    return default_val;
+
+  return val * unit;
+}
+
+/**
+ * @brief Parses an interval such as "100ms", "2s" or "1m" into milliseconds
+ *
+ * @param str Interval string; without a unit it is seconds
+ * @param default_val Value returned if str is invalid
+ * @return Interval in milliseconds
+ */
+long parse_duration_ms(const char *str, long default_val)
+{
+  if (!str)
+    return default_val;
+
+  char *endptr;
+  long  val = strtol(str, &endptr, 10);
+
+  if (endptr != str && val > 0 && strcmp(endptr, "ms") == 0)
+    return val;
+
+  val = parse_duration(str, -1);
+  if (val < 0 || val > LONG_MAX / 1000)
+    return default_val;
+
+  return val * 1000;
+}
+
+/**
+ * @brief Formats seconds in the largest unit that divides them ("10m")
+ */
+void format_duration(long seconds, char *buffer, size_t size)
+{
+  if (seconds > 0 && seconds % 86400 == 0)
+    snprintf(buffer, size, "%ldd", seconds / 86400);
+  else if (seconds > 0 && seconds % 3600 == 0)
+    snprintf(buffer, size, "%ldh", seconds / 3600);
+  else if (seconds > 0 && seconds % 60 == 0)
+    snprintf(buffer, size, "%ldm", seconds / 60);
+  else
+    snprintf(buffer, size, "%lds", seconds);
+}
+
 /**
  * @brief Formats bytes to human-readable size (KB, MB, GB, etc.)
  */
@@ -254,6 +648,71 @@ void format_bytes(long bytes, char *buffer, size_t size)
   snprintf(buffer, size, "%.2f %s", value, units[unit]);
 }
 
+/* Slicing-by-8 tables for crc32_update(), built once on first use */
+static uint32_t       crc32_table[8][256];
+static pthread_once_t crc32_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Builds crc32_table for the reflected polynomial 0xedb88320
+ */
+static void crc32_init(void)
+{
+  for (uint32_t n = 0; n < 256; n++)
+  {
+    uint32_t c = n;
+    for (int k = 0; k < 8; k++)
+      c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    crc32_table[0][n] = c;
+  }
+
+  for (uint32_t n = 0; n < 256; n++)
+  {
+    for (int t = 1; t < 8; t++)
+    {
+      uint32_t c        = crc32_table[t - 1][n];
+      crc32_table[t][n] = crc32_table[0][c & 0xff] ^ (c >> 8);
+    }
+  }
+}
+
+/**
+ * @brief Updates a CRC-32 (IEEE 802.3, as in zlib) with more data
+ *
+ * Slicing-by-8: eight table lookups per 8 bytes instead of a serial
+ * chain per byte, so checking a multi-megabyte recording index or
+ * thousands of raw frames is not bound by the checksum.
+ *
+ * @param crc CRC of the preceding data, 0 to start
+ * @param data Bytes to add
+ * @param size Number of bytes
+ * @return Updated CRC
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t size)
+{
+  const unsigned char *p = data;
+
+  pthread_once(&crc32_once, crc32_init);
+
+  crc = ~crc;
+  for (; size >= 8; size -= 8, p += 8)
+  {
+    uint32_t lo = crc ^ ((uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 |
+                         (uint32_t) p[3] << 24);
+    uint32_t hi = (uint32_t) p[4] | (uint32_t) p[5] << 8 | (uint32_t) p[6] << 16 |
+                  (uint32_t) p[7] << 24;
+
+    crc = crc32_table[7][lo & 0xff] ^ crc32_table[6][(lo >> 8) & 0xff] ^
+          crc32_table[5][(lo >> 16) & 0xff] ^ crc32_table[4][lo >> 24] ^
+          crc32_table[3][hi & 0xff] ^ crc32_table[2][(hi >> 8) & 0xff] ^
+          crc32_table[1][(hi >> 16) & 0xff] ^ crc32_table[0][hi >> 24];
+  }
+
+  while (size-- > 0)
+    crc = crc32_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+  return ~crc;
+}
+
 /**
  * @brief Checks if running as root
  */
@@ -262,6 +721,26 @@ int is_root(void)
   return geteuid() == 0;
 }
 
+/**
+ * @brief Gets the wall-clock time in milliseconds since the epoch
+ */
+long long get_time_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Gets a monotonic time in microseconds, for measuring intervals
+ */
+long long get_time_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 /**
  * @brief Gets system uptime in seconds
  */
@@ -16,12 +16,24 @@
 #define UTILS_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+/* Longest string format_millidegrees() produces, including the NUL */
+#define MILLI_STR_MAX 16
 
 /* File operations */
 int read_file(const char *path, char *buffer, size_t size);
+int read_fd(int fd, char *buffer, size_t size);
+int open_readonly_at(int dirfd, const char *name);
+int open_dir_at(int dirfd, const char *name);
+int read_file_at(int dirfd, const char *name, char *buffer, size_t size);
 int write_file(const char *path, const char *data);
+int write_fd(int fd, const void *data, size_t size);
 int file_exists(const char *path);
 int dir_exists(const char *path);
+int file_exists_at(int dirfd, const char *name);
+int dir_exists_at(int dirfd, const char *name);
+void raise_fd_limit(void);
 
 /* String utilities */
 void str_tolower(char *str);
@@ -30,21 +42,33 @@ void str_trim(char *str);
 int  str_startswith(const char *str, const char *prefix);
 int  str_endswith(const char *str, const char *suffix);
 int  str_contains(const char *str, const char *substr);
+int  str_natcmp(const char *a, const char *b);
 void str_replace(char *str, const char *find, const char *replace);
 
 /* Path utilities */
 void path_join(char *dest, size_t size, const char *path1, const char *path2);
 void path_basename(const char *path, char *basename, size_t size);
 void path_dirname(const char *path, char *dirname, size_t size);
+int  split_host_port(const char *address, char *host, size_t size, const char **port);
 
 /* Number utilities */
 int    parse_int(const char *str, int default_val);
 double parse_double(const char *str, double default_val);
 void   format_number(double value, char *buffer, size_t size, int decimals);
 void   format_bytes(long bytes, char *buffer, size_t size);
+int    parse_millidegrees(const char *str, int32_t *value);
+size_t format_millidegrees(char *buffer, int32_t milli, int decimals);
+long   parse_duration(const char *str, long default_val);
+long   parse_duration_ms(const char *str, long default_val);
+void   format_duration(long seconds, char *buffer, size_t size);
+
+/* Checksum utilities */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t size);
 
 /* System utilities */
-int  is_root(void);
+int       is_root(void);
+long long get_time_ms(void);
+long long get_time_us(void);
 long get_system_uptime(void);
 int  get_cpu_count(void);
 long get_total_memory(void);